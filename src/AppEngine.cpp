@@ -1,35 +1,232 @@
 #include "AppEngine.hpp"
 
+#include <algorithm>
+
 
 AppEngine::AppEngine(QObject *parent)
     : QObject{parent} {
     log = &AsyncLogger::instance();
 
+    m_samples.setName("samples");
+
 
     // Например если нужно выводить на весь экран
     // только в релизной версии на целевом устройстве
 #ifdef __ARM_ARCH
 #ifndef QT_DEBUG
-    m_Fullscreen = true;
+    m_props.setBool(PropFullscreen, true);
 #endif
 #endif
-    connect(&m_msg,  &MessagesHandler::messageReceived,
-            this, &AppEngine::qmlMessageUpdate);
+    connect(&m_props, &PropertyStore::propertiesChanged,
+            this, &AppEngine::onPropertiesChanged);
 
+    // MessagesHandler принимает сообщения из любого потока,
+    // прямое подключение обходится без копии в очереди событий
     connect(&conf,  &ConfigReader::infoMessage,
-            &m_msg, &MessagesHandler::sendInfo);
+            &m_msg, &MessagesHandler::sendInfo, Qt::DirectConnection);
 
     connect(log,         &AsyncLogger::ErrorOccured,
-            &m_msg, &MessagesHandler::sendError);
+            &m_msg, &MessagesHandler::sendError, Qt::DirectConnection);
+
+    connect(&m_metrics, &MetricsExporter::errorOccurred,
+            this, [this](const QString &message) { log->logWarning(message); });
+
+    connect(&m_journal, &ParameterJournal::errorOccurred,
+            this, [this](const QString &message) { log->logError(message); });
+
+    connect(&m_live, &LivePublisher::errorOccurred,
+            this, [this](const QString &message) { log->logWarning(message); });
+
+    connect(&m_msg, &MessagesHandler::messagePosted,
+            this, [this](const QString &message, MessageType type) { m_live.setLastMessage(message, type); },
+            Qt::DirectConnection);
 
+    // Поток GUI в этот момент стоит, поэтому запись в лог
+    // идёт прямо из потока сторожа
+    connect(&m_watchdog, &StallWatchdog::stallDetected,
+            this, [this](qint64 stalledMs, const QStringList &stack) {
+                log->logWarning(QString("GUI thread stalled for %1 ms, stack:\n    %2")
+                                    .arg(stalledMs)
+                                    .arg(stack.isEmpty() ? QString("<unavailable>")
+                                                         : stack.join("\n    ")));
+            }, Qt::DirectConnection);
 
-    if ( conf.readSettings("config.json") ) {
+    connect(&m_watchdog, &StallWatchdog::stallEnded,
+            this, [this](qint64 durationMs) {
+                log->logWarning(QString("GUI thread stall ended after %1 ms").arg(durationMs));
+            }, Qt::DirectConnection);
+
+
+    TRACE_BEGIN(config);
+    const bool configRead = conf.readSettings("config.json");
+    TRACE_END(config, "AppEngine: read config");
+
+    m_configLoaded = configRead;
+    if ( configRead ) {
         log->setLogLevel(conf.getLogicSettings().logLvl);
-        m_Fullscreen = conf.getAppSettings().fullScreen;
+        m_props.setBool(PropFullscreen, conf.getAppSettings().fullScreen);
+        m_props.setBool(PropDebugMode,  conf.getAppSettings().enableDebugMode);
+        m_metrics.start(conf.getDiagnosticsSettings());
+
+        // До запуска планировщика: его потоки получат настройки при регистрации
+        if (conf.getThreadSettings().enabled) {
+            ThreadTopology::instance().configure(conf.getThreadSettings());
+        }
+
+        const DiagnosticsSettings &diag = conf.getDiagnosticsSettings();
+        if (diag.logRotateMb > 0) {
+            log->setMaxFileSize(quint64(diag.logRotateMb) * 1024 * 1024);
+        }
+        if (diag.logArchive) {
+            log->startArchiving(qint64(qMax(diag.logArchiveBudgetMb, 0)) * 1024 * 1024);
+        }
+
+        if (!diag.logCollectorSocket.isEmpty()) {
+            LogShipper::Settings shipping;
+            shipping.socketPath      = diag.logCollectorSocket;
+            shipping.spoolDir        = diag.logSpoolDir;
+            shipping.spoolLimitBytes = qint64(qMax(diag.logSpoolLimitMb, 1)) * 1024 * 1024;
+            shipping.batchBytes      = qint64(qMax(diag.logBatchKb, 1)) * 1024;
+            shipping.batchIntervalMs = qMax(diag.logBatchIntervalMs, 10);
+            log->startShipping(shipping);
+        }
+
+#if defined(QTAPP_ALLOC_TRACKING)
+        const QStringList unknownBudgets = m_memory.setBudgets(diag.allocBudgetsKb);
+        if (!unknownBudgets.isEmpty()) {
+            log->logWarning(QString("Unknown subsystems in allocBudgetsKb: %1")
+                                .arg(unknownBudgets.join(", ")));
+        }
+#endif
+
+        if (!diag.liveChannel.isEmpty() && m_live.start(diag.liveChannel, diag.liveSlots)) {
+            log->logInfo(QString("Live channel %1 started").arg(diag.liveChannel));
+        }
     } else {
         log->logError("Could not find config file or incorrect file structure");
         m_msg.sendError("Could not find config file \nor incorrect file structure");
     }
+
+    // Изменения, не попавшие в config.json до сбоя, применяются поверх него
+    const QMap<QString, double> replayed = m_journal.open("config.journal");
+    for (auto it = replayed.cbegin(); it != replayed.cend(); ++it) {
+        conf.setParameter(it.key(), it.value());
+    }
+    if (!replayed.isEmpty()) {
+        log->logInfo(QString("Replayed %1 parameters from journal").arg(replayed.size()));
+        compactParameters();
+    }
+}
+
+AppEngine::~AppEngine()
+{
+    // Задачи, оставшиеся в очередях, при остановке отбрасываются:
+    // накопленные изменения параметров дописываются в журнал здесь
+    m_scheduler.stop();
+    flushParameters();
+}
+
+void AppEngine::setFullscreen(bool enable)
+{
+    m_props.setBool(PropFullscreen, enable);
+    m_props.flush();
+}
+
+double AppEngine::parameter(const QString &key, double defaultValue) const
+{
+    return conf.getParameters().value(key, defaultValue);
+}
+
+bool AppEngine::setParameter(const QString &key, double value)
+{
+    if (!ParameterJournal::isValidKey(key)) {
+        log->logError(QString("Parameter name '%1' must be 1..%2 bytes").arg(key).arg(ParameterJournal::KEY_SIZE));
+        return false;
+    }
+
+    QMutexLocker locker(&m_journalMutex);
+
+    const QMap<QString, double> parameters = conf.getParameters();
+    const auto current = parameters.constFind(key);
+    if (current != parameters.cend() && *current == value) {
+        return true;
+    }
+
+    conf.setParameter(key, value);
+    m_pendingParameters.insert(key, value);
+    if (!m_flushPosted) {
+        m_flushPosted = true;
+        m_scheduler.post([this]() { flushParameters(); }, TaskScheduler::Low);
+    }
+    return true;
+}
+
+void AppEngine::flushParameters()
+{
+    // Забор очереди и запись - под одной блокировкой: иначе группа,
+    // забранная позже, могла бы попасть в журнал раньше и при
+    // воспроизведении уступить устаревшему значению
+    QMutexLocker flushLocker(&m_flushMutex);
+
+    QMap<QString, double> batch;
+    {
+        QMutexLocker locker(&m_journalMutex);
+        batch.swap(m_pendingParameters);
+        m_flushPosted = false;
+    }
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    m_journal.append(batch);
+
+    if (m_journal.records() >= COMPACT_RECORDS) {
+        m_scheduler.post([this]() { compactParameters(); }, TaskScheduler::Low);
+    }
+}
+
+void AppEngine::compactParameters()
+{
+    quint32 compacted = 0;
+    {
+        QMutexLocker locker(&m_journalMutex);
+
+        // Без прочитанного config.json журнал не очищается: иначе
+        // файл настроек был бы перезаписан значениями по умолчанию
+        if (!m_configLoaded || m_journal.records() == 0) {
+            return;
+        }
+        // Записи до этого номера уже применены к conf и попадут в файл
+        compacted = m_journal.nextSequence();
+    }
+
+    // Сохранение без m_journalMutex: setParameter не ждёт записи
+    // config.json, а его записи, сделанные тем временем, остаются в журнале
+    if (conf.saveSettings("config.json", true, false)) {
+        m_journal.discardBefore(compacted);
+    }
+}
+
+void AppEngine::onPropertiesChanged(quint64 mask)
+{
+    if (mask & (quint64(1) << PropFullscreen)) emit fullscreenChanged();
+    if (mask & (quint64(1) << PropDebugMode)) {
+        m_perf.setEnabled(debugMode());
+        emit debugModeChanged();
+    }
+}
+
+void AppEngine::dumpTrace()
+{
+#if defined(QTAPP_ENABLE_TRACING)
+    if (Trace::Tracer::instance().dumpToDefaultFile()) {
+        log->logInfo("Trace has been written");
+    } else {
+        log->logError("Failed to write trace file");
+    }
+#else
+    log->logWarning("Tracing is disabled at build time (QTAPP_ENABLE_TRACING)");
+#endif
 }
 
 void AppEngine::doSomething(uint btn_id)
@@ -37,16 +234,86 @@ void AppEngine::doSomething(uint btn_id)
     log->logInfo(QString("Button %1 has been clicked.").arg(btn_id));
 }
 
+void AppEngine::ingestSamples(Dsp::SampleBlock &block, double t0, double dt)
+{
+    ALLOC_SCOPE(Acquisition);
+    m_pipeline.process(block);
+
+    if (!block.isEmpty()) {
+        m_samples.appendUniform(t0, dt, block.channel(0), block.size());
+        m_live.publish(block, t0, dt);
+    }
+}
+
 void AppEngine::start()
 {
+    TRACE_SCOPE("AppEngine::start");
+
+    m_scheduler.start();
+    log->logInfo(QString("Task scheduler started with %1 workers")
+                     .arg(m_scheduler.workerCount()));
+
+    const DiagnosticsSettings &diag = conf.getDiagnosticsSettings();
+    m_watchdog.start(diag.stallThresholdMs);
+
+    m_scheduler.schedulePeriodic("parameter compaction",
+                                 std::chrono::seconds(COMPACT_INTERVAL),
+                                 [this]() { compactParameters(); },
+                                 TaskScheduler::Low);
+
+    // К этому времени потоки успевают запуститься и зарегистрироваться
+    m_scheduler.scheduleOnce("thread topology report",
+                             std::chrono::seconds(TOPOLOGY_REPORT),
+                             [this]() {
+                                 log->logInfo(QString("Threads:\n    %1")
+                                                  .arg(ThreadTopology::instance().report().join("\n    ")));
+                             },
+                             TaskScheduler::Low);
+
+#if defined(QTAPP_ALLOC_TRACKING)
+    m_scheduler.schedulePeriodic("memory budgets",
+                                 std::chrono::milliseconds(ALLOC_CHECK_MS),
+                                 [this]() {
+                                     for (const QString &warning : m_memory.check()) {
+                                         log->logWarning(warning);
+                                         m_msg.sendWarning(warning);
+                                     }
+                                 },
+                                 TaskScheduler::Low);
+#endif
+
+    if (m_live.isActive()) {
+        m_scheduler.schedulePeriodic("live status",
+                                     std::chrono::milliseconds(LIVE_STATUS_MS),
+                                     [this]() { m_live.updateStatus(debugMode()); },
+                                     TaskScheduler::Low);
+    }
+
+    if (!diag.metricsSnapshotFile.isEmpty()) {
+        m_scheduler.schedulePeriodic("metrics snapshot",
+                                     std::chrono::seconds(std::max(diag.snapshotIntervalSec, 1)),
+                                     [this]() { m_metrics.writeSnapshot(); },
+                                     TaskScheduler::Low);
+    }
 }
 
 void AppEngine::saveSettings()
 {
+    TRACE_SCOPE("AppEngine::saveSettings");
+
     AppSettings newAppSettings = conf.getAppSettings();
 
-    newAppSettings.fullScreen = m_Fullscreen;
+    newAppSettings.fullScreen = fullscreen();
 
     conf.setAppSettings(newAppSettings);
-    conf.saveSettings("config.json");
+
+    // Сохранение включает и значения из журнала параметров
+    quint32 compacted = 0;
+    {
+        QMutexLocker locker(&m_journalMutex);
+        compacted = m_journal.nextSequence();
+    }
+    if (conf.saveSettings("config.json")) {
+        m_journal.discardBefore(compacted);
+    }
 }
@@ -6,6 +6,19 @@
 #include "common/AsyncLogger.hpp"
 #include "common/MessagesHandler.hpp"
 #include "common/ConfigReader.hpp"
+#include "common/PropertyStore.hpp"
+#include "common/TaskScheduler.hpp"
+#include "common/Tracer.hpp"
+#include "common/MetricsExporter.hpp"
+#include "common/PerfMonitor.hpp"
+#include "common/StallWatchdog.hpp"
+#include "common/ParameterJournal.hpp"
+#include "common/LivePublisher.hpp"
+#include "common/ThreadTopology.hpp"
+#include "common/AllocTracker.hpp"
+#include "common/MemoryBudget.hpp"
+#include "charts/TimeSeries.hpp"
+#include "dsp/FilterPipeline.hpp"
 
 
 using namespace Logger;
@@ -14,10 +27,88 @@ using namespace Logic;
 class AppEngine : public QObject
 {
     Q_OBJECT
-    Q_PROPERTY(bool m_Fullscreen MEMBER m_Fullscreen NOTIFY qmlDataUpdate)
+    Q_PROPERTY(bool m_Fullscreen READ fullscreen WRITE setFullscreen NOTIFY fullscreenChanged)
+    Q_PROPERTY(bool debugMode    READ debugMode  NOTIFY debugModeChanged)
+    Q_PROPERTY(TimeSeries *samples READ samples CONSTANT)
+    Q_PROPERTY(PerfMonitor *perf   READ perf    CONSTANT)
+    Q_PROPERTY(MessagesHandler *messages READ messageModel CONSTANT)
 
 public:
     explicit AppEngine(QObject *parent = nullptr);
+    ~AppEngine() override;
+
+    /**
+     * @brief Формат отображения окна приложения,
+     * по умолчанию не на весь экран
+     */
+    bool fullscreen() const { return m_props.toBool(PropFullscreen); }
+    void setFullscreen(bool enable);
+
+    /**
+     * @brief Включён ли режим отладки (AppSettings::enableDebugMode)
+     */
+    bool debugMode() const { return m_props.toBool(PropDebugMode); }
+
+    /**
+     * @brief Временной ряд обработанных отсчётов для графиков QML
+     */
+    TimeSeries *samples() { return &m_samples; }
+
+    /**
+     * @brief Показатели для панели производительности,
+     * собираются только в режиме отладки
+     */
+    PerfMonitor *perf() { return &m_perf; }
+
+    /**
+     * @brief Планировщик периодических и однократных задач бэкенда
+     */
+    TaskScheduler &scheduler() { return m_scheduler; }
+
+    /**
+     * @brief Обработчик сообщений для GUI
+     */
+    MessagesHandler &messages() { return m_msg; }
+
+    /**
+     * @brief Сообщения для диалога QML, модель списка
+     */
+    MessagesHandler *messageModel() { return &m_msg; }
+
+    /**
+     * @brief Чтение и сохранение настроек
+     */
+    ConfigReader &config() { return conf; }
+
+    /**
+     * @brief Значение числового параметра
+     * @param key Имя параметра, не длиннее ParameterJournal::KEY_SIZE байт
+     * @param defaultValue Значение, если параметр ещё не задавался
+     */
+    Q_INVOKABLE double parameter(const QString &key, double defaultValue = 0) const;
+
+    /**
+     * @brief Изменение числового параметра с сохранением в журнал
+     * @details Значение сразу применяется к настройкам и ставится в
+     * очередь журнала; запись в журнал (32 байта на параметр, один
+     * fdatasync на группу) выполняет задача Low планировщика, повторные
+     * изменения одного параметра до записи сливаются. Поэтому вызов
+     * не ждёт носителя и годится для каждого шага слайдера.
+     * config.json переписывается позже при уплотнении журнала
+     * @return false, если имя параметра недопустимо
+     */
+    Q_INVOKABLE bool setParameter(const QString &key, double value);
+
+    /**
+     * @brief Приём блока отсчётов от источника данных
+     * @param block Блок отсчётов, обрабатывается конвейером на месте
+     * @param t0 Время первого отсчёта, с
+     * @param dt Период дискретизации после конвейера, с
+     * @details Вызывается из потока сбора данных (одного).
+     * Отсчёты нулевого канала попадают во временной ряд samples,
+     * все каналы - в живой канал разделяемой памяти, если он включён
+     */
+    void ingestSamples(Dsp::SampleBlock &block, double t0, double dt);
 
 public slots:
     /**
@@ -28,6 +119,8 @@ public slots:
 
     /**
      * @brief Метод для запуска работы основной логики
+     * @details Запускает планировщик задач. Периодическая работа
+     * бэкенда регистрируется через scheduler()
      */
     void start();
 
@@ -36,27 +129,82 @@ public slots:
      */
     void saveSettings();
 
-signals:
     /**
-     * @brief Обновление данных, отображаемых в QML
+     * @brief Сохранение собранной трассировки в файл
+     * @details Путь берётся из QTAPP_TRACE_FILE, по умолчанию trace.json
      */
-    void qmlDataUpdate();
+    void dumpTrace();
+
+signals:
+    void fullscreenChanged();
+    void debugModeChanged();
 
+private slots:
     /**
-     * @brief Вызов экрана уведомления в GUI
+     * @brief Рассылка NOTIFY-сигналов изменившихся свойств
+     * @param mask Маска изменившихся свойств из PropertyStore
      */
-    void qmlMessageUpdate(const QmlDialogMessage &message);
+    void onPropertiesChanged(quint64 mask);
 
 private:
+    static constexpr int COMPACT_RECORDS  = 1024; //!< Записей журнала до внепланового уплотнения
+    static constexpr int COMPACT_INTERVAL = 60;   //!< Период уплотнения журнала, с
+    static constexpr int LIVE_STATUS_MS   = 1000; //!< Период обновления состояния живого канала, мс
+    static constexpr int TOPOLOGY_REPORT  = 2;    //!< Задержка отчёта о потоках после запуска, с
+    static constexpr int ALLOC_CHECK_MS   = 1000; //!< Период проверки бюджетов памяти, мс
+
     /**
-     * @brief Формат отображения окна приложения,
-     * по умолчанию не на весь экран.
-     * Ещё один вариант задавать - записывать в реестр
+     * @brief Перенос значений журнала параметров в config.json
+     * @details Из любого потока; config.json сохраняется без
+     * уведомления пользователя и без блокировки setParameter, затем
+     * из журнала удаляются перенесённые записи
      */
-    bool m_Fullscreen = false;
+    void compactParameters();
 
+    /**
+     * @brief Запись накопленных изменений параметров в журнал
+     * @details Из любого потока; группы пишутся по одной и по порядку
+     */
+    void flushParameters();
+
+    /**
+     * @brief Номера свойств в хранилище m_props
+     * @details Новое свойство для QML: номер здесь, Q_PROPERTY
+     * с собственным NOTIFY и ветка в onPropertiesChanged()
+     */
+    enum PropertyId {
+        PropFullscreen,
+        PropDebugMode
+    };
+
+    PropertyStore   m_props; //!< Значения свойств, доступных QML
     AsyncLogger    *log;   //!< Логгер
     MessagesHandler m_msg; //!< Обработчик ошибок
     ConfigReader    conf;  //!< Чтение настроек
 
+    Dsp::FilterPipeline m_pipeline; //!< Обработка входящих отсчётов
+    TimeSeries          m_samples;  //!< Обработанные отсчёты для отображения
+
+    MetricsExporter     m_metrics;  //!< Публикация метрик
+    PerfMonitor         m_perf;     //!< Панель производительности
+    StallWatchdog       m_watchdog; //!< Сторож зависаний потока GUI
+    LivePublisher       m_live;     //!< Живой канал отсчётов в разделяемой памяти
+#if defined(QTAPP_ALLOC_TRACKING)
+    MemoryBudget        m_memory;   //!< Бюджеты памяти подсистем
+#endif
+
+    ParameterJournal    m_journal;      //!< Журнал изменений параметров
+    QMutex              m_journalMutex; //!< Изменение conf и очереди - одно действие для снимка уплотнения
+    QMutex              m_flushMutex;   //!< Очерёдность групповых записей в журнал
+    QMap<QString, double> m_pendingParameters;   //!< Изменения, ещё не записанные в журнал
+    bool                  m_flushPosted = false; //!< Задача записи журнала уже в очереди
+    bool                m_configLoaded = false; //!< config.json прочитан, его можно переписывать
+
+    /**
+     * @brief Планировщик фоновых задач
+     * @details Объявлен последним, чтобы останавливаться первым:
+     * задачи могут обращаться к остальным членам класса
+     */
+    TaskScheduler m_scheduler;
+
 };
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGFlatColorMaterial>
+#include <QSGImageNode>
+#include <QSGRendererInterface>
+#include <QPainter>
+#include <QImage>
+#include <QPointer>
+#include <QColor>
+
+#include <limits>
+
+#include "TimeSeries.hpp"
+
+/**
+ * @brief Элемент QML для отрисовки временного ряда ломаной линией
+ * @details Рисует ряд напрямую в графе сцены одной полосой линий
+ * (QSGGeometry::DrawLineStrip), без Canvas и делегатов. Прореживание
+ * под ширину элемента выполняется в updatePolish() в потоке GUI,
+ * поток отрисовки только переносит точки в вершинный буфер.
+ * Буфер выделяется один раз под 2 * ширину вершин и обновляется
+ * на месте: переписываются только изменившиеся вершины, а если
+ * не изменилась ни одна - геометрия не помечается грязной и не
+ * загружается повторно. При программном бэкенде графа сцены
+ * (QT_QUICK_BACKEND=software) линия рисуется QPainter в изображение.
+ *
+ * @code
+ * LineSeries {
+ *     series: app.samples
+ *     timeWindow: 10
+ *     color: "#69e8ff"
+ * }
+ * @endcode
+ */
+class LineSeriesItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(TimeSeries *series     READ series     WRITE setSeries     NOTIFY seriesChanged)
+    Q_PROPERTY(QColor      color      READ color      WRITE setColor      NOTIFY colorChanged)
+    Q_PROPERTY(qreal       lineWidth  READ lineWidth  WRITE setLineWidth  NOTIFY lineWidthChanged)
+    Q_PROPERTY(qreal       timeWindow READ timeWindow WRITE setTimeWindow NOTIFY timeWindowChanged)
+    Q_PROPERTY(qreal       yMin       READ yMin       WRITE setYMin       NOTIFY yRangeChanged)
+    Q_PROPERTY(qreal       yMax       READ yMax       WRITE setYMax       NOTIFY yRangeChanged)
+    Q_PROPERTY(bool        autoScale  READ autoScale  WRITE setAutoScale  NOTIFY yRangeChanged)
+    Q_PROPERTY(TimeSeries::Decimation decimation READ decimation WRITE setDecimation NOTIFY decimationChanged)
+
+public:
+    explicit LineSeriesItem(QQuickItem *parent = nullptr)
+        : QQuickItem(parent) {
+        setFlag(ItemHasContents, true);
+    }
+
+    TimeSeries *series() const { return m_series; }
+    void setSeries(TimeSeries *series) {
+        if (m_series == series) {
+            return;
+        }
+        if (m_series) {
+            disconnect(m_series, nullptr, this, nullptr);
+        }
+        m_series = series;
+        if (m_series) {
+            connect(m_series, &TimeSeries::rangeUpdated, this, &LineSeriesItem::scheduleUpdate);
+        }
+        emit seriesChanged();
+        scheduleUpdate();
+    }
+
+    QColor color() const { return m_color; }
+    void setColor(const QColor &color) {
+        if (m_color != color) {
+            m_color = color;
+            m_colorDirty = true;
+            emit colorChanged();
+            update();
+        }
+    }
+
+    qreal lineWidth() const { return m_lineWidth; }
+    void setLineWidth(qreal width) {
+        if (!qFuzzyCompare(m_lineWidth, width)) {
+            m_lineWidth = width;
+            emit lineWidthChanged();
+            scheduleUpdate();
+        }
+    }
+
+    qreal timeWindow() const { return m_timeWindow; }
+    void setTimeWindow(qreal window) {
+        if (!qFuzzyCompare(m_timeWindow, window)) {
+            m_timeWindow = window;
+            emit timeWindowChanged();
+            scheduleUpdate();
+        }
+    }
+
+    qreal yMin() const { return m_yMin; }
+    void setYMin(qreal value) {
+        if (!qFuzzyCompare(m_yMin, value)) {
+            m_yMin = value;
+            emit yRangeChanged();
+            scheduleUpdate();
+        }
+    }
+
+    qreal yMax() const { return m_yMax; }
+    void setYMax(qreal value) {
+        if (!qFuzzyCompare(m_yMax, value)) {
+            m_yMax = value;
+            emit yRangeChanged();
+            scheduleUpdate();
+        }
+    }
+
+    bool autoScale() const { return m_autoScale; }
+    void setAutoScale(bool enable) {
+        if (m_autoScale != enable) {
+            m_autoScale = enable;
+            emit yRangeChanged();
+            scheduleUpdate();
+        }
+    }
+
+    TimeSeries::Decimation decimation() const { return m_decimation; }
+    void setDecimation(TimeSeries::Decimation method) {
+        if (m_decimation != method) {
+            m_decimation = method;
+            emit decimationChanged();
+            scheduleUpdate();
+        }
+    }
+
+signals:
+    void seriesChanged();
+    void colorChanged();
+    void lineWidthChanged();
+    void timeWindowChanged();
+    void yRangeChanged();
+    void decimationChanged();
+
+protected:
+    /**
+     * @brief Прореживание ряда под текущую ширину, поток GUI
+     * @details Точки сразу переводятся в координаты элемента
+     */
+    void updatePolish() override {
+        m_points.resize(0);
+
+        const int pixelWidth = static_cast<int>(width());
+        if (!m_series || pixelWidth <= 0 || height() <= 0) {
+            return;
+        }
+
+        const double x1 = m_series->maxX();
+        const double x0 = (m_timeWindow > 0) ? x1 - m_timeWindow : m_series->minX();
+
+        m_series->decimateInto(m_points, x0, x1, pixelWidth, m_decimation);
+        if (m_points.isEmpty()) {
+            return;
+        }
+
+        double lo = m_yMin, hi = m_yMax;
+        if (m_autoScale) {
+            lo =  std::numeric_limits<double>::max();
+            hi = -std::numeric_limits<double>::max();
+            for (const auto &p : std::as_const(m_points)) {
+                lo = std::min(lo, p.y());
+                hi = std::max(hi, p.y());
+            }
+        }
+
+        const double sx = (x1 > x0) ? width() / (x1 - x0) : 0.0;
+        const double sy = (hi > lo) ? height() / (hi - lo) : 0.0;
+
+        for (auto &p : m_points) {
+            p.setX((p.x() - x0) * sx);
+            p.setY(height() - (p.y() - lo) * sy);
+        }
+    }
+
+    /**
+     * @brief Обновление узла графа сцены, поток отрисовки
+     */
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) override {
+        if (!window()) {
+            return oldNode;
+        }
+
+        const bool software = window()->rendererInterface()->graphicsApi()
+                              == QSGRendererInterface::Software;
+
+        return software ? updateImageNode(oldNode) : updateGeometryNode(oldNode);
+    }
+
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override {
+        QQuickItem::geometryChange(newGeometry, oldGeometry);
+        if (newGeometry.size() != oldGeometry.size()) {
+            scheduleUpdate();
+        }
+    }
+
+private slots:
+    void scheduleUpdate() {
+        polish();
+        update();
+    }
+
+private:
+    /**
+     * @brief Отрисовка через вершинный буфер (OpenGL/Vulkan/Metal/D3D)
+     */
+    QSGNode *updateGeometryNode(QSGNode *oldNode) {
+        auto *node = static_cast<QSGGeometryNode *>(oldNode);
+        QSGGeometry *geometry = nullptr;
+
+        // Буфер рассчитан на 2 вершины на пиксель - максимум прореживания
+        const int capacity = std::max(2 * static_cast<int>(width()), 2);
+
+        if (!node) {
+            node = new QSGGeometryNode;
+
+            geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), capacity);
+            geometry->setDrawingMode(QSGGeometry::DrawLineStrip);
+            geometry->setVertexDataPattern(QSGGeometry::DynamicPattern);
+            node->setGeometry(geometry);
+            node->setFlag(QSGNode::OwnsGeometry);
+
+            auto *material = new QSGFlatColorMaterial;
+            node->setMaterial(material);
+            node->setFlag(QSGNode::OwnsMaterial);
+
+            m_colorDirty = true;
+        } else {
+            geometry = node->geometry();
+        }
+
+        bool dirty = false;
+
+        if (geometry->vertexCount() != capacity) {
+            geometry->allocate(capacity);
+            dirty = true;
+        }
+
+        if (!qFuzzyCompare(geometry->lineWidth(), static_cast<float>(m_lineWidth))) {
+            geometry->setLineWidth(static_cast<float>(m_lineWidth));
+            dirty = true;
+        }
+
+        // Хвост буфера заполняется последней точкой: вырожденные
+        // сегменты не видны, а размер буфера остаётся постоянным
+        QSGGeometry::Point2D *vertices = geometry->vertexDataAsPoint2D();
+        const int count = static_cast<int>(m_points.size());
+
+        for (int i = 0; i < capacity; ++i) {
+            const QPointF &p = (count == 0) ? QPointF(0, height())
+                                            : m_points[std::min(i, count - 1)];
+            const float vx = static_cast<float>(p.x());
+            const float vy = static_cast<float>(p.y());
+
+            if (vertices[i].x != vx || vertices[i].y != vy) {
+                vertices[i].set(vx, vy);
+                dirty = true;
+            }
+        }
+
+        if (dirty) {
+            node->markDirty(QSGNode::DirtyGeometry);
+        }
+
+        if (m_colorDirty) {
+            static_cast<QSGFlatColorMaterial *>(node->material())->setColor(m_color);
+            node->markDirty(QSGNode::DirtyMaterial);
+            m_colorDirty = false;
+        }
+
+        return node;
+    }
+
+    /**
+     * @brief Отрисовка для программного бэкенда графа сцены
+     * @details Программный рендерер не поддерживает произвольную
+     * геометрию, поэтому линия рисуется в изображение
+     */
+    QSGNode *updateImageNode(QSGNode *oldNode) {
+        auto *node = static_cast<QSGImageNode *>(oldNode);
+        if (!node) {
+            node = window()->createImageNode();
+            node->setOwnsTexture(true);
+        }
+
+        const QSize size = boundingRect().size().toSize().expandedTo(QSize(1, 1));
+        if (m_image.size() != size) {
+            m_image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        }
+        m_image.fill(Qt::transparent);
+
+        if (m_points.size() > 1) {
+            QPainter painter(&m_image);
+            painter.setRenderHint(QPainter::Antialiasing, false);
+            painter.setPen(QPen(m_color, m_lineWidth));
+            painter.drawPolyline(m_points.constData(), static_cast<int>(m_points.size()));
+        }
+
+        node->setTexture(window()->createTextureFromImage(m_image));
+        node->setRect(boundingRect());
+        m_colorDirty = false;
+
+        return node;
+    }
+
+private:
+    QPointer<TimeSeries>   m_series;                           //!< Отображаемый ряд
+    QColor                 m_color      = QColor("#69e8ff");   //!< Цвет линии
+    qreal                  m_lineWidth  = 1.0;                 //!< Толщина линии
+    qreal                  m_timeWindow = 0.0;                 //!< Видимый интервал по X, 0 - весь ряд
+    qreal                  m_yMin       = 0.0;                 //!< Нижняя граница по Y
+    qreal                  m_yMax       = 1.0;                 //!< Верхняя граница по Y
+    bool                   m_autoScale  = true;                //!< Автомасштаб по Y
+    bool                   m_colorDirty = true;                //!< Цвет нужно передать в материал
+    TimeSeries::Decimation m_decimation = TimeSeries::MinMax;  //!< Способ прореживания
+    QList<QPointF>         m_points;                           //!< Точки в координатах элемента
+    QImage                 m_image;                            //!< Холст программного бэкенда
+};
@@ -0,0 +1,454 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QThread>
+#include <QMutex>
+#include <QPointF>
+#include <QList>
+
+#include <atomic>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "../dsp/FilterKernels.hpp"
+
+/**
+ * @brief Временной ряд для графиков QML на кольцевом буфере фиксированной ёмкости
+ * @details Добавлять точки можно из любого потока, буфер не растёт:
+ * при переполнении затираются самые старые точки. QML не получает
+ * каждую точку - графики запрашивают прореженное представление под
+ * ширину в пикселях (min/max или LTTB), а об изменениях ряд сообщает
+ * сигналом rangeUpdated не чаще одного раза за кадр. Ось X должна
+ * быть неубывающей (время).
+ */
+class TimeSeries : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString name          READ name          WRITE setName          NOTIFY nameChanged)
+    Q_PROPERTY(int     capacity      READ capacity      WRITE setCapacity      NOTIFY capacityChanged)
+    Q_PROPERTY(int     frameInterval READ frameInterval WRITE setFrameInterval NOTIFY frameIntervalChanged)
+    Q_PROPERTY(int     count         READ count         NOTIFY rangeUpdated)
+    Q_PROPERTY(double  minX          READ minX          NOTIFY rangeUpdated)
+    Q_PROPERTY(double  maxX          READ maxX          NOTIFY rangeUpdated)
+
+public:
+    /**
+     * @brief Способ прореживания
+     */
+    enum Decimation {
+        MinMax, //!< Минимум и максимум на каждый пиксель, сохраняет выбросы
+        Lttb    //!< Largest-Triangle-Three-Buckets, сохраняет форму кривой
+    };
+    Q_ENUM(Decimation)
+
+    explicit TimeSeries(QObject *parent = nullptr)
+        : QObject(parent) {
+        allocate(DEFAULT_CAPACITY);
+
+        m_frameTimer.setTimerType(Qt::PreciseTimer);
+        m_frameTimer.setInterval(DEFAULT_FRAME_INTERVAL);
+        // Таймер запускается первой новой точкой и останавливается
+        // кадром без новых точек
+        connect(&m_frameTimer, &QTimer::timeout, this, &TimeSeries::publish);
+    }
+
+    QString name() const { return m_name; }
+    void setName(const QString &name) {
+        if (m_name != name) {
+            m_name = name;
+            emit nameChanged();
+        }
+    }
+
+    int capacity() const {
+        QMutexLocker locker(&m_mutex);
+        return static_cast<int>(m_capacity);
+    }
+
+    /**
+     * @brief Изменение ёмкости буфера
+     * @param capacity Новая ёмкость в точках
+     * @details Данные при этом сбрасываются
+     */
+    void setCapacity(int capacity) {
+        if (capacity <= 0 || capacity == this->capacity()) {
+            return;
+        }
+        {
+            QMutexLocker locker(&m_mutex);
+            allocate(static_cast<std::size_t>(capacity));
+        }
+        emit capacityChanged();
+        emit rangeUpdated(0, 0);
+    }
+
+    int frameInterval() const { return m_frameTimer.interval(); }
+    void setFrameInterval(int msec) {
+        if (msec > 0 && msec != m_frameTimer.interval()) {
+            m_frameTimer.setInterval(msec);
+            emit frameIntervalChanged();
+        }
+    }
+
+    int count() const {
+        QMutexLocker locker(&m_mutex);
+        return static_cast<int>(m_count);
+    }
+
+    double minX() const {
+        QMutexLocker locker(&m_mutex);
+        return (m_count > 0) ? m_x[physical(0)] : 0.0;
+    }
+
+    double maxX() const {
+        QMutexLocker locker(&m_mutex);
+        return (m_count > 0) ? m_x[physical(m_count - 1)] : 0.0;
+    }
+
+    /**
+     * @brief Общее количество точек, добавленных с момента создания
+     * @details Не блокирует, можно вызывать из любого потока
+     */
+    qint64 totalAppended() const { return m_total.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Добавление одной точки, потокобезопасно
+     */
+    void append(double x, float y) {
+        appendBlock(&x, &y, 1);
+    }
+
+    /**
+     * @brief Добавление блока точек, потокобезопасно
+     * @param x Значения по оси X
+     * @param y Значения по оси Y
+     * @param n Количество точек
+     */
+    void appendBlock(const double *x, const float *y, std::size_t n) {
+        QMutexLocker locker(&m_mutex);
+        for (std::size_t i = 0; i < n; ++i) {
+            m_x[m_head] = x[i];
+            m_y[m_head] = y[i];
+            m_head = (m_head + 1 == m_capacity) ? 0 : m_head + 1;
+        }
+        m_count = std::min(m_count + n, m_capacity);
+        m_total.fetch_add(static_cast<qint64>(n));
+        wake();
+    }
+
+    /**
+     * @brief Добавление равномерно дискретизированного блока, потокобезопасно
+     * @param x0 Значение X первого отсчёта
+     * @param dx Шаг по X
+     * @param y Отсчёты
+     * @param n Количество отсчётов
+     */
+    void appendUniform(double x0, double dx, const float *y, std::size_t n) {
+        QMutexLocker locker(&m_mutex);
+        for (std::size_t i = 0; i < n; ++i) {
+            m_x[m_head] = x0 + dx * static_cast<double>(i);
+            m_y[m_head] = y[i];
+            m_head = (m_head + 1 == m_capacity) ? 0 : m_head + 1;
+        }
+        m_count = std::min(m_count + n, m_capacity);
+        m_total.fetch_add(static_cast<qint64>(n));
+        wake();
+    }
+
+    /**
+     * @brief Очистка ряда
+     */
+    Q_INVOKABLE void clear() {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_head  = 0;
+            m_count = 0;
+        }
+        emit rangeUpdated(0, 0);
+    }
+
+    /**
+     * @brief Прореженное представление ряда для QML
+     * @param x0 Начало видимого диапазона по X
+     * @param x1 Конец видимого диапазона по X
+     * @param pixelWidth Ширина графика в пикселях
+     * @param method Способ прореживания
+     * @return Не более 2 * pixelWidth точек
+     */
+    Q_INVOKABLE QList<QPointF> decimated(double x0, double x1, int pixelWidth,
+                                         Decimation method = MinMax) const {
+        QList<QPointF> points;
+        decimateInto(points, x0, x1, pixelWidth, method);
+        return points;
+    }
+
+    /**
+     * @brief Прореживание в заранее выделенный список
+     * @details Для C++ кода отрисовки: список переиспользуется между
+     * кадрами и не перевыделяется при неизменной ширине.
+     * Параметры как у decimated()
+     */
+    void decimateInto(QList<QPointF> &points, double x0, double x1, int pixelWidth,
+                      Decimation method = MinMax) const {
+        points.resize(0);
+
+        QMutexLocker locker(&m_mutex);
+
+        if (m_count == 0 || pixelWidth <= 0 || x1 < x0) {
+            return;
+        }
+
+        const std::size_t first = lowerBound(x0);
+        const std::size_t last  = upperBound(x1);
+        if (last <= first) {
+            return;
+        }
+
+        const std::size_t n = last - first;
+        const std::size_t width = static_cast<std::size_t>(pixelWidth);
+
+        if (n <= 2 * width) {
+            for (std::size_t i = first; i < last; ++i) {
+                const std::size_t p = physical(i);
+                points.append(QPointF(m_x[p], m_y[p]));
+            }
+            return;
+        }
+
+        if (method == Lttb && width >= 2) {
+            lttb(points, first, n, 2 * width);
+        } else {
+            minMax(points, first, n, width);
+        }
+    }
+
+signals:
+    void nameChanged();
+    void capacityChanged();
+    void frameIntervalChanged();
+
+    /**
+     * @brief Сигнал об изменении данных, не чаще одного раза за кадр
+     * @param firstIndex Номер первой новой точки с момента создания ряда
+     * @param lastIndex Номер, следующий за последней новой точкой
+     */
+    void rangeUpdated(qint64 firstIndex, qint64 lastIndex);
+
+private slots:
+    /**
+     * @brief Публикация накопленных изменений в потоке GUI
+     */
+    void publish() {
+        const qint64 total = m_total.load();
+        if (total == m_published) {
+            // Новых точек нет: таймер засыпает до следующего добавления
+            m_armed.store(false);
+            m_frameTimer.stop();
+            if (m_total.load() != m_published && !m_armed.exchange(true)) {
+                m_frameTimer.start();
+            }
+            return;
+        }
+        const qint64 first = m_published;
+        m_published = total;
+        emit rangeUpdated(first, total);
+    }
+
+private:
+    static constexpr std::size_t DEFAULT_CAPACITY       = 131072;
+    static constexpr int         DEFAULT_FRAME_INTERVAL = 16;
+
+    void allocate(std::size_t capacity) {
+        m_x.assign(capacity, 0.0);
+        m_y.assign(capacity, 0.0f);
+        m_capacity = capacity;
+        m_head     = 0;
+        m_count    = 0;
+    }
+
+    /**
+     * @brief Физический индекс по логическому (0 - самая старая точка)
+     */
+    std::size_t physical(std::size_t logical) const {
+        std::size_t p = m_head + m_capacity - m_count + logical;
+        return (p >= m_capacity) ? p - m_capacity : p;
+    }
+
+    /**
+     * @brief Логический индекс первой точки с x >= value
+     */
+    std::size_t lowerBound(double value) const {
+        std::size_t lo = 0, hi = m_count;
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            (m_x[physical(mid)] < value) ? lo = mid + 1 : hi = mid;
+        }
+        return lo;
+    }
+
+    /**
+     * @brief Логический индекс первой точки с x > value
+     */
+    std::size_t upperBound(double value) const {
+        std::size_t lo = 0, hi = m_count;
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            (m_x[physical(mid)] <= value) ? lo = mid + 1 : hi = mid;
+        }
+        return lo;
+    }
+
+    /**
+     * @brief Прореживание min/max: до двух точек на пиксель
+     * @details Минимум и максимум ищутся векторным ядром
+     * по непрерывным участкам кольцевого буфера, затем - их положение
+     */
+    void minMax(QList<QPointF> &points, std::size_t first, std::size_t n, std::size_t width) const {
+        points.reserve(static_cast<qsizetype>(2 * width));
+
+        for (std::size_t b = 0; b < width; ++b) {
+            const std::size_t begin = first + b * n / width;
+            const std::size_t end   = first + (b + 1) * n / width;
+            if (end <= begin) {
+                continue;
+            }
+
+            float mn = 0.0f, mx = 0.0f;
+            bool  init = false;
+
+            std::size_t i = begin;
+            while (i < end) {
+                const std::size_t p   = physical(i);
+                const std::size_t run = std::min(end - i, m_capacity - p);
+
+                float lo, hi;
+                Dsp::Kernels::minMax(m_y.data() + p, run, lo, hi);
+                mn = init ? std::min(mn, lo) : lo;
+                mx = init ? std::max(mx, hi) : hi;
+                init = true;
+
+                i += run;
+            }
+
+            // Экстремумы выводятся в точках, где они достигнуты, и в порядке
+            // следования: иначе спад внутри пикселя рисуется как подъём
+            const std::size_t iMin = indexOf(mn, begin, end);
+            const std::size_t iMax = indexOf(mx, begin, end);
+            const std::size_t pMin = physical(iMin);
+            const std::size_t pMax = physical(iMax);
+
+            if (iMin == iMax) {
+                points.append(QPointF(m_x[pMin], mn));
+            } else if (iMin < iMax) {
+                points.append(QPointF(m_x[pMin], mn));
+                points.append(QPointF(m_x[pMax], mx));
+            } else {
+                points.append(QPointF(m_x[pMax], mx));
+                points.append(QPointF(m_x[pMin], mn));
+            }
+        }
+    }
+
+    /**
+     * @brief Логический индекс первой точки в [begin, end) со значением value
+     * @details Значение заведомо есть в диапазоне: найдено ядром minMax
+     */
+    std::size_t indexOf(float value, std::size_t begin, std::size_t end) const {
+        std::size_t i = begin;
+        while (i < end) {
+            const std::size_t p   = physical(i);
+            const std::size_t run = std::min(end - i, m_capacity - p);
+            const float *data = m_y.data() + p;
+            const float *hit  = std::find(data, data + run, value);
+            if (hit != data + run) {
+                return i + static_cast<std::size_t>(hit - data);
+            }
+            i += run;
+        }
+        return begin;
+    }
+
+    /**
+     * @brief Прореживание Largest-Triangle-Three-Buckets
+     * @details Sveinn Steinarsson, "Downsampling Time Series for Visual
+     * Representation", 2013. Первая и последняя точки сохраняются,
+     * из каждой корзины берётся точка, образующая треугольник
+     * наибольшей площади с предыдущей выбранной и средним следующей корзины
+     */
+    void lttb(QList<QPointF> &points, std::size_t first, std::size_t n, std::size_t threshold) const {
+        points.reserve(static_cast<qsizetype>(threshold));
+
+        auto px = [&](std::size_t i) { return m_x[physical(first + i)]; };
+        auto py = [&](std::size_t i) { return static_cast<double>(m_y[physical(first + i)]); };
+
+        const double every = static_cast<double>(n - 2) / static_cast<double>(threshold - 2);
+        std::size_t a = 0;
+
+        points.append(QPointF(px(0), py(0)));
+
+        for (std::size_t b = 0; b < threshold - 2; ++b) {
+            std::size_t avgBegin = static_cast<std::size_t>(std::floor((b + 1) * every)) + 1;
+            std::size_t avgEnd   = std::min(static_cast<std::size_t>(std::floor((b + 2) * every)) + 1, n);
+
+            double avgX = 0.0, avgY = 0.0;
+            for (std::size_t i = avgBegin; i < avgEnd; ++i) {
+                avgX += px(i);
+                avgY += py(i);
+            }
+            const double avgCount = std::max<double>(static_cast<double>(avgEnd - avgBegin), 1.0);
+            avgX /= avgCount;
+            avgY /= avgCount;
+
+            const std::size_t rangeBegin = static_cast<std::size_t>(std::floor(b * every)) + 1;
+            const std::size_t rangeEnd   = static_cast<std::size_t>(std::floor((b + 1) * every)) + 1;
+
+            const double ax = px(a), ay = py(a);
+            double maxArea = -1.0;
+            std::size_t next = rangeBegin;
+
+            for (std::size_t i = rangeBegin; i < rangeEnd; ++i) {
+                const double area = std::abs((ax - avgX) * (py(i) - ay) -
+                                             (ax - px(i)) * (avgY - ay));
+                if (area > maxArea) {
+                    maxArea = area;
+                    next = i;
+                }
+            }
+
+            points.append(QPointF(px(next), py(next)));
+            a = next;
+        }
+
+        points.append(QPointF(px(n - 1), py(n - 1)));
+    }
+
+    /**
+     * @brief Запуск таймера публикации, если он стоит
+     */
+    void wake() {
+        if (m_armed.exchange(true)) {
+            return;
+        }
+        if (QThread::currentThread() == thread()) {
+            m_frameTimer.start();
+        } else {
+            QMetaObject::invokeMethod(&m_frameTimer, [this]() { m_frameTimer.start(); },
+                                      Qt::QueuedConnection);
+        }
+    }
+
+private:
+    QString             m_name;           //!< Имя ряда для подписи
+    std::vector<double> m_x;              //!< Кольцевой буфер значений X
+    std::vector<float>  m_y;              //!< Кольцевой буфер значений Y
+    std::size_t         m_capacity = 0;   //!< Ёмкость буфера
+    std::size_t         m_head     = 0;   //!< Индекс следующей записи
+    std::size_t         m_count    = 0;   //!< Количество точек в буфере
+    std::atomic<qint64> m_total{0};       //!< Добавлено точек всего
+    qint64              m_published = 0;  //!< Опубликовано точек всего (поток GUI)
+    mutable QMutex      m_mutex;          //!< Синхронизация буфера
+    QTimer              m_frameTimer;     //!< Таймер публикации изменений
+    std::atomic<bool>   m_armed{false};   //!< Таймер публикации запущен или запускается
+};
@@ -0,0 +1,175 @@
+// Сборщик логов для отладки и проверки LogShipper: принимает пакеты
+// через Unix-сокет, отбрасывает повторы, подтверждает приём и пишет
+// строки в файл или stdout.
+//
+//   QTemplateAppLogCollector [--socket /tmp/qtapp-logs.sock] [--output -] [--state FILE]
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QHash>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <cstdio>
+
+#include "common/LogBatch.hpp"
+
+
+/**
+ * @brief Состояние сборщика
+ * @details Номер последнего принятого пакета каждого источника
+ * хранится в файле state, чтобы повторы отбрасывались и после
+ * перезапуска сборщика
+ */
+struct Collector {
+    QFile                             output;
+    QString                           statePath;
+    QHash<quint64, quint64>           lastSequence; //!< Последний принятый пакет источника
+    QHash<QLocalSocket *, QByteArray> buffers;      //!< Неразобранные данные соединений
+    quint64                           accepted   = 0;
+    quint64                           duplicates = 0;
+
+    void loadState() {
+        QFile file(statePath);
+        if (statePath.isEmpty() || !file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            return;
+        }
+        QTextStream stream(&file);
+        while (!stream.atEnd()) {
+            const QStringList fields = stream.readLine().split(' ', Qt::SkipEmptyParts);
+            if (fields.size() == 2) {
+                lastSequence.insert(fields[0].toULongLong(nullptr, 16), fields[1].toULongLong());
+            }
+        }
+    }
+
+    void saveState() {
+        if (statePath.isEmpty()) {
+            return;
+        }
+        QSaveFile file(statePath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            return;
+        }
+        QTextStream stream(&file);
+        for (auto it = lastSequence.cbegin(); it != lastSequence.cend(); ++it) {
+            stream << QString::number(it.key(), 16) << ' ' << it.value() << '\n';
+        }
+        stream.flush();
+        file.commit();
+    }
+
+    /**
+     * @brief Разбор накопленных данных соединения
+     * @return false при нарушении протокола
+     */
+    bool process(QLocalSocket *socket) {
+        QByteArray &buffer = buffers[socket];
+
+        while (buffer.size() >= LogBatch::HEADER_SIZE) {
+            const std::optional<LogBatch::Header> header = LogBatch::decodeHeader(buffer.constData());
+            if (!header) {
+                std::fprintf(stderr, "Protocol error, dropping connection\n");
+                return false;
+            }
+
+            const qsizetype frameSize = LogBatch::HEADER_SIZE + qsizetype(header->size);
+            if (buffer.size() < frameSize) {
+                break;
+            }
+
+            if (header->sequence > lastSequence.value(header->source, 0)) {
+                const QByteArray lines = qUncompress(buffer.mid(LogBatch::HEADER_SIZE, header->size));
+                if (lines.isEmpty() && header->lines > 0) {
+                    std::fprintf(stderr, "Corrupt batch %016llx/%llu, dropping connection\n",
+                                 header->source, header->sequence);
+                    return false;
+                }
+
+                output.write(lines);
+                output.flush();
+                lastSequence.insert(header->source, header->sequence);
+                saveState();
+                ++accepted;
+
+                std::fprintf(stderr, "batch %016llx/%llu: %u lines, %lld -> %u bytes\n",
+                             header->source, header->sequence, header->lines,
+                             static_cast<long long>(lines.size()), header->size);
+            } else {
+                ++duplicates;
+                std::fprintf(stderr, "batch %016llx/%llu: duplicate, skipped (%llu total)\n",
+                             header->source, header->sequence, duplicates);
+            }
+
+            buffer.remove(0, frameSize);
+            socket->write(LogBatch::encodeAck(header->source, header->sequence));
+        }
+        return true;
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("QTemplateAppLogCollector");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Stand-in log collector for the application log shipping");
+    parser.addHelpOption();
+
+    QCommandLineOption socketOption("socket", "Unix socket to listen on.",
+                                    "path", "/tmp/qtapp-logs.sock");
+    QCommandLineOption outputOption("output", "File to append received lines to, '-' - stdout.",
+                                    "file", "-");
+    QCommandLineOption stateOption("state", "File with last accepted batch per source, "
+                                            "keeps deduplication across restarts.",
+                                   "file");
+    parser.addOption(socketOption);
+    parser.addOption(outputOption);
+    parser.addOption(stateOption);
+    parser.process(app);
+
+    Collector collector;
+    collector.statePath = parser.value(stateOption);
+    collector.loadState();
+
+    const QString outputPath = parser.value(outputOption);
+    const bool opened = (outputPath == "-")
+        ? collector.output.open(stdout, QIODevice::WriteOnly)
+        : (collector.output.setFileName(outputPath),
+           collector.output.open(QIODevice::WriteOnly | QIODevice::Append));
+    if (!opened) {
+        std::fprintf(stderr, "Cannot open %s: %s\n", qPrintable(outputPath),
+                     qPrintable(collector.output.errorString()));
+        return 1;
+    }
+
+    QLocalServer server;
+    QLocalServer::removeServer(parser.value(socketOption));
+    if (!server.listen(parser.value(socketOption))) {
+        std::fprintf(stderr, "Cannot listen on %s: %s\n", qPrintable(parser.value(socketOption)),
+                     qPrintable(server.errorString()));
+        return 1;
+    }
+
+    QObject::connect(&server, &QLocalServer::newConnection, &server, [&]() {
+        while (QLocalSocket *socket = server.nextPendingConnection()) {
+            QObject::connect(socket, &QLocalSocket::readyRead, socket, [&collector, socket]() {
+                collector.buffers[socket].append(socket->readAll());
+                if (!collector.process(socket)) {
+                    socket->abort();
+                }
+            });
+            QObject::connect(socket, &QLocalSocket::disconnected, socket, [&collector, socket]() {
+                collector.buffers.remove(socket);
+                socket->deleteLater();
+            });
+        }
+    });
+
+    std::fprintf(stderr, "Listening on %s\n", qPrintable(server.fullServerName()));
+    return app.exec();
+}
@@ -0,0 +1,378 @@
+#include "AllocTracker.hpp"
+
+#if defined(QTAPP_ALLOC_TRACKING)
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#include <unistd.h>
+
+// Выделение glibc в обход замены malloc ниже
+extern "C" {
+    void *__libc_malloc(std::size_t size);
+    void *__libc_calloc(std::size_t count, std::size_t size);
+    void *__libc_realloc(void *block, std::size_t size);
+    void *__libc_memalign(std::size_t alignment, std::size_t size);
+    void  __libc_free(void *block);
+}
+#endif
+
+namespace AllocTracker {
+
+namespace {
+
+    /**
+     * @brief Заголовок блока
+     * @details Лежит непосредственно перед адресом, выданным программе.
+     * offset - расстояние от начала блока malloc до этого адреса:
+     * HEADER_SIZE, а у блоков с повышенным выравниванием - само выравнивание
+     */
+    struct Header {
+        std::size_t   size;
+        std::uint32_t offset;
+        Tag           tag;
+    };
+    static_assert(sizeof(Header) <= HEADER_SIZE);
+    static_assert(HEADER_SIZE % alignof(std::max_align_t) == 0,
+                  "Блок после заголовка должен сохранять выравнивание malloc");
+
+    /**
+     * @brief Счётчики одной подсистемы в одном наборе
+     */
+    struct Counters {
+        std::atomic<std::uint64_t> allocations { 0 };
+        std::atomic<std::uint64_t> frees       { 0 };
+        std::atomic<std::uint64_t> bytes       { 0 };
+        std::atomic<std::uint64_t> freedBytes  { 0 };
+    };
+
+    /**
+     * @brief Набор счётчиков всех подсистем на своих линиях кеша
+     */
+    struct alignas(64) Shard {
+        Counters tags[TagCount];
+    };
+
+    // Первые SHARD_COUNT потоков получают собственный набор и пишут в
+    // него без атомарных операций чтения-изменения-записи: у набора один
+    // писатель. Остальные потоки делят последний набор через fetch_add.
+    // Набор завершившегося потока не освобождается, его счётчики
+    // остаются в сумме
+    constinit Shard                 g_shards[SHARD_COUNT + 1];
+    constinit std::atomic<unsigned> g_nextShard { 0 };
+    constinit thread_local Shard   *t_shard     = nullptr;
+    constinit thread_local bool     t_exclusive = false;
+
+    Shard &shard() {
+        if (!t_shard) {
+            const unsigned index = g_nextShard.fetch_add(1, std::memory_order_relaxed);
+            t_exclusive = index < SHARD_COUNT;
+            t_shard = &g_shards[t_exclusive ? index : SHARD_COUNT];
+        }
+        return *t_shard;
+    }
+
+    void add(std::atomic<std::uint64_t> &counter, std::uint64_t value) {
+        if (t_exclusive) {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        } else {
+            counter.fetch_add(value, std::memory_order_relaxed);
+        }
+    }
+
+#if defined(__GLIBC__)
+    void *rawMalloc(std::size_t size)                         { return __libc_malloc(size); }
+    void *rawRealloc(void *block, std::size_t size)           { return __libc_realloc(block, size); }
+    void *rawMemalign(std::size_t alignment, std::size_t size) { return __libc_memalign(alignment, size); }
+    void  rawFree(void *block)                                { __libc_free(block); }
+#else
+    // Без glibc malloc не заменяется: учитывается только operator new
+    void *rawMalloc(std::size_t size)                         { return std::malloc(size); }
+    void  rawFree(void *block)                                { std::free(block); }
+#endif
+
+    Header *headerOf(void *pointer) {
+        return reinterpret_cast<Header *>(static_cast<char *>(pointer) - HEADER_SIZE);
+    }
+
+    void *blockOf(void *pointer) {
+        return static_cast<char *>(pointer) - headerOf(pointer)->offset;
+    }
+
+    /**
+     * @brief Заголовок и учёт нового блока
+     * @return Адрес для программы
+     */
+    void *track(void *block, std::size_t offset, std::size_t size, Tag tag) {
+        char *pointer = static_cast<char *>(block) + offset;
+        Header *header = headerOf(pointer);
+        header->size   = size;
+        header->offset = static_cast<std::uint32_t>(offset);
+        header->tag    = tag;
+
+        Counters &counters = shard().tags[tag];
+        add(counters.allocations, 1);
+        add(counters.bytes, size);
+        return pointer;
+    }
+
+    void untrack(const Header *header) {
+        Counters &counters = shard().tags[header->tag];
+        add(counters.frees, 1);
+        add(counters.freedBytes, header->size);
+    }
+
+    void *allocate(std::size_t size) noexcept {
+        if (size > SIZE_MAX - HEADER_SIZE) {
+            return nullptr;
+        }
+        void *block = rawMalloc(size + HEADER_SIZE);
+        return block ? track(block, HEADER_SIZE, size, t_tag) : nullptr;
+    }
+
+    void release(void *pointer) noexcept {
+        if (!pointer) {
+            return;
+        }
+        const Header *header = headerOf(pointer);
+        untrack(header);
+        rawFree(blockOf(pointer));
+    }
+
+#if defined(__GLIBC__)
+    /**
+     * @brief Блок с выравниванием больше стандартного
+     * @details Перед адресом оставляется alignment байт (не меньше
+     * HEADER_SIZE), заголовок - в их конце
+     */
+    void *allocateAligned(std::size_t alignment, std::size_t size) noexcept {
+        if (alignment <= alignof(std::max_align_t)) {
+            return allocate(size);
+        }
+        if (size > SIZE_MAX - alignment || alignment > UINT32_MAX) {
+            return nullptr;
+        }
+        void *block = rawMemalign(alignment, size + alignment);
+        return block ? track(block, alignment, size, t_tag) : nullptr;
+    }
+
+    /**
+     * @brief realloc с учётом: блок остаётся за подсистемой, которая его выделила
+     * @details Считается как освобождение прежнего размера и выделение
+     * нового, поэтому рост контейнера виден в счётчике выделений
+     */
+    void *reallocate(void *pointer, std::size_t size) noexcept {
+        if (!pointer) {
+            return allocate(size);
+        }
+        if (size == 0) {
+            release(pointer);
+            return nullptr;
+        }
+
+        Header *header = headerOf(pointer);
+        const Tag         tag     = header->tag;
+        const std::size_t oldSize = header->size;
+
+        if (header->offset != HEADER_SIZE) {
+            // Выровненный блок: realloc выравнивание не сохраняет
+            void *moved = allocate(size);
+            if (!moved) {
+                return nullptr;
+            }
+            headerOf(moved)->tag = tag;
+            std::memcpy(moved, pointer, oldSize < size ? oldSize : size);
+            release(pointer);
+            return moved;
+        }
+
+        if (size > SIZE_MAX - HEADER_SIZE) {
+            return nullptr;
+        }
+        void *block = rawRealloc(blockOf(pointer), size + HEADER_SIZE);
+        if (!block) {
+            return nullptr;
+        }
+
+        Header moved { oldSize, HEADER_SIZE, tag };
+        untrack(&moved);
+        return track(block, HEADER_SIZE, size, tag);
+    }
+#endif
+
+    void *allocateOrThrow(std::size_t size) {
+        for (;;) {
+            if (void *pointer = allocate(size)) {
+                return pointer;
+            }
+            // Как в стандартном operator new: обработчик может освободить память
+            std::new_handler handler = std::get_new_handler();
+            if (!handler) {
+                throw std::bad_alloc();
+            }
+            handler();
+        }
+    }
+}
+
+TagStats stats(Tag tag) {
+    TagStats result;
+    std::uint64_t freedBytes = 0;
+    for (const Shard &s : g_shards) {
+        const Counters &counters = s.tags[tag];
+        result.allocations += counters.allocations.load(std::memory_order_relaxed);
+        result.frees       += counters.frees.load(std::memory_order_relaxed);
+        result.bytes       += counters.bytes.load(std::memory_order_relaxed);
+        freedBytes         += counters.freedBytes.load(std::memory_order_relaxed);
+    }
+    result.liveBytes = static_cast<std::int64_t>(result.bytes - freedBytes);
+    return result;
+}
+
+HeapStats heap() {
+    HeapStats result;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    result.inUse  = info.uordblks + info.hblkhd;
+    result.mapped = info.hblkhd;
+    result.free   = info.fordblks;
+#elif defined(__GLIBC__)
+    // До glibc 2.33 поля int и переполняются после 2 ГБ
+    const struct mallinfo info = mallinfo();
+    result.inUse  = static_cast<unsigned>(info.uordblks) + static_cast<unsigned>(info.hblkhd);
+    result.mapped = static_cast<unsigned>(info.hblkhd);
+    result.free   = static_cast<unsigned>(info.fordblks);
+#endif
+    return result;
+}
+
+}
+
+// Замена глобальных operator new/delete. Варианты с align_val_t
+// остаются стандартными: они выделяют память через aligned_alloc
+// и освобождают через free, то есть через замену ниже
+void *operator new(std::size_t size)   { return AllocTracker::allocateOrThrow(size); }
+void *operator new[](std::size_t size) { return AllocTracker::allocateOrThrow(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return AllocTracker::allocate(size);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return AllocTracker::allocate(size);
+}
+
+void operator delete(void *pointer) noexcept   { AllocTracker::release(pointer); }
+void operator delete[](void *pointer) noexcept { AllocTracker::release(pointer); }
+
+void operator delete(void *pointer, std::size_t) noexcept   { AllocTracker::release(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { AllocTracker::release(pointer); }
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept   { AllocTracker::release(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { AllocTracker::release(pointer); }
+
+#if defined(__GLIBC__)
+// Замена malloc и родственных функций: контейнеры Qt и библиотеки C
+// выделяют память мимо operator new. glibc допускает такую замену в
+// исполняемом файле, вызовы из разделяемых библиотек тоже приходят
+// сюда. Заменены все функции, выдающие память для free(), иначе free
+// получил бы блок без заголовка
+extern "C" {
+
+void *malloc(std::size_t size) {
+    void *pointer = AllocTracker::allocate(size);
+    if (!pointer) {
+        errno = ENOMEM;
+    }
+    return pointer;
+}
+
+void *calloc(std::size_t count, std::size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    const std::size_t total = count * size;
+    if (total > SIZE_MAX - AllocTracker::HEADER_SIZE) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    // Заголовок пишется поверх обнулённой памяти, блок после него - нули
+    void *block = __libc_calloc(1, total + AllocTracker::HEADER_SIZE);
+    if (!block) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return AllocTracker::track(block, AllocTracker::HEADER_SIZE, total, AllocTracker::t_tag);
+}
+
+void *realloc(void *pointer, std::size_t size) {
+    void *result = AllocTracker::reallocate(pointer, size);
+    if (!result && size != 0) {
+        errno = ENOMEM;
+    }
+    return result;
+}
+
+void *reallocarray(void *pointer, std::size_t count, std::size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return realloc(pointer, count * size);
+}
+
+void free(void *pointer) {
+    AllocTracker::release(pointer);
+}
+
+void *memalign(std::size_t alignment, std::size_t size) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    void *pointer = AllocTracker::allocateAligned(alignment, size);
+    if (!pointer) {
+        errno = ENOMEM;
+    }
+    return pointer;
+}
+
+void *aligned_alloc(std::size_t alignment, std::size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **result, std::size_t alignment, std::size_t size) {
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0 || alignment == 0) {
+        return EINVAL;
+    }
+    void *pointer = AllocTracker::allocateAligned(alignment, size);
+    if (!pointer) {
+        return ENOMEM;
+    }
+    *result = pointer;
+    return 0;
+}
+
+void *valloc(std::size_t size) {
+    return memalign(static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)), size);
+}
+
+void *pvalloc(std::size_t size) {
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return memalign(page, (size + page - 1) / page * page);
+}
+
+// Размер, запрошенный при выделении: не меньше, чем требует стандарт
+std::size_t malloc_usable_size(void *pointer) {
+    return pointer ? AllocTracker::headerOf(pointer)->size : 0;
+}
+
+}
+#endif
+
+#endif
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Учёт выделений памяти по подсистемам
+ * @details Собирается только при опции CMake QTAPP_ALLOC_TRACKING и не
+ * в Release; иначе макросы ALLOC_SCOPE и ALLOC_THREAD_TAG раскрываются
+ * в пустые выражения, а operator new/delete остаются стандартными.
+ *
+ * AllocTracker.cpp заменяет глобальные operator new/delete, а с glibc
+ * и malloc, calloc, realloc, free и функции выделения с выравниванием:
+ * перед каждым блоком хранится заголовок HEADER_SIZE байт с размером и
+ * меткой подсистемы, поэтому освобождение и realloc засчитываются той
+ * подсистеме, которая выделила память, в каком бы потоке они ни
+ * произошли. Метка берётся из
+ * переменной потока: ALLOC_SCOPE(tag) ставит её на время блока,
+ * ALLOC_THREAD_TAG(tag) - до конца жизни потока. Первые SHARD_COUNT
+ * потоков пишут в собственные наборы счётчиков без атомарных
+ * инструкций и без общих линий кеша; следующие делят один набор.
+ *
+ * Так подсистемам приписываются и контейнеры Qt (QString, QByteArray,
+ * QList), которые выделяют память через malloc. Сама память берётся у
+ * glibc через __libc_malloc и родственные функции, поэтому heap()
+ * (по mallinfo2) по-прежнему показывает всю кучу, включая заголовки.
+ * Без glibc учитывается только operator new.
+ *
+ * Заголовок не зависит от Qt.
+ */
+namespace AllocTracker {
+
+    /**
+     * @brief Подсистемы
+     */
+    enum Tag : std::uint8_t {
+        Untagged,    //!< Без метки
+        Logger,      //!< Логгер, отправка и сжатие логов
+        Messages,    //!< Сообщения GUI
+        Config,      //!< Чтение и сохранение настроек
+        QmlEngine,   //!< Движок QML: поток GUI и поток отрисовки
+        Acquisition, //!< Приём и обработка отсчётов
+        TagCount
+    };
+
+    /**
+     * @brief Счётчики подсистемы с запуска процесса
+     */
+    struct TagStats {
+        std::uint64_t allocations = 0; //!< Выделений
+        std::uint64_t frees       = 0; //!< Освобождений
+        std::uint64_t bytes       = 0; //!< Выделено байт всего
+        std::int64_t  liveBytes   = 0; //!< Выделено и не освобождено, байт
+    };
+
+    /**
+     * @brief Общие показатели кучи malloc
+     */
+    struct HeapStats {
+        std::uint64_t inUse  = 0; //!< Занято блоками malloc, включая mmap, байт
+        std::uint64_t mapped = 0; //!< Из них блоками mmap, байт
+        std::uint64_t free   = 0; //!< Свободно в куче, байт
+    };
+
+    inline const char *tagName(Tag tag) {
+        switch (tag) {
+        case Untagged:    return "untagged";
+        case Logger:      return "logger";
+        case Messages:    return "messages";
+        case Config:      return "config";
+        case QmlEngine:   return "qml";
+        case Acquisition: return "acquisition";
+        default:          return "unknown";
+        }
+    }
+
+#if defined(QTAPP_ALLOC_TRACKING)
+
+    static constexpr std::size_t HEADER_SIZE = 16; //!< Заголовок перед блоком
+    static constexpr unsigned    SHARD_COUNT = 64; //!< Потоков с собственным набором счётчиков
+
+    /**
+     * @brief Метка текущего потока
+     */
+    inline constinit thread_local Tag t_tag = Untagged;
+
+    /**
+     * @brief Смена метки потока
+     * @return Предыдущая метка
+     */
+    inline Tag exchangeTag(Tag tag) {
+        const Tag previous = t_tag;
+        t_tag = tag;
+        return previous;
+    }
+
+    /**
+     * @brief Счётчики подсистемы, сумма по всем потокам
+     */
+    TagStats stats(Tag tag);
+
+    /**
+     * @brief Показатели кучи (glibc), на других платформах нули
+     */
+    HeapStats heap();
+
+    /**
+     * @brief Метка потока на время жизни объекта
+     */
+    class Scope {
+    public:
+        explicit Scope(Tag tag) : m_previous(exchangeTag(tag)) {}
+        ~Scope() { exchangeTag(m_previous); }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Tag m_previous;
+    };
+
+#endif
+}
+
+#define ALLOC_CONCAT_IMPL(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_IMPL(a, b)
+
+#if defined(QTAPP_ALLOC_TRACKING)
+    //! Метка подсистемы до конца текущей области видимости
+    #define ALLOC_SCOPE(tag) \
+        AllocTracker::Scope ALLOC_CONCAT(allocScope_, __LINE__)(AllocTracker::tag)
+    //! Метка подсистемы для всех дальнейших выделений потока
+    #define ALLOC_THREAD_TAG(tag) \
+        static_cast<void>(AllocTracker::exchangeTag(AllocTracker::tag))
+#else
+    #define ALLOC_SCOPE(tag)      ((void)0)
+    #define ALLOC_THREAD_TAG(tag) ((void)0)
+#endif
@@ -0,0 +1,9 @@
+#include "AsyncLogger.hpp"
+
+namespace Logger {
+
+// Инициализация статических членов
+AsyncLogger* AsyncLogger::m_instance = nullptr;
+std::once_flag AsyncLogger::m_onceFlag;
+
+}
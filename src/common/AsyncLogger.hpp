@@ -10,12 +10,19 @@
 #include <QFuture>
 #include <QtConcurrent>
 #include <QWaitCondition>
+#include <QDeadlineTimer>
 #include <QRecursiveMutex>
 #include <QAtomicInteger>
 #include <QMutex>
 #include <QGlobalStatic>
 
 #include "FileHelper.hpp"
+#include "Tracer.hpp"
+#include "Metrics.hpp"
+#include "LogShipper.hpp"
+#include "LogArchiver.hpp"
+#include "ThreadTopology.hpp"
+#include "AllocTracker.hpp"
 
 namespace Logger {
 /**
@@ -86,6 +93,56 @@ public:
         emit ErrorOccured( QString("Incorrect log level string: %1").arg(level) );
     }
 
+    /**
+     * @brief Включение отправки записей сборщику логов
+     * @param settings Параметры отправки, см. LogShipper
+     * @details Записи продолжают писаться и в файл. Повторный
+     * вызов игнорируется
+     */
+    void startShipping(const LogShipper::Settings &settings) {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_shipper) {
+                return;
+            }
+            m_shipper = std::make_unique<LogShipper>(settings, [this](const QString &message) {
+                logWarning(message);
+            });
+        }
+        m_condition.wakeAll();
+    }
+
+    /**
+     * @brief Размер файла лога, после которого начинается новый файл
+     * @param bytes Размер в байтах
+     */
+    void setMaxFileSize(quint64 bytes) {
+        m_maxFileSize.storeRelaxed(bytes);
+    }
+
+    /**
+     * @brief Включение сжатия закрытых файлов лога
+     * @param budgetBytes Предельный объём архивов, 0 - старые не удаляются
+     * @details Файлы log_*.log, оставшиеся от прошлых запусков,
+     * сжимаются сразу. Повторный вызов игнорируется
+     */
+    void startArchiving(qint64 budgetBytes) {
+        LogArchiver *archiver = nullptr;
+        QString activeFile;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_archiver) {
+                return;
+            }
+            m_archiver = std::make_unique<LogArchiver>(
+                m_logFilePath.isEmpty() ? QString("./") : m_logFilePath, budgetBytes,
+                [this](const QString &message) { logWarning(message); });
+            archiver   = m_archiver.get();
+            activeFile = m_logFile ? m_logFile->fileName() : QString();
+        }
+        archiver->start(activeFile);
+    }
+
     /**
      * @brief  Явный метод для остановки логгирования
      */
@@ -97,6 +154,10 @@ public:
         m_condition.wakeAll();
         m_future.waitForFinished();
 
+        if (m_archiver) {
+            m_archiver->stop();
+        }
+
         if (m_logFile->isOpen()) {
             m_logFile->close();
         }
@@ -179,7 +240,14 @@ private:
           m_logFileName(logFileName),
           m_currentLogLevel(Info),
           m_stop(false),
-          m_maxFileSize(DEFAULT_FILE_SIZE) {
+          m_maxFileSize(DEFAULT_FILE_SIZE),
+          m_metricMessages(Metrics::Registry::instance().counter(
+              "logger_messages_total", "Log messages accepted by the logger")),
+          m_metricQueueDepth(Metrics::Registry::instance().gauge(
+              "logger_queue_depth", "Log messages waiting to be written")),
+          m_metricWriteTime(Metrics::Registry::instance().histogram(
+              "logger_write_ns", "Time to write one log line to file, ns")) {
+        TRACE_SCOPE("AsyncLogger::AsyncLogger");
 
         FileHelper fhelp;
         m_logFile = fhelp.createFile(m_logFilePath, m_logFileName);
@@ -224,6 +292,8 @@ private:
         }
 
         m_logQueue.enqueue(formatMessage(level, message));
+        m_metricMessages.add();
+        m_metricQueueDepth.set(m_logQueue.size());
         m_condition.wakeOne();
     }
 
@@ -257,46 +327,98 @@ private:
      * новый файл и пишет в него
      */
     void processLogQueue() {
+        ThreadTopology::Scope topology(ThreadTopology::Logging, "logger");
+        ALLOC_THREAD_TAG(Logger);
+        LogShipper *shipper = nullptr;
+
         forever {
             QString message;
 
             {
                 QMutexLocker locker(&m_mutex);
 
+                // С включённой отправкой ожидание ограничено
+                // сроком закрытия пакета или повтора подключения
                 while (m_logQueue.isEmpty() && !m_stop.loadRelaxed()) {
-                    m_condition.wait(&m_mutex);
+                    shipper = m_shipper.get();
+                    const int timeout = shipper ? shipper->msUntilDue() : -1;
+                    if (timeout < 0) {
+                        m_condition.wait(&m_mutex);
+                    } else if (!m_condition.wait(&m_mutex, QDeadlineTimer(timeout))) {
+                        break;
+                    }
                 }
 
                 if (m_stop.loadRelaxed()) {
                     break;
                 }
 
-                message = m_logQueue.dequeue();
+                shipper = m_shipper.get();
+                if (!m_logQueue.isEmpty()) {
+                    message = m_logQueue.dequeue();
+                    m_metricQueueDepth.set(m_logQueue.size());
+                }
             }
 
-            if (m_logFile->isOpen() && m_logFile->size() >= m_maxFileSize) {
-                rotateLogFile();
+            if (!message.isNull()) {
+                writeMessage(message);
+                if (shipper) {
+                    shipper->append(message);
+                }
             }
 
-            if (m_logFile->isOpen()) {
-                QTextStream stream(m_logFile.get());
-                stream << message << Qt::endl;
-            } else {
-                qCritical() << __FUNCTION__
-                            << message;
-                emit ErrorOccured(message);
+            if (shipper) {
+                shipper->poll();
             }
         }
+
+        if (shipper) {
+            shipper->shutdown();
+        }
+    }
+
+    /**
+     * @brief Запись строки в файл лога
+     */
+    void writeMessage(const QString &message) {
+        Metrics::ScopedTimer writeTimer(m_metricWriteTime);
+
+        if (m_logFile->isOpen() && quint64(m_logFile->size()) >= m_maxFileSize.loadRelaxed()) {
+            rotateLogFile();
+        }
+
+        if (m_logFile->isOpen()) {
+            QTextStream stream(m_logFile.get());
+            stream << message << Qt::endl;
+        } else {
+            qCritical() << __FUNCTION__
+                        << message;
+            emit ErrorOccured(message);
+        }
     }
 
     /**
      * @brief Создание нового файла
      */
     void rotateLogFile() {
+        TRACE_SCOPE("AsyncLogger::rotateLogFile");
         FileHelper fhelp;
 
+        const QString closedFile = m_logFile->fileName();
         m_logFile->close();
-        m_logFile = fhelp.createFile(m_logFilePath);
+
+        // Замена под мьютексом: startArchiving() читает имя текущего файла
+        LogArchiver *archiver = nullptr;
+        {
+            QMutexLocker locker(&m_mutex);
+            m_logFile = fhelp.createFile(m_logFilePath);
+            archiver  = m_archiver.get();
+        }
+
+        // При совпадении секунды создания запись продолжается в тот же файл
+        if (archiver && m_logFile && m_logFile->fileName() != closedFile) {
+            archiver->enqueue(closedFile);
+        }
 
         if (m_logFile.get() == nullptr) {
             qCritical() << __FUNCTION__
@@ -334,6 +456,13 @@ private:
     QAtomicInteger<bool>   m_stop;            //!< Атомарный флаг остановки потока
     QFuture<void>          m_future;          //!< Для асинхронной работы
     LogLevel               m_currentLogLevel; //!< Текущий уровень логгирования
-    quint64                m_maxFileSize;     //!< Максимальный размер файла (в байтах)
+    QAtomicInteger<quint64> m_maxFileSize;    //!< Максимальный размер файла (в байтах)
+
+    std::unique_ptr<LogShipper>  m_shipper;   //!< Отправка сборщику, nullptr - выключена
+    std::unique_ptr<LogArchiver> m_archiver;  //!< Сжатие закрытых файлов, nullptr - выключено
+
+    Metrics::Counter      &m_metricMessages;   //!< Принято сообщений
+    Metrics::Gauge        &m_metricQueueDepth; //!< Глубина очереди
+    Metrics::Histogram    &m_metricWriteTime;  //!< Время записи строки
 };
 }
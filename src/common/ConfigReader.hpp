@@ -3,12 +3,17 @@
 #include <QObject>
 #include <QString>
 #include <QFile>
+#include <QSaveFile>
+#include <QMap>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QMutex>
 #include <QJsonParseError>
 
 #include "structures.hpp"
+#include "Tracer.hpp"
+#include "Metrics.hpp"
+#include "AllocTracker.hpp"
 
 /**
  * @brief Класс для чтения и сохранения конфигурационных настроек приложения
@@ -32,6 +37,11 @@ public:
      * @return true, если чтение прошло успешно, иначе false
      */
     bool readSettings(const QString &filePath) {
+        TRACE_SCOPE("ConfigReader::readSettings");
+        ALLOC_SCOPE(Config);
+        static auto &readTime = Metrics::Registry::instance()
+                                    .histogram("config_read_ns", "Config read time, ns");
+        Metrics::ScopedTimer timer(readTime);
         QMutexLocker locker(&mutex);
 
         QFile file(filePath);
@@ -71,13 +81,21 @@ public:
      * от параметра overwrite
      * @param filePath Путь к файлу настроек
      * @param overwrite Флаг, указывающий, нужно ли перезаписывать существующий файл (по умолчанию true)
+     * @param notify Отправить уведомление infoMessage об успешном сохранении
      * @return true, если сохранение прошло успешно, иначе false
+     * @details Файл заменяется атомарно (QSaveFile): при сбое питания
+     * на диске остаётся либо старая, либо новая версия целиком
      */
-    bool saveSettings(const QString &filePath, bool overwrite = true) {
+    bool saveSettings(const QString &filePath, bool overwrite = true, bool notify = true) {
+        TRACE_SCOPE("ConfigReader::saveSettings");
+        ALLOC_SCOPE(Config);
+        static auto &saveTime = Metrics::Registry::instance()
+                                    .histogram("config_save_ns", "Config save time, ns");
+        Metrics::ScopedTimer timer(saveTime);
         QMutexLocker locker(&mutex);
 
-        QFile file(filePath);
-        if (file.exists() && !overwrite) {
+        QSaveFile file(filePath);
+        if (QFile::exists(filePath) && !overwrite) {
             emit errorOccurred(QString("Settings file already exists \nand overwrite is disabled: %1").arg(filePath));
             return false;
         }
@@ -91,17 +109,22 @@ public:
 
         rootObject["appSettings"] = serializeAppSettings();
         rootObject["logicSettings"] = serializeLogicSettings();
+        rootObject["diagnosticsSettings"] = serializeDiagnosticsSettings();
+        if (threadSettings.enabled) {
+            rootObject["threadSettings"] = serializeThreadSettings();
+        }
+        rootObject["parameters"] = serializeParameters();
 
         QJsonDocument jsonDoc(rootObject);
 
-        if (file.write(jsonDoc.toJson()) == -1) {
+        if (file.write(jsonDoc.toJson()) == -1 || !file.commit()) {
             emit errorOccurred("Failed to write settings to file");
             return false;
         }
 
-        file.close();
-
-        emit infoMessage(QString("Config was saved"));
+        if (notify) {
+            emit infoMessage(QString("Config was saved"));
+        }
         return true;
     }
 
@@ -120,6 +143,41 @@ public:
         return logicSettings;
     }
 
+    /**
+     * @brief Получение текущих настроек диагностики
+     * @return Константная ссылка на структуру DiagnosticsSettings
+     */
+    const DiagnosticsSettings &getDiagnosticsSettings() const {
+        return diagnosticsSettings;
+    }
+
+    /**
+     * @brief Получение текущих настроек потоков
+     * @return Константная ссылка на структуру ThreadSettings
+     */
+    const ThreadSettings &getThreadSettings() const {
+        return threadSettings;
+    }
+
+    /**
+     * @brief Получение числовых параметров
+     * @return Копия словаря "имя параметра - значение"
+     */
+    QMap<QString, double> getParameters() const {
+        QMutexLocker locker(&mutex);
+        return parameters;
+    }
+
+    /**
+     * @brief Установка значения числового параметра
+     * @param key Имя параметра
+     * @param value Значение
+     */
+    void setParameter(const QString &key, double value) {
+        QMutexLocker locker(&mutex);
+        parameters.insert(key, value);
+    }
+
     /**
      * @brief Установка новых настроек приложения
      * Обновляет текущие настройки приложения новыми значениями
@@ -158,9 +216,25 @@ signals:
 private:
     AppSettings appSettings;       //!< Настройки приложения
     LogicSettings logicSettings;  //!< Логические настройки
+    DiagnosticsSettings diagnosticsSettings; //!< Настройки диагностики
+    ThreadSettings threadSettings;           //!< Настройки потоков по ролям
+    QMap<QString, double> parameters;         //!< Числовые параметры, изменяемые из GUI
 
     mutable QRecursiveMutex mutex; //!< Мьютекс для обеспечения потокобезопасности
 
+    /**
+     * @brief Вспомогательный метод для сериализации числовых параметров
+     * @return JSON-объект "имя параметра - значение"
+     */
+    QJsonObject serializeParameters() const {
+        QMutexLocker locker(&mutex);
+        QJsonObject parametersObject;
+        for (auto it = parameters.cbegin(); it != parameters.cend(); ++it) {
+            parametersObject[it.key()] = it.value();
+        }
+        return parametersObject;
+    }
+
     /**
      * @brief Вспомогательный метод для сериализации настроек приложения
      * Преобразует структуру AppSettings в JSON-объект
@@ -186,6 +260,60 @@ private:
         return logicSettingsObject;
     }
 
+    /**
+     * @brief Вспомогательный метод для сериализации настроек диагностики
+     * Преобразует структуру DiagnosticsSettings в JSON-объект
+     * @return JSON-объект, содержащий настройки диагностики
+     */
+    QJsonObject serializeDiagnosticsSettings() const {
+        QMutexLocker locker(&mutex);
+        QJsonObject diagnosticsObject;
+        diagnosticsObject["metricsPort"]         = diagnosticsSettings.metricsPort;
+        diagnosticsObject["metricsSocket"]       = diagnosticsSettings.metricsSocket;
+        diagnosticsObject["metricsSnapshotFile"] = diagnosticsSettings.metricsSnapshotFile;
+        diagnosticsObject["snapshotIntervalSec"] = diagnosticsSettings.snapshotIntervalSec;
+        diagnosticsObject["stallThresholdMs"]    = diagnosticsSettings.stallThresholdMs;
+        diagnosticsObject["liveChannel"]         = diagnosticsSettings.liveChannel;
+        diagnosticsObject["liveSlots"]           = diagnosticsSettings.liveSlots;
+        diagnosticsObject["logCollectorSocket"]  = diagnosticsSettings.logCollectorSocket;
+        diagnosticsObject["logSpoolDir"]         = diagnosticsSettings.logSpoolDir;
+        diagnosticsObject["logSpoolLimitMb"]     = diagnosticsSettings.logSpoolLimitMb;
+        diagnosticsObject["logBatchKb"]          = diagnosticsSettings.logBatchKb;
+        diagnosticsObject["logBatchIntervalMs"]  = diagnosticsSettings.logBatchIntervalMs;
+        diagnosticsObject["logRotateMb"]         = diagnosticsSettings.logRotateMb;
+        diagnosticsObject["logArchive"]          = diagnosticsSettings.logArchive;
+        diagnosticsObject["logArchiveBudgetMb"]  = diagnosticsSettings.logArchiveBudgetMb;
+        diagnosticsObject["allocBudgetsKb"]      = QJsonObject::fromVariantMap(diagnosticsSettings.allocBudgetsKb);
+        return diagnosticsObject;
+    }
+
+    /**
+     * @brief Вспомогательный метод для сериализации настроек потоков
+     * @return JSON-объект с настройками ролей
+     */
+    QJsonObject serializeThreadSettings() const {
+        QMutexLocker locker(&mutex);
+
+        auto role = [](const ThreadRoleSettings &settings) {
+            QJsonArray cpus;
+            for (int cpu : settings.cpus) {
+                cpus.append(cpu);
+            }
+            QJsonObject roleObject;
+            roleObject["cpus"]         = cpus;
+            roleObject["nice"]         = settings.nice;
+            roleObject["fifoPriority"] = settings.fifoPriority;
+            return roleObject;
+        };
+
+        QJsonObject threadsObject;
+        threadsObject["render"]      = role(threadSettings.render);
+        threadsObject["acquisition"] = role(threadSettings.acquisition);
+        threadsObject["logging"]     = role(threadSettings.logging);
+        threadsObject["background"]  = role(threadSettings.background);
+        return threadsObject;
+    }
+
     /**
      * @brief Вспомогательный метод для десериализации данных из JSON-объекта
      * Загружает данные из JSON-объекта в структуры AppSettings и LogicSettings
@@ -209,6 +337,16 @@ private:
             return false;
         }
 
+        // Необязательная секция: старые файлы настроек остаются валидными
+        diagnosticsSettings.loadFromJson(rootObject["diagnosticsSettings"].toObject());
+        threadSettings.loadFromJson(rootObject["threadSettings"].toObject());
+
+        parameters.clear();
+        const QJsonObject parametersObject = rootObject["parameters"].toObject();
+        for (auto it = parametersObject.begin(); it != parametersObject.end(); ++it) {
+            parameters.insert(it.key(), it.value().toDouble());
+        }
+
         return true;
     }
 };
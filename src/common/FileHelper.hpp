@@ -6,6 +6,8 @@
 #include <QDir>
 #include <QMutex>
 
+#include "Tracer.hpp"
+
 /**
  * @brief Класс-обёртка для создания файлов для логгера
  * @details Потокобезопасный класс для создания файлов
@@ -26,6 +28,7 @@ public:
      */
     std::unique_ptr<QFile> createFile(const QString &dirPath  = QString(),
                                       const QString &fileName = QString()) {
+        TRACE_SCOPE("FileHelper::createFile");
         QMutexLocker locker(&m_mutex);
 
         auto dir = createDir(dirPath);
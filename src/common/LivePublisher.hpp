@@ -0,0 +1,182 @@
+#pragma once
+
+#include <QObject>
+#include <QMutex>
+#include <QString>
+#include <QStringView>
+
+#include <cerrno>
+#include <cstring>
+
+#include "structures.hpp"
+#include "dsp/SampleBlock.hpp"
+
+#if defined(Q_OS_UNIX)
+#include "ShmRing.hpp"
+#endif
+
+/**
+ * @brief Публикация обработанных отсчётов в разделяемую память
+ * @details Обёртка над ShmRing::Writer: сторонние процессы (регистратор,
+ * инструменты отладки) читают поток отсчётов и состояние приложения
+ * без сокетов и сериализации, см. shm/ShmRing.hpp и QTemplateAppLiveReader.
+ * Читатели не влияют на писателя: медленный читатель теряет старые
+ * блоки, но не задерживает поток сбора данных.
+ *
+ * publish() вызывается из потока сбора данных (одного), методы состояния -
+ * из любого потока. На платформах без POSIX shared memory класс ничего не делает.
+ */
+class LivePublisher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LivePublisher(QObject *parent = nullptr)
+        : QObject(parent) {}
+
+    /**
+     * @brief Создание сегмента разделяемой памяти
+     * @param name Имя сегмента POSIX, например "/qtapp-live"
+     * @param slotCount Количество слотов кольца, округляется до степени двойки
+     * @return false, если сегмент создать не удалось
+     */
+    bool start(const QString &name, int slotCount) {
+#if defined(Q_OS_UNIX)
+        if (!m_writer.create(name.toStdString(), static_cast<std::uint32_t>(qMax(slotCount, 2)))) {
+            emit errorOccurred(QString("Live channel: failed to create %1: %2")
+                                   .arg(name, QString::fromLocal8Bit(std::strerror(errno))));
+            return false;
+        }
+        updateStatus(false);
+        return true;
+#else
+        Q_UNUSED(name)
+        Q_UNUSED(slotCount)
+        emit errorOccurred("Live channel is not supported on this platform");
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Включена ли публикация
+     */
+    bool isActive() const {
+#if defined(Q_OS_UNIX)
+        return m_writer.isOpen();
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Публикация блока отсчётов, каждый канал - отдельными слотами
+     * @param block Обработанный блок отсчётов
+     * @param t0 Время первого отсчёта, с
+     * @param dt Период дискретизации, с
+     */
+    void publish(const Dsp::SampleBlock &block, double t0, double dt) {
+#if defined(Q_OS_UNIX)
+        for (std::size_t ch = 0; ch < block.channels(); ++ch) {
+            m_writer.publish(static_cast<std::uint32_t>(ch), t0, dt, block.channel(ch), block.size());
+        }
+#else
+        Q_UNUSED(block)
+        Q_UNUSED(t0)
+        Q_UNUSED(dt)
+#endif
+    }
+
+    /**
+     * @brief Обновление блока состояния (пульс для читателей)
+     * @param debugMode Включён ли режим отладки
+     */
+    void updateStatus(bool debugMode) {
+#if defined(Q_OS_UNIX)
+        QMutexLocker locker(&m_mutex);
+        m_status.flags = debugMode ? ShmRing::STATUS_DEBUG_MODE : 0;
+        m_writer.setStatus(m_status);
+#else
+        Q_UNUSED(debugMode)
+#endif
+    }
+
+    /**
+     * @brief Последнее сообщение для пользователя в блоке состояния
+     */
+    void setLastMessage(const QString &message, MessageType type) {
+#if defined(Q_OS_UNIX)
+        if (!isActive()) {
+            return;
+        }
+        // Текст кодируется прямо в блок состояния, без промежуточного
+        // QByteArray: сообщения приходят пачками из любого потока
+        QMutexLocker locker(&m_mutex);
+        m_status.messageType = static_cast<std::int32_t>(type);
+        std::memset(m_status.message, 0, sizeof(m_status.message));
+        encodeUtf8(message, m_status.message, sizeof(m_status.message) - 1);
+        m_writer.setStatus(m_status);
+#else
+        Q_UNUSED(message)
+        Q_UNUSED(type)
+#endif
+    }
+
+signals:
+    /**
+     * @brief Сигнал об ошибке создания канала
+     * @param message Текст ошибки
+     */
+    void errorOccurred(const QString &message);
+
+private:
+    /**
+     * @brief Кодирование текста в UTF-8 в буфер фиксированного размера
+     * @param text Текст
+     * @param out Буфер
+     * @param capacity Размер буфера, байт
+     * @return Записано байт; символ, не помещающийся целиком, отбрасывается
+     * вместе с остатком текста
+     */
+    static std::size_t encodeUtf8(QStringView text, char *out, std::size_t capacity) {
+        std::size_t size = 0;
+        for (qsizetype i = 0; i < text.size(); ++i) {
+            char32_t code = text[i].unicode();
+            if (QChar::isHighSurrogate(code) && i + 1 < text.size() && text[i + 1].isLowSurrogate()) {
+                code = QChar::surrogateToUcs4(char16_t(code), text[++i].unicode());
+            } else if (QChar::isSurrogate(code)) {
+                code = QChar::ReplacementCharacter;
+            }
+
+            char bytes[4];
+            std::size_t length = 0;
+            if (code < 0x80) {
+                bytes[length++] = static_cast<char>(code);
+            } else if (code < 0x800) {
+                bytes[length++] = static_cast<char>(0xC0 | (code >> 6));
+                bytes[length++] = static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                bytes[length++] = static_cast<char>(0xE0 | (code >> 12));
+                bytes[length++] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                bytes[length++] = static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                bytes[length++] = static_cast<char>(0xF0 | (code >> 18));
+                bytes[length++] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                bytes[length++] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                bytes[length++] = static_cast<char>(0x80 | (code & 0x3F));
+            }
+
+            if (size + length > capacity) {
+                break;
+            }
+            std::memcpy(out + size, bytes, length);
+            size += length;
+        }
+        return size;
+    }
+
+#if defined(Q_OS_UNIX)
+    ShmRing::Writer m_writer; //!< Кольцо в разделяемой памяти
+    ShmRing::Status m_status; //!< Текущее состояние
+    QMutex          m_mutex;  //!< Состояние обновляется из разных потоков
+#endif
+};
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStringList>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <zlib.h>
+
+#if defined(Q_OS_LINUX)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Metrics.hpp"
+#include "ThreadTopology.hpp"
+#include "AllocTracker.hpp"
+
+namespace Logger {
+/**
+ * @brief Сжатие закрытых файлов лога и удаление старых архивов
+ * @details Работает в собственном потоке с приоритетом IdlePriority
+ * и, на Linux, классом ввода-вывода idle: сжатие не отнимает процессор
+ * и носитель у остальной работы. Поток записи логгера только ставит
+ * путь закрытого файла в очередь.
+ *
+ * Файл сжимается потоково, блоками по CHUNK_SIZE, в формат gzip
+ * (zcat, zless, zgrep), с атомарной заменой: сначала пишется и
+ * сбрасывается на носитель log_<время>.log.gz, затем удаляется
+ * исходный файл. Прерванное остановкой или сбоем сжатие повторяется
+ * при следующем запуске: при старте в очередь ставятся все оставшиеся
+ * log_*.log каталога, кроме текущего файла.
+ *
+ * После каждого сжатия самые старые архивы log_*.gz удаляются, пока
+ * их суммарный размер больше budgetBytes.
+ */
+class LogArchiver {
+public:
+    /**
+     * @brief Обработчик ошибок (для записи в лог)
+     */
+    using Notify = std::function<void(const QString &)>;
+
+    LogArchiver(const QString &logDir, qint64 budgetBytes, Notify notify)
+        : m_dir(logDir),
+          m_budgetBytes(budgetBytes),
+          m_notify(std::move(notify)),
+          m_metricArchived(Metrics::Registry::instance().counter(
+              "log_archived_total", "Rotated log files compressed")),
+          m_metricPruned(Metrics::Registry::instance().counter(
+              "log_archive_pruned_total", "Log archives deleted over the disk budget")),
+          m_metricArchiveBytes(Metrics::Registry::instance().gauge(
+              "log_archive_bytes", "Total size of compressed log archives, bytes")) {}
+
+    ~LogArchiver() { stop(); }
+
+    LogArchiver(const LogArchiver &) = delete;
+    LogArchiver &operator=(const LogArchiver &) = delete;
+
+    /**
+     * @brief Запуск потока и постановка в очередь оставшихся файлов
+     * @param activeFile Текущий файл лога, его сжимать нельзя
+     */
+    void start(const QString &activeFile) {
+        const QString active = QFileInfo(activeFile).absoluteFilePath();
+        {
+            QMutexLocker locker(&m_mutex);
+            for (const QFileInfo &info : m_dir.entryInfoList({ "log_*.log" }, QDir::Files, QDir::Name)) {
+                if (info.absoluteFilePath() != active) {
+                    m_queue << info.absoluteFilePath();
+                }
+            }
+        }
+
+        m_stop = false;
+        m_thread.reset(QThread::create([this]() { archiveLoop(); }));
+        m_thread->setObjectName("log-archiver");
+        m_thread->start(QThread::IdlePriority);
+    }
+
+    /**
+     * @brief Остановка потока
+     * @details Начатое сжатие прерывается, исходный файл остаётся
+     */
+    void stop() {
+        if (!m_thread) {
+            return;
+        }
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stop = true;
+        }
+        m_condition.wakeAll();
+        m_thread->wait();
+        m_thread.reset();
+    }
+
+    /**
+     * @brief Постановка закрытого файла лога в очередь на сжатие
+     */
+    void enqueue(const QString &filePath) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_queue << QFileInfo(filePath).absoluteFilePath();
+        }
+        m_condition.wakeOne();
+    }
+
+private:
+    static constexpr qint64 CHUNK_SIZE = 64 * 1024; //!< Буфер чтения и записи
+    static constexpr int    LEVEL      = 6;         //!< Уровень сжатия zlib
+
+    void archiveLoop() {
+        ThreadTopology::Scope topology(ThreadTopology::Background, "log-archiver");
+        ALLOC_THREAD_TAG(Logger);
+        setIdleIoPriority();
+        prune();
+
+        std::vector<char> input(CHUNK_SIZE);
+        std::vector<char> output(CHUNK_SIZE);
+
+        forever {
+            QString path;
+            {
+                QMutexLocker locker(&m_mutex);
+                while (m_queue.isEmpty() && !m_stop) {
+                    m_condition.wait(&m_mutex);
+                }
+                if (m_stop) {
+                    break;
+                }
+                path = m_queue.takeFirst();
+            }
+
+            if (compress(path, input, output)) {
+                m_metricArchived.add();
+                prune();
+            }
+        }
+    }
+
+    /**
+     * @brief Потоковое сжатие файла в gzip
+     * @return true, если архив записан и исходный файл удалён
+     */
+    bool compress(const QString &path, std::vector<char> &input, std::vector<char> &output) {
+        QFile source(path);
+        if (!source.exists()) {
+            return false;
+        }
+        if (!source.open(QIODevice::ReadOnly)) {
+            m_notify(QString("Log archiver: cannot open %1: %2").arg(path, source.errorString()));
+            return false;
+        }
+
+        QString target = path + ".gz";
+        for (int n = 1; QFile::exists(target); ++n) {
+            target = QString("%1.%2.gz").arg(path).arg(n);
+        }
+
+        QSaveFile archive(target);
+        if (!archive.open(QIODevice::WriteOnly)) {
+            m_notify(QString("Log archiver: cannot create %1: %2").arg(target, archive.errorString()));
+            return false;
+        }
+
+        z_stream stream{};
+        // 15 + 16: окно 32 КБ и обёртка gzip вместо zlib
+        if (deflateInit2(&stream, LEVEL, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            archive.cancelWriting();
+            return false;
+        }
+
+        bool ok = true;
+        int  flush = Z_NO_FLUSH;
+        while (ok && flush != Z_FINISH) {
+            if (m_stop) {
+                ok = false;
+                break;
+            }
+
+            const qint64 read = source.read(input.data(), CHUNK_SIZE);
+            if (read < 0) {
+                m_notify(QString("Log archiver: read error in %1: %2").arg(path, source.errorString()));
+                ok = false;
+                break;
+            }
+            flush = source.atEnd() ? Z_FINISH : Z_NO_FLUSH;
+
+            stream.next_in  = reinterpret_cast<Bytef *>(input.data());
+            stream.avail_in = static_cast<uInt>(read);
+            do {
+                stream.next_out  = reinterpret_cast<Bytef *>(output.data());
+                stream.avail_out = static_cast<uInt>(CHUNK_SIZE);
+                deflate(&stream, flush);
+
+                const qint64 produced = CHUNK_SIZE - stream.avail_out;
+                if (archive.write(output.data(), produced) != produced) {
+                    m_notify(QString("Log archiver: write error in %1: %2").arg(target, archive.errorString()));
+                    ok = false;
+                    break;
+                }
+            } while (stream.avail_out == 0);
+        }
+        deflateEnd(&stream);
+
+        if (!ok) {
+            archive.cancelWriting();
+            return false;
+        }
+
+        // commit() сбрасывает архив на носитель до переименования,
+        // поэтому исходный файл удаляется только после этого
+        if (!archive.commit()) {
+            m_notify(QString("Log archiver: cannot commit %1: %2").arg(target, archive.errorString()));
+            return false;
+        }
+        source.close();
+        source.remove();
+        return true;
+    }
+
+    /**
+     * @brief Удаление самых старых архивов сверх бюджета
+     * @details Имена начинаются со времени создания файла,
+     * поэтому порядок по имени - хронологический
+     */
+    void prune() {
+        const QFileInfoList archives = m_dir.entryInfoList({ "log_*.gz" }, QDir::Files, QDir::Name);
+
+        qint64 total = 0;
+        for (const QFileInfo &info : archives) {
+            total += info.size();
+        }
+
+        for (const QFileInfo &info : archives) {
+            if (m_budgetBytes <= 0 || total <= m_budgetBytes) {
+                break;
+            }
+            if (QFile::remove(info.absoluteFilePath())) {
+                total -= info.size();
+                m_metricPruned.add();
+            }
+        }
+        m_metricArchiveBytes.set(total);
+    }
+
+    /**
+     * @brief Класс ввода-вывода idle для текущего потока (Linux)
+     * @details Запросы потока обслуживаются, только когда
+     * носитель свободен от запросов остальных потоков
+     */
+    static void setIdleIoPriority() {
+#if defined(Q_OS_LINUX) && defined(SYS_ioprio_set)
+        constexpr int IOPRIO_CLASS_IDLE  = 3;
+        constexpr int IOPRIO_CLASS_SHIFT = 13;
+        constexpr int IOPRIO_WHO_PROCESS = 1;
+        ::syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT);
+#endif
+    }
+
+    QDir                     m_dir;          //!< Каталог логов
+    qint64                   m_budgetBytes;  //!< Предельный объём архивов, 0 - без удаления
+    Notify                   m_notify;
+
+    std::unique_ptr<QThread> m_thread;
+    QMutex                   m_mutex;
+    QWaitCondition           m_condition;
+    QStringList              m_queue;        //!< Файлы, ожидающие сжатия
+    std::atomic<bool>        m_stop { false };
+
+    Metrics::Counter        &m_metricArchived;
+    Metrics::Counter        &m_metricPruned;
+    Metrics::Gauge          &m_metricArchiveBytes;
+};
+}
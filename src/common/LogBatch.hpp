@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QByteArray>
+#include <QStringList>
+#include <QtEndian>
+
+#include <optional>
+
+/**
+ * @brief Формат пакета записей лога для отправки сборщику
+ * @details Общий для LogShipper (устройство) и сборщика
+ * QTemplateAppLogCollector. Пакет - заголовок HEADER_SIZE байт и
+ * сжатые (qCompress, zlib) строки лога, разделённые '\n'.
+ *
+ * Заголовок (порядок байт - little-endian):
+ *  - magic, 4 байта - MAGIC;
+ *  - source, 8 байт - идентификатор источника, случайный на каждый запуск;
+ *  - sequence, 8 байт - номер пакета источника, с 1 без пропусков;
+ *  - lines, 4 байта - количество строк;
+ *  - size, 4 байта - размер сжатых данных.
+ *
+ * На каждый принятый пакет сборщик отвечает ACK_SIZE байтами: source и
+ * sequence. Пара (source, sequence) однозначно определяет пакет, поэтому
+ * повторно отправленный после обрыва связи пакет сборщик отбрасывает.
+ */
+namespace LogBatch {
+
+    static constexpr quint32 MAGIC       = 0x31424c51; //!< "QLB1"
+    static constexpr int     HEADER_SIZE = 28;
+    static constexpr int     ACK_SIZE    = 16;
+    static constexpr quint32 MAX_PAYLOAD = 16 * 1024 * 1024; //!< Защита от мусора в потоке
+
+    /**
+     * @brief Заголовок пакета
+     */
+    struct Header {
+        quint64 source   = 0;
+        quint64 sequence = 0;
+        quint32 lines    = 0;
+        quint32 size     = 0;
+    };
+
+    /**
+     * @brief Сборка пакета
+     * @param lines Строки лога, уже объединённые через '\n'
+     * @param lineCount Количество строк
+     * @param level Уровень сжатия zlib, 1 - быстрейший
+     */
+    inline QByteArray encode(quint64 source, quint64 sequence,
+                             const QByteArray &lines, quint32 lineCount, int level) {
+        const QByteArray payload = qCompress(lines, level);
+
+        QByteArray frame(HEADER_SIZE, Qt::Uninitialized);
+        char *h = frame.data();
+        qToLittleEndian(MAGIC,                              h);
+        qToLittleEndian(source,                             h + 4);
+        qToLittleEndian(sequence,                           h + 12);
+        qToLittleEndian(lineCount,                          h + 20);
+        qToLittleEndian(static_cast<quint32>(payload.size()), h + 24);
+        frame.append(payload);
+        return frame;
+    }
+
+    /**
+     * @brief Разбор заголовка
+     * @return std::nullopt, если данные не являются заголовком пакета
+     */
+    inline std::optional<Header> decodeHeader(const char *data) {
+        if (qFromLittleEndian<quint32>(data) != MAGIC) {
+            return std::nullopt;
+        }
+
+        Header header;
+        header.source   = qFromLittleEndian<quint64>(data + 4);
+        header.sequence = qFromLittleEndian<quint64>(data + 12);
+        header.lines    = qFromLittleEndian<quint32>(data + 20);
+        header.size     = qFromLittleEndian<quint32>(data + 24);
+        if (header.size > MAX_PAYLOAD) {
+            return std::nullopt;
+        }
+        return header;
+    }
+
+    /**
+     * @brief Подтверждение приёма пакета
+     */
+    inline QByteArray encodeAck(quint64 source, quint64 sequence) {
+        QByteArray ack(ACK_SIZE, Qt::Uninitialized);
+        qToLittleEndian(source,   ack.data());
+        qToLittleEndian(sequence, ack.data() + 8);
+        return ack;
+    }
+
+    inline void decodeAck(const char *data, quint64 &source, quint64 &sequence) {
+        source   = qFromLittleEndian<quint64>(data);
+        sequence = qFromLittleEndian<quint64>(data + 8);
+    }
+}
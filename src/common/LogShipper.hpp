@@ -0,0 +1,462 @@
+#pragma once
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLocalSocket>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QStringList>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "LogBatch.hpp"
+#include "Metrics.hpp"
+
+namespace Logger {
+/**
+ * @brief Отправка записей лога сборщику пакетами
+ * @details Строки накапливаются в пакет до batchBytes байт или
+ * batchIntervalMs мс, пакет сжимается (zlib) и отправляется через
+ * Unix-сокет сборщику (формат - LogBatch.hpp). Пакет считается
+ * доставленным только после подтверждения сборщика.
+ *
+ * Поток записи подтверждения не ждёт: пакет пишется в сокет без
+ * блокировки и встаёт в список неподтверждённых (не больше
+ * MAX_IN_FLIGHT), а подтверждения разбираются в poll() по мере
+ * прихода. Нет подтверждения дольше ACK_TIMEOUT_MS - связь считается
+ * потерянной, неподтверждённые пакеты возвращаются в каталог.
+ *
+ * Пока сборщик недоступен, пакеты пишутся в каталог spoolDir, по
+ * файлу на пакет, с попытками переподключения с растущим интервалом
+ * (1..30 с). После восстановления связи сначала по порядку досылаются
+ * пакеты из каталога, в том числе оставшиеся от прошлых запусков.
+ * Пакет, отправленный, но не подтверждённый, досылается ещё раз:
+ * сборщик отбрасывает повтор по паре (source, sequence). При
+ * превышении spoolLimitBytes удаляются самые старые пакеты.
+ *
+ * Класс не потокобезопасный: все методы вызываются из потока записи
+ * AsyncLogger, сокет создаётся и удаляется в нём же.
+ */
+class LogShipper {
+public:
+    /**
+     * @brief Параметры отправки
+     */
+    struct Settings {
+        QString socketPath;                         //!< Unix-сокет сборщика
+        QString spoolDir         = "log-spool";     //!< Каталог неотправленных пакетов
+        qint64  spoolLimitBytes  = 16 * 1024 * 1024; //!< Предельный объём каталога
+        qint64  batchBytes       = 64 * 1024;       //!< Размер пакета до сжатия
+        int     batchIntervalMs  = 2000;            //!< Наибольшее время накопления пакета
+        int     compressionLevel = 1;               //!< Уровень zlib, 1 - быстрейший
+    };
+
+    /**
+     * @brief Обработчик смены состояния связи (для записи в лог)
+     */
+    using Notify = std::function<void(const QString &)>;
+
+    LogShipper(const Settings &settings, Notify notify)
+        : m_settings(settings),
+          m_notify(std::move(notify)),
+          m_source(QRandomGenerator::system()->generate64()),
+          m_metricBatches(Metrics::Registry::instance().counter(
+              "log_ship_batches_total", "Log batches sealed for shipping")),
+          m_metricSpooled(Metrics::Registry::instance().counter(
+              "log_ship_spooled_total", "Log batches written to the spool directory")),
+          m_metricDropped(Metrics::Registry::instance().counter(
+              "log_ship_dropped_total", "Log batches dropped: spool size limit or spool write failure")),
+          m_metricSpoolBytes(Metrics::Registry::instance().gauge(
+              "log_ship_spool_bytes", "Size of the log spool directory, bytes")),
+          m_metricBatchTime(Metrics::Registry::instance().histogram(
+              "log_ship_batch_ns", "Time to compress and ship one log batch, ns")) {
+        m_clock.start();
+        m_batch.reserve(m_settings.batchBytes + 1024);
+
+        // Пакеты, не отправленные в прошлых запусках
+        const QDir dir(m_settings.spoolDir);
+        for (const QFileInfo &info : dir.entryInfoList({ "*.qlb" }, QDir::Files, QDir::Name)) {
+            m_spool << info.fileName();
+            m_spoolBytes += info.size();
+        }
+        m_metricSpoolBytes.set(m_spoolBytes);
+    }
+
+    ~LogShipper() { shutdown(); }
+
+    LogShipper(const LogShipper &) = delete;
+    LogShipper &operator=(const LogShipper &) = delete;
+
+    /**
+     * @brief Добавление строки в текущий пакет
+     */
+    void append(const QString &line) {
+        if (m_lines == 0) {
+            m_batchTimer.start();
+        }
+        m_batch.append(line.toUtf8());
+        m_batch.append('\n');
+        ++m_lines;
+
+        if (m_batch.size() >= m_settings.batchBytes) {
+            seal();
+        }
+    }
+
+    /**
+     * @brief Время до следующего действия, мс
+     * @return -1, если ждать нечего: пакет пуст, каталог пуст и
+     * подтверждений не ждём
+     */
+    int msUntilDue() const {
+        qint64 due = -1;
+        auto earliest = [&due](qint64 value) {
+            value = qMax<qint64>(0, value);
+            due = (due < 0) ? value : qMin(due, value);
+        };
+
+        if (m_lines > 0) {
+            earliest(m_settings.batchIntervalMs - m_batchTimer.elapsed());
+        }
+        if (canDrain()) {
+            earliest(m_retryAtMs - m_clock.elapsed());
+        }
+        if (!m_inFlight.empty()) {
+            earliest(m_ackPollAtMs - m_clock.elapsed());
+        }
+        return static_cast<int>(due);
+    }
+
+    /**
+     * @brief Разбор подтверждений, отправка созревшего пакета и досылка из каталога
+     */
+    void poll() {
+        if (!m_inFlight.empty() && m_clock.elapsed() >= m_ackPollAtMs) {
+            pollAcks();
+        }
+        if (m_lines > 0 && m_batchTimer.elapsed() >= m_settings.batchIntervalMs) {
+            seal();
+        } else if (canDrain() && m_clock.elapsed() >= m_retryAtMs) {
+            drainSpool();
+        }
+    }
+
+    /**
+     * @brief Отправка остатка при остановке логгера
+     * @details Подтверждения ждутся не дольше ACK_TIMEOUT_MS;
+     * неподтверждённое остаётся в каталоге до следующего запуска
+     */
+    void shutdown() {
+        if (m_lines > 0) {
+            m_retryAtMs = 0;
+            seal();
+        }
+
+        QElapsedTimer wait;
+        wait.start();
+        while (!m_inFlight.empty() && wait.elapsed() < ACK_TIMEOUT_MS) {
+            pollAcks();
+            if (!m_inFlight.empty() && m_socket) {
+                m_socket->waitForReadyRead(ACK_POLL_MS);
+            }
+        }
+        returnInFlight();
+        m_socket.reset();
+    }
+
+private:
+    static constexpr int CONNECT_TIMEOUT_MS = 200;
+    static constexpr int ACK_TIMEOUT_MS     = 2000;
+    static constexpr int ACK_POLL_MS        = 20;   //!< Период проверки подтверждений
+    static constexpr int MAX_IN_FLIGHT      = 8;    //!< Неподтверждённых пакетов в сокете
+    static constexpr int MIN_BACKOFF_MS     = 1000;
+    static constexpr int MAX_BACKOFF_MS     = 30000;
+
+    /**
+     * @brief Пакет, отправленный и ещё не подтверждённый
+     */
+    struct InFlight {
+        quint64    source;
+        quint64    sequence;
+        QByteArray frame;     //!< Сам пакет, только для пакетов не из каталога
+        QString    spoolName; //!< Файл каталога, пусто для нового пакета
+        qint64     sealedMs;  //!< Время закрытия пакета, для имени файла в каталоге
+        qint64     sentMs;    //!< Время отправки по m_clock
+    };
+
+    /**
+     * @brief Закрытие текущего пакета: сжатие и отправка
+     */
+    void seal() {
+        Metrics::ScopedTimer timer(m_metricBatchTime);
+
+        const quint64 sequence = ++m_sequence;
+        const qint64  sealedMs = QDateTime::currentMSecsSinceEpoch();
+        const QByteArray frame = LogBatch::encode(m_source, sequence, m_batch, m_lines,
+                                                  m_settings.compressionLevel);
+        m_batch.clear();
+        m_lines = 0;
+        m_metricBatches.add();
+
+        // Пока в каталоге есть пакеты, новый встаёт за ними
+        if (m_spool.isEmpty() && send(frame, m_source, sequence, QString(), sealedMs)) {
+            return;
+        }
+        spool(frame, sequence, sealedMs);
+        drainSpool();
+    }
+
+    /**
+     * @brief Есть ли в каталоге что отправить и место среди неподтверждённых
+     */
+    bool canDrain() const {
+        return m_spoolSent < m_spool.size() && m_inFlight.size() < std::size_t(MAX_IN_FLIGHT);
+    }
+
+    /**
+     * @brief Запись пакета в сокет без ожидания подтверждения
+     * @param spoolName Файл каталога, из которого взят пакет, или пусто
+     * @return false, если связи нет или неподтверждённых пакетов уже MAX_IN_FLIGHT
+     */
+    bool send(const QByteArray &frame, quint64 source, quint64 sequence,
+              const QString &spoolName, qint64 sealedMs) {
+        if (m_inFlight.size() >= std::size_t(MAX_IN_FLIGHT) || !connectIfNeeded()) {
+            return false;
+        }
+
+        if (m_socket->write(frame) != frame.size()) {
+            connectionLost(m_socket->errorString());
+            return false;
+        }
+        // Без цикла событий данные уходят только по flush(): пишет,
+        // сколько примет сокет, остаток - при следующей проверке
+        m_socket->flush();
+
+        if (m_inFlight.empty()) {
+            m_ackPollAtMs = m_clock.elapsed() + ACK_POLL_MS;
+        }
+        m_inFlight.push_back({ source, sequence, spoolName.isEmpty() ? frame : QByteArray(),
+                               spoolName, sealedMs, m_clock.elapsed() });
+        return true;
+    }
+
+    /**
+     * @brief Разбор пришедших подтверждений без ожидания
+     * @details Подтверждения приходят в порядке отправки. Пакет из
+     * каталога удаляется из него только после подтверждения
+     */
+    void pollAcks() {
+        m_ackPollAtMs = m_clock.elapsed() + ACK_POLL_MS;
+        if (m_inFlight.empty() || !m_socket) {
+            return;
+        }
+
+        m_socket->flush();
+        if (m_socket->bytesAvailable() < LogBatch::ACK_SIZE) {
+            m_socket->waitForReadyRead(0);
+        }
+
+        while (!m_inFlight.empty() && m_socket->bytesAvailable() >= LogBatch::ACK_SIZE) {
+            char ack[LogBatch::ACK_SIZE];
+            m_socket->read(ack, LogBatch::ACK_SIZE);
+
+            quint64 ackSource = 0, ackSequence = 0;
+            LogBatch::decodeAck(ack, ackSource, ackSequence);
+            const InFlight &front = m_inFlight.front();
+            if (ackSource != front.source || ackSequence != front.sequence) {
+                connectionLost("unexpected acknowledgement");
+                return;
+            }
+
+            // Файл мог быть уже удалён при превышении объёма каталога
+            if (!front.spoolName.isEmpty() && !m_spool.isEmpty() && m_spool.first() == front.spoolName) {
+                removeSpooled(0);
+                --m_spoolSent;
+                m_metricSpoolBytes.set(m_spoolBytes);
+            }
+            m_inFlight.pop_front();
+        }
+
+        if (m_socket->state() != QLocalSocket::ConnectedState) {
+            connectionLost(m_socket->errorString());
+        } else if (!m_inFlight.empty() && m_clock.elapsed() - m_inFlight.front().sentMs > ACK_TIMEOUT_MS) {
+            connectionLost("no acknowledgement");
+        }
+    }
+
+    /**
+     * @brief Возврат неподтверждённых пакетов в каталог
+     * @details Новые пакеты записываются в каталог со временем закрытия
+     * и встают по порядку перед более поздними; пакеты из каталога
+     * и так в нём остались и будут отправлены повторно
+     */
+    void returnInFlight() {
+        bool added = false;
+        for (const InFlight &entry : m_inFlight) {
+            if (entry.spoolName.isEmpty()) {
+                spool(entry.frame, entry.sequence, entry.sealedMs);
+                added = true;
+            }
+        }
+        m_inFlight.clear();
+        m_spoolSent = 0;
+        if (added) {
+            std::sort(m_spool.begin(), m_spool.end());
+        }
+    }
+
+    bool connectIfNeeded() {
+        if (m_socket && m_socket->state() == QLocalSocket::ConnectedState) {
+            return true;
+        }
+        if (m_clock.elapsed() < m_retryAtMs) {
+            return false;
+        }
+
+        if (!m_socket) {
+            m_socket = std::make_unique<QLocalSocket>();
+        }
+        m_socket->abort();
+        m_socket->connectToServer(m_settings.socketPath);
+        if (!m_socket->waitForConnected(CONNECT_TIMEOUT_MS)) {
+            connectionLost(m_socket->errorString());
+            return false;
+        }
+
+        if (m_state != Up) {
+            m_notify(QString("Log collector %1 connected, %2 spooled batches to resend")
+                         .arg(m_settings.socketPath).arg(m_spool.size()));
+        }
+        m_state     = Up;
+        m_backoffMs = MIN_BACKOFF_MS;
+        return true;
+    }
+
+    void connectionLost(const QString &reason) {
+        if (m_state != Down) {
+            m_notify(QString("Log collector %1 unreachable (%2), spooling to %3")
+                         .arg(m_settings.socketPath, reason, m_settings.spoolDir));
+        }
+        m_state = Down;
+        if (m_socket) {
+            m_socket->abort();
+        }
+        m_retryAtMs = m_clock.elapsed() + m_backoffMs;
+        m_backoffMs = qMin(m_backoffMs * 2, MAX_BACKOFF_MS);
+        returnInFlight();
+    }
+
+    /**
+     * @brief Запись пакета в каталог
+     * @details Имя файла начинается со времени записи, поэтому
+     * сортировка по имени сохраняет порядок и между запусками
+     */
+    void spool(const QByteArray &frame, quint64 sequence, qint64 sealedMs) {
+        QDir dir(m_settings.spoolDir);
+        if (!dir.exists() && !dir.mkpath(".")) {
+            m_notify(QString("Failed to create log spool directory %1, batch dropped")
+                         .arg(m_settings.spoolDir));
+            m_metricDropped.add();
+            return;
+        }
+
+        const QString name = QString("%1-%2-%3.qlb")
+                                 .arg(sealedMs, 13, 10, QChar('0'))
+                                 .arg(m_source, 16, 16, QChar('0'))
+                                 .arg(sequence, 16, 16, QChar('0'));
+        QSaveFile file(dir.filePath(name));
+        if (!file.open(QIODevice::WriteOnly) || file.write(frame) != frame.size() || !file.commit()) {
+            m_notify(QString("Failed to spool log batch: %1").arg(file.errorString()));
+            m_metricDropped.add();
+            return;
+        }
+
+        m_spool << name;
+        m_spoolBytes += frame.size();
+        m_metricSpooled.add();
+
+        while (m_spoolBytes > m_settings.spoolLimitBytes && m_spool.size() > 1) {
+            removeSpooled(0);
+            m_spoolSent = qMax(0, m_spoolSent - 1);
+            m_metricDropped.add();
+        }
+        m_metricSpoolBytes.set(m_spoolBytes);
+    }
+
+    /**
+     * @brief Досылка пакетов из каталога по порядку
+     * @details Отправляются файлы, ещё не ждущие подтверждения,
+     * пока есть место в списке неподтверждённых
+     */
+    void drainSpool() {
+        const QDir dir(m_settings.spoolDir);
+        while (m_spoolSent < m_spool.size()) {
+            const QString name = m_spool.at(m_spoolSent);
+            QFile file(dir.filePath(name));
+            const QByteArray frame = file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+            file.close();
+
+            const std::optional<LogBatch::Header> header =
+                (frame.size() >= LogBatch::HEADER_SIZE) ? LogBatch::decodeHeader(frame.constData())
+                                                        : std::nullopt;
+            if (!header || frame.size() != LogBatch::HEADER_SIZE + qint64(header->size)) {
+                // Повреждённый файл не должен останавливать досылку
+                removeSpooled(m_spoolSent);
+                m_metricDropped.add();
+                continue;
+            }
+
+            if (!send(frame, header->source, header->sequence, name, 0)) {
+                break;
+            }
+            ++m_spoolSent;
+        }
+        m_metricSpoolBytes.set(m_spoolBytes);
+    }
+
+    void removeSpooled(qsizetype index) {
+        QFile file(QDir(m_settings.spoolDir).filePath(m_spool.takeAt(index)));
+        m_spoolBytes -= file.size();
+        file.remove();
+    }
+
+    enum State {
+        Unknown,
+        Up,
+        Down
+    };
+
+    Settings      m_settings;
+    Notify        m_notify;
+    const quint64 m_source;           //!< Идентификатор источника этого запуска
+    quint64       m_sequence = 0;     //!< Номер последнего пакета
+
+    QByteArray    m_batch;            //!< Текущий пакет, строки через '\n'
+    quint32       m_lines = 0;        //!< Строк в текущем пакете
+    QElapsedTimer m_batchTimer;       //!< Время с первой строки пакета
+
+    std::unique_ptr<QLocalSocket> m_socket;
+    State         m_state     = Unknown;
+    QElapsedTimer m_clock;
+    qint64        m_retryAtMs = 0;    //!< Время следующей попытки подключения по m_clock
+    int           m_backoffMs = MIN_BACKOFF_MS;
+
+    QStringList   m_spool;            //!< Файлы каталога по порядку отправки
+    int           m_spoolSent  = 0;   //!< Файлов в начале m_spool, ждущих подтверждения
+    qint64        m_spoolBytes = 0;
+
+    std::deque<InFlight> m_inFlight;  //!< Отправленные пакеты по порядку отправки
+    qint64        m_ackPollAtMs = 0;  //!< Время следующей проверки подтверждений по m_clock
+
+    Metrics::Counter   &m_metricBatches;
+    Metrics::Counter   &m_metricSpooled;
+    Metrics::Counter   &m_metricDropped;
+    Metrics::Gauge     &m_metricSpoolBytes;
+    Metrics::Histogram &m_metricBatchTime;
+};
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+#include <array>
+
+#include "AllocTracker.hpp"
+#include "Metrics.hpp"
+
+#if defined(QTAPP_ALLOC_TRACKING)
+
+/**
+ * @brief Бюджеты памяти подсистем по счётчикам AllocTracker
+ * @details check() вызывается периодически: обновляет метрики
+ * alloc_<подсистема>_live_bytes, alloc_<подсистема>_allocations и
+ * heap_in_use_bytes и возвращает предупреждения о подсистемах, которые
+ * держат больше бюджета. Повторное предупреждение о подсистеме - только
+ * после спада ниже RESET_RATIO бюджета.
+ */
+class MemoryBudget
+{
+public:
+    static constexpr double RESET_RATIO = 0.9; //!< Доля бюджета для снятия превышения
+
+    MemoryBudget() {
+        Metrics::Registry &registry = Metrics::Registry::instance();
+        for (int tag = 0; tag < AllocTracker::TagCount; ++tag) {
+            const QString name = AllocTracker::tagName(AllocTracker::Tag(tag));
+            m_metricLive[tag] = &registry.gauge(
+                QString("alloc_%1_live_bytes").arg(name),
+                QString("Bytes held by the %1 subsystem via operator new").arg(name));
+            m_metricAllocations[tag] = &registry.gauge(
+                QString("alloc_%1_allocations").arg(name),
+                QString("operator new calls by the %1 subsystem").arg(name));
+        }
+        m_metricHeap = &registry.gauge("heap_in_use_bytes", "malloc heap in use, bytes");
+    }
+
+    /**
+     * @brief Бюджеты из DiagnosticsSettings::allocBudgetsKb
+     * @param budgetsKb Имя подсистемы (AllocTracker::tagName) -> КБ, 0 - без бюджета
+     * @return Имена, не совпавшие ни с одной подсистемой
+     */
+    QStringList setBudgets(const QVariantMap &budgetsKb) {
+        QStringList unknown = budgetsKb.keys();
+        for (int tag = 0; tag < AllocTracker::TagCount; ++tag) {
+            const QString name = AllocTracker::tagName(AllocTracker::Tag(tag));
+            m_budgets[tag] = budgetsKb.value(name).toLongLong() * 1024;
+            unknown.removeAll(name);
+        }
+        return unknown;
+    }
+
+    /**
+     * @brief Обновление метрик и проверка бюджетов
+     * @return Предупреждения о новых превышениях
+     */
+    QStringList check() {
+        QStringList warnings;
+        for (int tag = 0; tag < AllocTracker::TagCount; ++tag) {
+            const AllocTracker::TagStats stats = AllocTracker::stats(AllocTracker::Tag(tag));
+            m_metricLive[tag]->set(stats.liveBytes);
+            m_metricAllocations[tag]->set(static_cast<qint64>(stats.allocations));
+
+            const qint64 budget = m_budgets[tag];
+            if (budget <= 0) {
+                continue;
+            }
+            if (!m_exceeded[tag] && stats.liveBytes > budget) {
+                m_exceeded[tag] = true;
+                warnings << QString("Memory budget exceeded: %1 holds %2 kB, budget %3 kB")
+                                .arg(AllocTracker::tagName(AllocTracker::Tag(tag)))
+                                .arg(stats.liveBytes / 1024)
+                                .arg(budget / 1024);
+            } else if (m_exceeded[tag] && stats.liveBytes < budget * RESET_RATIO) {
+                m_exceeded[tag] = false;
+            }
+        }
+        m_metricHeap->set(static_cast<qint64>(AllocTracker::heap().inUse));
+        return warnings;
+    }
+
+    /**
+     * @brief Сводка по подсистемам и куче, по строке на подсистему
+     */
+    static QStringList report() {
+        QStringList lines;
+        for (int tag = 0; tag < AllocTracker::TagCount; ++tag) {
+            const AllocTracker::TagStats stats = AllocTracker::stats(AllocTracker::Tag(tag));
+            lines << QString("%1: %2 allocations, %3 kB live, %4 kB total")
+                         .arg(AllocTracker::tagName(AllocTracker::Tag(tag)))
+                         .arg(stats.allocations)
+                         .arg(stats.liveBytes / 1024)
+                         .arg(stats.bytes / 1024);
+        }
+        const AllocTracker::HeapStats heap = AllocTracker::heap();
+        lines << QString("heap: %1 kB in use (%2 kB mmap), %3 kB free")
+                     .arg(heap.inUse / 1024)
+                     .arg(heap.mapped / 1024)
+                     .arg(heap.free / 1024);
+        return lines;
+    }
+
+private:
+    std::array<qint64, AllocTracker::TagCount>            m_budgets {};  //!< Бюджеты, байт
+    std::array<bool, AllocTracker::TagCount>              m_exceeded {}; //!< Превышение уже сообщено
+    std::array<Metrics::Gauge *, AllocTracker::TagCount>  m_metricLive {};
+    std::array<Metrics::Gauge *, AllocTracker::TagCount>  m_metricAllocations {};
+    Metrics::Gauge                                       *m_metricHeap = nullptr;
+};
+
+#endif
@@ -1,23 +1,41 @@
 #pragma once
 
-#include <QObject>
-#include <QQueue>
+#include <QAbstractListModel>
+#include <QHash>
 #include <QMutex>
 #include <QThread>
-#include <QtConcurrent>
-#include <QWaitCondition>
+#include <QTimer>
+
+#include <array>
+#include <atomic>
 
 #include "structures.hpp"
+#include "Tracer.hpp"
+#include "Metrics.hpp"
+#include "AllocTracker.hpp"
 
 
 using namespace Logic;
 
 /**
  * @brief Обработка сообщений для их отображения в QML
+ * @details Сообщения хранятся в SLOT_COUNT переиспользуемых слотах,
+ * тексты интернируются в таблице на TEXT_COUNT строк: повторный текст
+ * не копируется, слот ссылается на строку таблицы. Подряд идущие
+ * одинаковые сообщения сливаются в один слот со счётчиком повторов.
+ * Поэтому пачка повторяющихся сообщений не выделяет память: сообщение
+ * с новым текстом добавляет строку в таблицу, сообщение при заполненных
+ * слотах отбрасывается (messages_dropped_total).
+ *
+ * В QML сообщения попадают как модель списка (роли text, type, repeat):
+ * send*() вызываются из любого потока, новые слоты переносятся в модель
+ * в потоке GUI не чаще раза в SYNC_INTERVAL. Слот освобождается, когда
+ * пользователь закрывает сообщение (dismiss, dismissAll).
  */
-class MessagesHandler : public QObject
+class MessagesHandler : public QAbstractListModel
 {
     Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
 
 public:
     /**
@@ -31,50 +49,81 @@ public:
     };
     Q_ENUM(MsgLevel)
 
-    explicit MessagesHandler(QObject *parent = nullptr)
-        : QObject(parent),
-        m_stop(false),
-        m_currentMsgLvl(Error) {
+    /**
+     * @brief Роли модели
+     */
+    enum Roles {
+        TextRole = Qt::UserRole + 1, //!< Текст сообщения
+        TypeRole,                    //!< Logic::MessageType
+        RepeatRole                   //!< Сколько раз сообщение пришло подряд
+    };
 
-        this->moveToThread(&m_workerThread);
+    static constexpr int SLOT_COUNT    = 32;  //!< Слотов сообщений
+    static constexpr int TEXT_COUNT    = 128; //!< Строк в таблице интернированных текстов
+    static constexpr int SYNC_INTERVAL = 50;  //!< Период переноса новых сообщений в модель, мс
 
-        connect(&m_workerThread, &QThread::started, this, [this](){
-            m_future = QtConcurrent::run([this]() {
-                this->processMessages();
-            });
-        });
+    explicit MessagesHandler(QObject *parent = nullptr)
+        : QAbstractListModel(parent),
+        m_currentMsgLvl(Error),
+        m_metricMessages(Metrics::Registry::instance().counter(
+            "messages_total", "Messages sent to the GUI")),
+        m_metricDropped(Metrics::Registry::instance().counter(
+            "messages_dropped_total", "Messages dropped with all slots busy")),
+        m_metricQueueDepth(Metrics::Registry::instance().gauge(
+            "messages_queue_depth", "Messages waiting for dispatch or dismissal")),
+        m_metricDispatch(Metrics::Registry::instance().histogram(
+            "messages_dispatch_ns", "Time from enqueue to dispatch to the GUI, ns")) {
+        TRACE_SCOPE("MessagesHandler::MessagesHandler");
 
-        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [&](){
-            this->~MessagesHandler();
-        });
+        m_textIndex.reserve(TEXT_COUNT);
+        for (int slot = 0; slot < SLOT_COUNT; ++slot) {
+            m_free[slot] = static_cast<quint8>(SLOT_COUNT - 1 - slot);
+        }
+        m_freeCount = SLOT_COUNT;
 
-        m_workerThread.start();
+        // Таймер запускается первым сообщением и останавливается
+        // переносом, которому нечего переносить
+        m_syncTimer.setInterval(SYNC_INTERVAL);
+        connect(&m_syncTimer, &QTimer::timeout, this, &MessagesHandler::sync);
     }
 
-    ~MessagesHandler()
-    {
-        {
-            QMutexLocker locker(&m_mutex);
-            m_stop.storeRelaxed(true);
-            m_condition.wakeAll();
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override {
+        if (parent.isValid()) {
+            return 0;
+        }
+        QMutexLocker locker(&m_mutex);
+        return m_rows;
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override {
+        QMutexLocker locker(&m_mutex);
+        if (!index.isValid() || index.row() >= m_rows) {
+            return QVariant();
         }
 
-        m_workerThread.quit();
-        m_workerThread.wait();
+        const Slot &slot = m_slots[slotAt(index.row())];
+        switch (role) {
+        case TextRole:   return m_texts[slot.text];
+        case TypeRole:   return static_cast<int>(slot.type);
+        case RepeatRole: return slot.repeat;
+        default:         return QVariant();
+        }
+    }
+
+    QHash<int, QByteArray> roleNames() const override {
+        return {
+            { TextRole,   "text"   },
+            { TypeRole,   "type"   },
+            { RepeatRole, "repeat" },
+        };
     }
 
-public slots:
     /**
-     * @brief  Явный метод для остановки обработки сообщений
+     * @brief Количество сообщений в модели
      */
-    void stopProcessing() {
-        {
-            QMutexLocker locker(&m_mutex);
-            m_stop.storeRelaxed(true);
-        }
-        m_condition.wakeAll();
-        m_future.waitForFinished();
-    }
+    int count() const { return rowCount(); }
+
+public slots:
     /**
      * @brief Метод для установки минимального уровня сообщения
      * @param level Уровень сообщения
@@ -90,8 +139,7 @@ public slots:
      * @param message сообщение об ошибке
      */
     void sendError(const QString &message) {
-        QmlDialogMessage dialogMessage { message, MessageType::Error };
-        enqueueMessage(dialogMessage);
+        post(message, MessageType::Error);
     }
 
     /**
@@ -99,8 +147,7 @@ public slots:
      * @param message сообщение предупреждения
      */
     void sendWarning(const QString &message) {
-        QmlDialogMessage dialogMessage { message, MessageType::Warning };
-        enqueueMessage(dialogMessage);
+        post(message, MessageType::Warning);
     }
 
     /**
@@ -108,59 +155,268 @@ public slots:
      * @param message информационное сообщение
      */
     void sendInfo(const QString &message) {
-        QmlDialogMessage dialogMessage { message, MessageType::Info };
-        enqueueMessage(dialogMessage);
+        post(message, MessageType::Info);
+    }
+
+    /**
+     * @brief Закрытие сообщения пользователем, слот освобождается
+     * @param row Строка модели
+     */
+    void dismiss(int row) {
+        if (row < 0 || row >= count()) {
+            return;
+        }
+
+        beginRemoveRows(QModelIndex(), row, row);
+        {
+            QMutexLocker locker(&m_mutex);
+            release(slotAt(row));
+            for (int i = row; i > 0; --i) {
+                m_order[(m_head + i) % SLOT_COUNT] = m_order[(m_head + i - 1) % SLOT_COUNT];
+            }
+            m_head = (m_head + 1) % SLOT_COUNT;
+            --m_size;
+            --m_rows;
+            if (m_repeatRow == row) {
+                m_repeatRow = -1;
+            } else if (m_repeatRow > row) {
+                --m_repeatRow;
+            }
+            m_metricQueueDepth.set(m_size);
+        }
+        endRemoveRows();
+        emit countChanged();
+    }
+
+    /**
+     * @brief Закрытие всех показанных сообщений
+     */
+    void dismissAll() {
+        const int rows = count();
+        if (rows == 0) {
+            return;
+        }
+
+        beginRemoveRows(QModelIndex(), 0, rows - 1);
+        {
+            QMutexLocker locker(&m_mutex);
+            for (int row = 0; row < rows; ++row) {
+                release(slotAt(row));
+            }
+            m_head = (m_head + rows) % SLOT_COUNT;
+            m_size -= rows;
+            m_rows = 0;
+            m_repeatRow = -1;
+            m_metricQueueDepth.set(m_size);
+        }
+        endRemoveRows();
+        emit countChanged();
     }
 
 signals:
+    void countChanged();
+
     /**
-     * @brief Сигнал для передачи сообщения в QML
-     * @param message сообщение для отображения в диалоговом окне
+     * @brief Сообщение принято
+     * @details Испускается в потоке отправителя; для подключения без
+     * копирования нужен Qt::DirectConnection
      */
-    void messageReceived(const QmlDialogMessage &message);
+    void messagePosted(const QString &text, Logic::MessageType type);
 
 private:
     /**
-     * @brief Слот для обработки сообщений
+     * @brief Слот сообщения
      */
-    void processMessages() {
-        forever {
-            QmlDialogMessage message;
+    struct Slot {
+        int         text       = -1;                //!< Строка таблицы текстов
+        MessageType type       = MessageType::Info;
+        int         repeat     = 0;                 //!< Повторов подряд
+        qint64      enqueuedNs = 0;                 //!< Время последнего повтора
+    };
 
-            {
-                QMutexLocker locker(&m_mutex);
+    /**
+     * @brief Постановка сообщения в слот
+     */
+    void post(const QString &message, MessageType type) {
+        ALLOC_SCOPE(Messages);
+        {
+            QMutexLocker locker(&m_mutex);
+            m_metricMessages.add();
 
-                while (m_logQueue.isEmpty() && !m_stop.loadRelaxed()) {
-                    m_condition.wait(&m_mutex);
+            // Повтор последнего сообщения только увеличивает счётчик
+            if (m_size > 0) {
+                const int position = m_size - 1;
+                Slot &last = m_slots[slotAt(position)];
+                if (last.type == type && m_texts[last.text] == message) {
+                    ++last.repeat;
+                    last.enqueuedNs = Metrics::nowNs();
+                    if (position < m_rows) {
+                        m_repeatRow = position;
+                    }
+                    m_dirty.store(true);
+                    wake();
+                    return;
                 }
+            }
 
-                if (m_stop.loadRelaxed()) {
-                    break;
-                }
+            const int text = m_freeCount > 0 ? intern(message) : -1;
+            if (text < 0) {
+                m_metricDropped.add();
+                return;
+            }
 
-                message = m_logQueue.dequeue();
+            const int slot = m_free[--m_freeCount];
+            m_slots[slot] = Slot{ text, type, 1, Metrics::nowNs() };
+            ++m_textRefs[text];
+            m_order[(m_head + m_size) % SLOT_COUNT] = static_cast<quint8>(slot);
+            ++m_size;
+            m_metricQueueDepth.set(m_size);
+        }
+
+        m_dirty.store(true);
+        wake();
+        emit messagePosted(message, type);
+    }
+
+    /**
+     * @brief Перенос новых слотов и повторов в модель (поток GUI)
+     */
+    void sync() {
+        if (!m_dirty.exchange(false)) {
+            m_armed.store(false);
+            m_syncTimer.stop();
+            if (m_dirty.load() && !m_armed.exchange(true)) {
+                m_syncTimer.start();
             }
+            return;
+        }
+        ALLOC_SCOPE(Messages);
 
-            emit messageReceived(message);
+        int first = 0;
+        int last  = 0;
+        int repeatRow = -1;
+        {
+            QMutexLocker locker(&m_mutex);
+            first = m_rows;
+            last  = m_size - 1;
+            repeatRow = m_repeatRow;
+            m_repeatRow = -1;
+        }
+
+        if (repeatRow >= 0) {
+            const QModelIndex changed = index(repeatRow);
+            emit dataChanged(changed, changed, { RepeatRole });
+        }
+
+        if (last < first) {
+            return;
+        }
+
+        beginInsertRows(QModelIndex(), first, last);
+        {
+            QMutexLocker locker(&m_mutex);
+            const qint64 now = Metrics::nowNs();
+            for (int row = first; row <= last; ++row) {
+                m_metricDispatch.record(static_cast<quint64>(now - m_slots[slotAt(row)].enqueuedNs));
+            }
+            m_rows = last + 1;
+        }
+        endInsertRows();
+        emit countChanged();
+    }
+
+    /**
+     * @brief Запуск таймера переноса, если он стоит
+     * @details Из чужого потока - через очередь событий потока GUI,
+     * одно событие на пробуждение, а не на сообщение
+     */
+    void wake() {
+        if (m_armed.exchange(true)) {
+            return;
+        }
+        if (QThread::currentThread() == thread()) {
+            m_syncTimer.start();
+        } else {
+            QMetaObject::invokeMethod(&m_syncTimer, [this]() { m_syncTimer.start(); },
+                                      Qt::QueuedConnection);
         }
     }
 
-private:
     /**
-     * @brief Метод добавления сообщения в очередь
-     * @param message сообщение, добавляемое в очередь
+     * @brief Строка таблицы для текста
+     * @details Известный текст находится поиском в хеше, новый
+     * занимает свободную строку или строку, на которую не ссылается
+     * ни один слот
+     * @return -1, если все строки заняты
      */
-    void enqueueMessage(const QmlDialogMessage &message) {
-        m_logQueue.enqueue(message);
-        m_condition.wakeOne();
+    int intern(const QString &message) {
+        const auto found = m_textIndex.constFind(message);
+        if (found != m_textIndex.constEnd()) {
+            return found.value();
+        }
+
+        int text = -1;
+        if (m_textCount < TEXT_COUNT) {
+            text = m_textCount++;
+        } else {
+            for (int i = 0; i < TEXT_COUNT; ++i) {
+                const int candidate = (m_evictNext + i) % TEXT_COUNT;
+                if (m_textRefs[candidate] == 0) {
+                    text = candidate;
+                    m_evictNext = (candidate + 1) % TEXT_COUNT;
+                    break;
+                }
+            }
+            if (text < 0) {
+                return -1;
+            }
+            m_textIndex.remove(m_texts[text]);
+        }
+
+        m_texts[text] = message;
+        m_textIndex.insert(message, text);
+        return text;
     }
 
-    QThread                  m_workerThread;  //!< Поток для обработки сообщений
-    QQueue<QmlDialogMessage> m_logQueue;      //!< Очередь сообщений
-    QMutex                   m_mutex;         //!< Мьютекс для синхронизации доступа к очереди
-    QWaitCondition           m_condition;     //!< Условная переменная для ожидания новых сообщений
-    QAtomicInteger<bool>     m_stop;          //!< Флаг для остановки обработки
-    MsgLevel                 m_currentMsgLvl; //!< Текущий уровень логгирования
-    QFuture<void>            m_future;        //!< Для асинхронной работы
-};
+    /**
+     * @brief Возврат слота в свободные, вызывается под m_mutex
+     */
+    void release(int slot) {
+        --m_textRefs[m_slots[slot].text];
+        m_free[m_freeCount++] = static_cast<quint8>(slot);
+    }
+
+    /**
+     * @brief Слот сообщения в позиции очереди
+     */
+    int slotAt(int position) const {
+        return m_order[(m_head + position) % SLOT_COUNT];
+    }
+
+    mutable QMutex                     m_mutex;        //!< Защищает слоты, очередь и таблицу текстов
+    MsgLevel                           m_currentMsgLvl; //!< Текущий уровень логгирования
+
+    std::array<Slot, SLOT_COUNT>       m_slots;
+    std::array<quint8, SLOT_COUNT>     m_free;          //!< Стек свободных слотов
+    int                                m_freeCount = 0;
+    std::array<quint8, SLOT_COUNT>     m_order;         //!< Кольцо занятых слотов по времени
+    int                                m_head = 0;      //!< Начало кольца
+    int                                m_size = 0;      //!< Занятых слотов
+    int                                m_rows = 0;      //!< Из них перенесено в модель
+    int                                m_repeatRow = -1; //!< Строка модели с новым повтором
 
+    std::array<QString, TEXT_COUNT>    m_texts;         //!< Интернированные тексты
+    std::array<int, TEXT_COUNT>        m_textRefs {};   //!< Слотов, ссылающихся на строку
+    QHash<QString, int>                m_textIndex;     //!< Текст -> строка таблицы
+    int                                m_textCount = 0;
+    int                                m_evictNext = 0; //!< Начало поиска строки для замены
+
+    std::atomic<bool>                  m_dirty { false }; //!< Есть изменения для модели
+    std::atomic<bool>                  m_armed { false }; //!< Таймер переноса запущен или запускается
+    QTimer                             m_syncTimer;     //!< Таймер переноса в модель
+
+    Metrics::Counter                  &m_metricMessages;   //!< Отправлено сообщений
+    Metrics::Counter                  &m_metricDropped;    //!< Отброшено сообщений
+    Metrics::Gauge                    &m_metricQueueDepth; //!< Занято слотов
+    Metrics::Histogram                &m_metricDispatch;   //!< Задержка доставки
+};
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QList>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Метрики времени выполнения: счётчики, показатели и гистограммы
+ * @details Запись метрики не берёт блокировок и не аллоцирует:
+ *  - счётчик разбит на шарды по потокам (поток получает свой шард при
+ *    первой записи), шарды выровнены по кэш-линии, поэтому потоки
+ *    не толкаются за одну линию;
+ *  - показатель (gauge) - одно атомарное значение;
+ *  - гистограмма в стиле HDR: логарифмически-линейные корзины,
+ *    16 корзин на каждую степень двойки (относительная погрешность
+ *    не более 6.25%), тоже по шардам.
+ * Метрики создаются через Registry один раз, ссылку на них удобно
+ * хранить в статической переменной рядом с местом записи:
+ * @code
+ * static auto &saves = Metrics::Registry::instance()
+ *                          .histogram("config_save_ns", "Config save time, ns");
+ * Metrics::ScopedTimer timer(saves);
+ * @endcode
+ */
+namespace Metrics {
+
+    static constexpr std::size_t SHARDS = 8; //!< Количество шардов на метрику
+
+    /**
+     * @brief Монотонное время, нс
+     */
+    inline qint64 nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Номер шарда текущего потока
+     */
+    inline std::size_t shardIndex() {
+        static std::atomic<std::size_t> next{0};
+        thread_local const std::size_t index = next.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+        return index;
+    }
+
+    /**
+     * @brief Монотонно растущий счётчик
+     */
+    class Counter {
+    public:
+        void add(quint64 n = 1) {
+            m_shards[shardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        quint64 value() const {
+            quint64 sum = 0;
+            for (const auto &shard : m_shards) {
+                sum += shard.value.load(std::memory_order_relaxed);
+            }
+            return sum;
+        }
+
+    private:
+        struct alignas(64) Shard {
+            std::atomic<quint64> value{0};
+        };
+        std::array<Shard, SHARDS> m_shards;
+    };
+
+    /**
+     * @brief Мгновенное значение (глубина очереди, размер и т.п.)
+     */
+    class Gauge {
+    public:
+        void set(qint64 value) { m_value.store(value, std::memory_order_relaxed); }
+        void add(qint64 delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+        qint64 value() const   { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        alignas(64) std::atomic<qint64> m_value{0};
+    };
+
+    /**
+     * @brief Гистограмма задержек с логарифмически-линейными корзинами
+     * @details Значения - целые неотрицательные (обычно наносекунды),
+     * значения от 2^40 (~18 минут в нс) попадают в последнюю корзину
+     */
+    class Histogram {
+    public:
+        static constexpr int         SUB_BITS    = 4;
+        static constexpr quint64     SUB_COUNT   = quint64(1) << SUB_BITS;
+        static constexpr int         MAX_BITS    = 40;
+        static constexpr std::size_t BUCKETS     = SUB_COUNT + (MAX_BITS - SUB_BITS) * SUB_COUNT;
+
+        /**
+         * @brief Снимок гистограммы, объединённый по шардам
+         */
+        struct Snapshot {
+            std::array<quint64, BUCKETS> counts{};
+            quint64 count = 0;
+            quint64 sum   = 0;
+            quint64 max   = 0;
+
+            /**
+             * @brief Значение квантиля
+             * @param q Квантиль, 0..1
+             * @return Верхняя граница корзины, в которую попал квантиль
+             */
+            quint64 quantile(double q) const {
+                if (count == 0) {
+                    return 0;
+                }
+                const quint64 rank = static_cast<quint64>(q * static_cast<double>(count - 1)) + 1;
+                quint64 seen = 0;
+                for (std::size_t i = 0; i < BUCKETS; ++i) {
+                    seen += counts[i];
+                    if (seen >= rank) {
+                        return std::min(upperBound(i), max);
+                    }
+                }
+                return max;
+            }
+
+            double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+
+            /**
+             * @brief Значения, записанные после снимка previous
+             * @details Максимум за окно неизвестен и оценивается
+             * верхней границей старшей непустой корзины
+             */
+            Snapshot since(const Snapshot &previous) const {
+                Snapshot window;
+                for (std::size_t i = 0; i < BUCKETS; ++i) {
+                    window.counts[i] = counts[i] - previous.counts[i];
+                    if (window.counts[i] != 0) {
+                        window.max = std::min(upperBound(i), max);
+                    }
+                }
+                window.count = count - previous.count;
+                window.sum   = sum - previous.sum;
+                return window;
+            }
+        };
+
+        void record(quint64 value) {
+            Shard &shard = m_shards[shardIndex()];
+            shard.counts[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            shard.count.fetch_add(1, std::memory_order_relaxed);
+            shard.sum.fetch_add(value, std::memory_order_relaxed);
+
+            quint64 current = shard.max.load(std::memory_order_relaxed);
+            while (value > current &&
+                   !shard.max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+            }
+        }
+
+        Snapshot snapshot() const {
+            Snapshot snap;
+            for (const auto &shard : m_shards) {
+                for (std::size_t i = 0; i < BUCKETS; ++i) {
+                    snap.counts[i] += shard.counts[i].load(std::memory_order_relaxed);
+                }
+                snap.count += shard.count.load(std::memory_order_relaxed);
+                snap.sum   += shard.sum.load(std::memory_order_relaxed);
+                snap.max    = std::max(snap.max, shard.max.load(std::memory_order_relaxed));
+            }
+            return snap;
+        }
+
+        /**
+         * @brief Номер корзины для значения
+         */
+        static std::size_t bucketIndex(quint64 value) {
+            if (value < SUB_COUNT) {
+                return static_cast<std::size_t>(value);
+            }
+            const int msb = 63 - std::countl_zero(value);
+            if (msb >= MAX_BITS) {
+                return BUCKETS - 1;
+            }
+            const int shift = msb - SUB_BITS;
+            const quint64 sub = (value >> shift) - SUB_COUNT;
+            return static_cast<std::size_t>(SUB_COUNT + shift * SUB_COUNT + sub);
+        }
+
+        /**
+         * @brief Наибольшее значение, попадающее в корзину
+         */
+        static quint64 upperBound(std::size_t index) {
+            if (index < SUB_COUNT) {
+                return index;
+            }
+            const quint64 shift = (index - SUB_COUNT) / SUB_COUNT;
+            const quint64 sub   = (index - SUB_COUNT) % SUB_COUNT;
+            return ((SUB_COUNT + sub + 1) << shift) - 1;
+        }
+
+    private:
+        struct alignas(64) Shard {
+            std::array<std::atomic<quint64>, BUCKETS> counts{};
+            std::atomic<quint64> count{0};
+            std::atomic<quint64> sum{0};
+            std::atomic<quint64> max{0};
+        };
+        std::array<Shard, SHARDS> m_shards;
+    };
+
+    /**
+     * @brief Замер длительности области видимости в гистограмму, нс
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram &histogram)
+            : m_histogram(histogram), m_start(nowNs()) {}
+
+        ~ScopedTimer() {
+            m_histogram.record(static_cast<quint64>(nowNs() - m_start));
+        }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        Histogram &m_histogram;
+        qint64     m_start;
+    };
+
+    /**
+     * @brief Реестр метрик процесса
+     * @details Метрики не удаляются до завершения процесса,
+     * поэтому ссылки на них можно хранить сколько угодно
+     */
+    class Registry {
+    public:
+        static Registry &instance() {
+            static Registry registry;
+            return registry;
+        }
+
+        Registry(const Registry &) = delete;
+        Registry &operator=(const Registry &) = delete;
+
+        Counter &counter(const QString &name, const QString &help = QString()) {
+            return get(m_counters, name, help);
+        }
+
+        Gauge &gauge(const QString &name, const QString &help = QString()) {
+            return get(m_gauges, name, help);
+        }
+
+        Histogram &histogram(const QString &name, const QString &help = QString()) {
+            return get(m_histograms, name, help);
+        }
+
+        /**
+         * @brief Все метрики в текстовом формате Prometheus
+         * @details Гистограммы выводятся как summary: квантили
+         * 0.5/0.9/0.99/0.999, сумма, количество и отдельно максимум
+         */
+        QByteArray exposition() const {
+            QByteArray out;
+            QMutexLocker locker(&m_mutex);
+
+            for (const auto &[name, entry] : m_counters) {
+                header(out, name, entry.help, "counter");
+                out += QString("%1 %2\n").arg(name).arg(entry.metric->value()).toUtf8();
+            }
+
+            for (const auto &[name, entry] : m_gauges) {
+                header(out, name, entry.help, "gauge");
+                out += QString("%1 %2\n").arg(name).arg(entry.metric->value()).toUtf8();
+            }
+
+            for (const auto &[name, entry] : m_histograms) {
+                const Histogram::Snapshot snap = entry.metric->snapshot();
+                header(out, name, entry.help, "summary");
+                for (double q : { 0.5, 0.9, 0.99, 0.999 }) {
+                    out += QString("%1{quantile=\"%2\"} %3\n")
+                               .arg(name).arg(q).arg(snap.quantile(q)).toUtf8();
+                }
+                out += QString("%1_sum %2\n").arg(name).arg(snap.sum).toUtf8();
+                out += QString("%1_count %2\n").arg(name).arg(snap.count).toUtf8();
+                out += QString("%1_max %2\n").arg(name).arg(snap.max).toUtf8();
+            }
+            return out;
+        }
+
+        /**
+         * @brief Все метрики в JSON для отчётов
+         * @details { "counters": {имя: значение}, "gauges": {...},
+         * "histograms": {имя: {count, mean, p50, p90, p99, p999, max}} }
+         */
+        QJsonObject json() const {
+            QJsonObject counters;
+            QJsonObject gauges;
+            QJsonObject histograms;
+            QMutexLocker locker(&m_mutex);
+
+            for (const auto &[name, entry] : m_counters) {
+                counters[name] = static_cast<qint64>(entry.metric->value());
+            }
+
+            for (const auto &[name, entry] : m_gauges) {
+                gauges[name] = entry.metric->value();
+            }
+
+            for (const auto &[name, entry] : m_histograms) {
+                const Histogram::Snapshot snap = entry.metric->snapshot();
+                histograms[name] = QJsonObject{
+                    { "count", static_cast<qint64>(snap.count) },
+                    { "mean",  snap.mean() },
+                    { "p50",   static_cast<qint64>(snap.quantile(0.5)) },
+                    { "p90",   static_cast<qint64>(snap.quantile(0.9)) },
+                    { "p99",   static_cast<qint64>(snap.quantile(0.99)) },
+                    { "p999",  static_cast<qint64>(snap.quantile(0.999)) },
+                    { "max",   static_cast<qint64>(snap.max) }
+                };
+            }
+
+            return QJsonObject{
+                { "counters",   counters },
+                { "gauges",     gauges },
+                { "histograms", histograms }
+            };
+        }
+
+        /**
+         * @brief Поиск гистограммы по имени без создания
+         * @return nullptr, если гистограммы нет
+         */
+        const Histogram *findHistogram(const QString &name) const {
+            QMutexLocker locker(&m_mutex);
+            auto it = m_histograms.find(name);
+            return (it != m_histograms.end()) ? it->second.metric.get() : nullptr;
+        }
+
+        /**
+         * @brief Поиск показателя по имени без создания
+         * @return nullptr, если показателя нет
+         */
+        const Gauge *findGauge(const QString &name) const {
+            QMutexLocker locker(&m_mutex);
+            auto it = m_gauges.find(name);
+            return (it != m_gauges.end()) ? it->second.metric.get() : nullptr;
+        }
+
+    private:
+        Registry() = default;
+
+        template <typename T>
+        struct Entry {
+            std::unique_ptr<T> metric;
+            QString            help;
+        };
+
+        template <typename T>
+        T &get(std::map<QString, Entry<T>> &map, const QString &name, const QString &help) {
+            QMutexLocker locker(&m_mutex);
+            auto &entry = map[name];
+            if (!entry.metric) {
+                entry.metric = std::make_unique<T>();
+                entry.help   = help;
+            }
+            return *entry.metric;
+        }
+
+        static void header(QByteArray &out, const QString &name, const QString &help, const char *type) {
+            if (!help.isEmpty()) {
+                out += QString("# HELP %1 %2\n").arg(name, help).toUtf8();
+            }
+            out += QString("# TYPE %1 %2\n").arg(name, QLatin1String(type)).toUtf8();
+        }
+
+        mutable QMutex                       m_mutex;      //!< Защита словарей, не записи метрик
+        std::map<QString, Entry<Counter>>    m_counters;   //!< Счётчики по имени
+        std::map<QString, Entry<Gauge>>      m_gauges;     //!< Показатели по имени
+        std::map<QString, Entry<Histogram>>  m_histograms; //!< Гистограммы по имени
+    };
+}
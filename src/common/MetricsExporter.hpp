@@ -0,0 +1,160 @@
+#pragma once
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSaveFile>
+#include <QMutex>
+
+#include "Metrics.hpp"
+#include "structures.hpp"
+
+/**
+ * @brief Публикация метрик в текстовом формате Prometheus
+ * @details Отдаёт Metrics::Registry::exposition() по HTTP на
+ * 127.0.0.1:metricsPort и/или через Unix-сокет metricsSocket
+ * (curl --unix-socket <путь> http://localhost/metrics), а также
+ * пишет снимок в файл metricsSnapshotFile. Снимок пишется атомарно
+ * через QSaveFile и может вызываться из любого потока, например
+ * периодической задачей планировщика.
+ */
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsExporter(QObject *parent = nullptr)
+        : QObject(parent) {}
+
+    ~MetricsExporter() { stop(); }
+
+    /**
+     * @brief Запуск публикации по настройкам
+     * @param settings Настройки диагностики
+     * @return false, если не удалось открыть хотя бы один из каналов
+     */
+    bool start(const DiagnosticsSettings &settings) {
+        stop();
+
+        bool ok = true;
+        {
+            QMutexLocker locker(&m_mutex);
+            m_snapshotFile = settings.metricsSnapshotFile;
+        }
+
+        if (settings.metricsPort > 0) {
+            m_tcpServer = new QTcpServer(this);
+            connect(m_tcpServer, &QTcpServer::newConnection, this, [this]() {
+                while (QTcpSocket *socket = m_tcpServer->nextPendingConnection()) {
+                    serve(socket);
+                }
+            });
+
+            if (!m_tcpServer->listen(QHostAddress::LocalHost,
+                                     static_cast<quint16>(settings.metricsPort))) {
+                emit errorOccurred(QString("Metrics: failed to listen on port %1: %2")
+                                       .arg(settings.metricsPort)
+                                       .arg(m_tcpServer->errorString()));
+                ok = false;
+            }
+        }
+
+        if (!settings.metricsSocket.isEmpty()) {
+            QLocalServer::removeServer(settings.metricsSocket);
+
+            m_localServer = new QLocalServer(this);
+            m_localServer->setSocketOptions(QLocalServer::UserAccessOption);
+            connect(m_localServer, &QLocalServer::newConnection, this, [this]() {
+                while (QLocalSocket *socket = m_localServer->nextPendingConnection()) {
+                    serve(socket);
+                }
+            });
+
+            if (!m_localServer->listen(settings.metricsSocket)) {
+                emit errorOccurred(QString("Metrics: failed to listen on %1: %2")
+                                       .arg(settings.metricsSocket)
+                                       .arg(m_localServer->errorString()));
+                ok = false;
+            }
+        }
+
+        return ok;
+    }
+
+    /**
+     * @brief Остановка серверов
+     */
+    void stop() {
+        if (m_tcpServer) {
+            m_tcpServer->close();
+            m_tcpServer->deleteLater();
+            m_tcpServer = nullptr;
+        }
+        if (m_localServer) {
+            m_localServer->close();
+            m_localServer->deleteLater();
+            m_localServer = nullptr;
+        }
+    }
+
+    /**
+     * @brief Запись снимка метрик в файл, потокобезопасно
+     * @return true, если снимок записан или файл не задан
+     */
+    bool writeSnapshot() {
+        QMutexLocker locker(&m_mutex);
+        if (m_snapshotFile.isEmpty()) {
+            return true;
+        }
+
+        QSaveFile file(m_snapshotFile);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+        file.write(Metrics::Registry::instance().exposition());
+        return file.commit();
+    }
+
+signals:
+    /**
+     * @brief Сигнал об ошибке публикации
+     * @param message Текст ошибки
+     */
+    void errorOccurred(const QString &message);
+
+private:
+    /**
+     * @brief Ответ на запрос клиента
+     * @details Запрос не разбирается: на любой запрос
+     * отдаётся полный набор метрик, затем соединение закрывается
+     */
+    template <typename Socket>
+    void serve(Socket *socket) {
+        connect(socket, &Socket::readyRead, socket, [socket]() {
+            socket->readAll();
+
+            const QByteArray body = Metrics::Registry::instance().exposition();
+            QByteArray response;
+            response += "HTTP/1.0 200 OK\r\n";
+            response += "Content-Type: text/plain; version=0.0.4\r\n";
+            response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+            response += "Connection: close\r\n\r\n";
+            response += body;
+
+            socket->write(response);
+            closeSocket(socket);
+        });
+        connect(socket, &Socket::disconnected, socket, &QObject::deleteLater);
+    }
+
+    static void closeSocket(QTcpSocket *socket)   { socket->disconnectFromHost();   }
+    static void closeSocket(QLocalSocket *socket) { socket->disconnectFromServer(); }
+
+private:
+    QTcpServer   *m_tcpServer   = nullptr; //!< HTTP на localhost
+    QLocalServer *m_localServer = nullptr; //!< HTTP через Unix-сокет
+    QString       m_snapshotFile;          //!< Файл снимка
+    QMutex        m_mutex;                 //!< Защита записи снимка
+};
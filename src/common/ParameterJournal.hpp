@@ -0,0 +1,326 @@
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QMap>
+#include <QMutex>
+#include <QSaveFile>
+#include <QString>
+#include <QtEndian>
+
+#include <array>
+#include <cstring>
+
+#if defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Журнал упреждающей записи числовых параметров
+ * @details Каждое изменение параметра дописывается в конец файла записью
+ * фиксированного размера (RECORD_SIZE байт) с контрольной суммой CRC-32,
+ * после чего данные сбрасываются на носитель (fdatasync). Запись в 32 байта
+ * вместо перезаписи всего config.json позволяет сохранять значение при
+ * каждом изменении.
+ *
+ * При открытии журнал воспроизводится: значения действительных записей
+ * накладываются по порядку, а хвост после первой повреждённой записи
+ * (оборванной при сбое питания) отбрасывается. Владелец журнала
+ * периодически переносит значения в config.json (атомарно, через
+ * ConfigReader::saveSettings) и вызывает discardBefore() с номером,
+ * запомненным до сохранения: записи, сделанные во время сохранения,
+ * остаются в журнале. Сбой между сохранением и очисткой безопасен:
+ * повторное применение записей даёт те же значения.
+ *
+ * Изменения можно писать группой (append() со списком значений):
+ * одна запись на параметр и один fdatasync на всю группу.
+ *
+ * Формат записи (порядок байт - little-endian):
+ *  - sequence, 4 байта - номер записи, растёт непрерывно;
+ *  - key, 16 байт - имя параметра в UTF-8, дополненное нулями;
+ *  - value, 8 байт - значение double;
+ *  - crc, 4 байта - CRC-32 первых 28 байт.
+ */
+class ParameterJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int KEY_SIZE    = 16; //!< Максимальная длина имени параметра в байтах
+    static constexpr int RECORD_SIZE = 32; //!< Размер записи в байтах
+
+    explicit ParameterJournal(QObject *parent = nullptr)
+        : QObject(parent) {}
+
+    /**
+     * @brief Открытие журнала и воспроизведение записей
+     * @param filePath Путь к файлу журнала, создаётся при отсутствии
+     * @return Значения из действительных записей журнала
+     */
+    QMap<QString, double> open(const QString &filePath) {
+        QMutexLocker locker(&m_mutex);
+        QMap<QString, double> values;
+
+        m_file.close();
+        m_file.setFileName(filePath);
+        if (!m_file.open(QIODevice::ReadWrite)) {
+            emit errorOccurred(QString("Failed to open parameter journal %1: %2")
+                                   .arg(filePath, m_file.errorString()));
+            return values;
+        }
+
+        const QByteArray data = m_file.readAll();
+        qint64 valid = 0;
+        m_records = 0;
+        for (; valid + RECORD_SIZE <= data.size(); valid += RECORD_SIZE) {
+            QString key;
+            double  value = 0;
+            quint32 sequence = 0;
+            if (!decode(data.constData() + valid, key, value, sequence)) {
+                break;
+            }
+            values.insert(key, value);
+            m_sequence = sequence + 1;
+            ++m_records;
+        }
+
+        if (valid != data.size()) {
+            emit errorOccurred(QString("Parameter journal %1: dropped %2 bytes of incomplete or corrupt records")
+                                   .arg(filePath).arg(data.size() - valid));
+            m_file.resize(valid);
+        }
+        m_file.seek(valid);
+
+        return values;
+    }
+
+    /**
+     * @brief Допустимо ли имя параметра: 1..KEY_SIZE байт в UTF-8
+     */
+    static bool isValidKey(const QString &key) {
+        const qsizetype size = key.toUtf8().size();
+        return size > 0 && size <= KEY_SIZE;
+    }
+
+    /**
+     * @brief Запись нового значения параметра
+     * @return false, если имя длиннее KEY_SIZE байт или запись не удалась
+     * @details Возврат происходит после сброса записи на носитель
+     */
+    bool append(const QString &key, double value) {
+        return append(QMap<QString, double>{ { key, value } });
+    }
+
+    /**
+     * @brief Групповая запись значений параметров
+     * @return false, если хотя бы одно имя недопустимо или запись не удалась
+     * @details Записи пишутся подряд одним вызовом write() и сбрасываются
+     * на носитель одним fdatasync на всю группу. Записи с недопустимыми
+     * именами пропускаются
+     */
+    bool append(const QMap<QString, double> &values) {
+        QByteArray batch;
+        batch.reserve(values.size() * RECORD_SIZE);
+        bool allValid = true;
+
+        QMutexLocker locker(&m_mutex);
+        if (!m_file.isOpen()) {
+            return false;
+        }
+
+        quint32 sequence = m_sequence;
+        for (auto it = values.cbegin(); it != values.cend(); ++it) {
+            const QByteArray utf8 = it.key().toUtf8();
+            if (utf8.isEmpty() || utf8.size() > KEY_SIZE) {
+                emit errorOccurred(QString("Parameter name '%1' must be 1..%2 bytes").arg(it.key()).arg(KEY_SIZE));
+                allValid = false;
+                continue;
+            }
+            const std::array<char, RECORD_SIZE> record = encode(utf8, it.value(), sequence++);
+            batch.append(record.data(), RECORD_SIZE);
+        }
+        if (batch.isEmpty()) {
+            return allValid;
+        }
+
+        if (m_file.write(batch) != batch.size() || !m_file.flush()) {
+            emit errorOccurred(QString("Failed to write parameter journal: %1").arg(m_file.errorString()));
+            return false;
+        }
+#if defined(Q_OS_UNIX)
+        ::fdatasync(m_file.handle());
+#endif
+        m_records += static_cast<int>(batch.size() / RECORD_SIZE);
+        m_sequence = sequence;
+        return allValid;
+    }
+
+    /**
+     * @brief Очистка журнала после переноса значений в config.json
+     */
+    void reset() {
+        QMutexLocker locker(&m_mutex);
+        if (m_file.isOpen()) {
+            m_file.resize(0);
+            m_file.seek(0);
+#if defined(Q_OS_UNIX)
+            ::fdatasync(m_file.handle());
+#endif
+        }
+        m_records = 0;
+    }
+
+    /**
+     * @brief Номер, который получит следующая запись
+     */
+    quint32 nextSequence() const {
+        QMutexLocker locker(&m_mutex);
+        return m_sequence;
+    }
+
+    /**
+     * @brief Удаление записей с номерами меньше sequence
+     * @param sequence Значение nextSequence() до переноса значений в config.json
+     * @details Более поздние записи сохраняются. Если такие есть, журнал
+     * переписывается атомарно (QSaveFile): при сбое остаётся либо прежний
+     * журнал целиком, либо только новые записи
+     */
+    void discardBefore(quint32 sequence) {
+        QMutexLocker locker(&m_mutex);
+        if (!m_file.isOpen()) {
+            return;
+        }
+
+        if (!m_file.seek(0)) {
+            return;
+        }
+        const QByteArray data = m_file.read(qint64(m_records) * RECORD_SIZE);
+        m_file.seek(m_file.size());
+        if (data.size() != qint64(m_records) * RECORD_SIZE) {
+            emit errorOccurred(QString("Failed to read parameter journal: %1").arg(m_file.errorString()));
+            return;
+        }
+
+        int keep = m_records;
+        for (qint64 offset = 0; offset + RECORD_SIZE <= data.size(); offset += RECORD_SIZE) {
+            const quint32 recordSequence = qFromLittleEndian<quint32>(data.constData() + offset);
+            // Сравнение через разность переживает переполнение номера
+            if (static_cast<qint32>(recordSequence - sequence) >= 0) {
+                break;
+            }
+            --keep;
+        }
+
+        if (keep == m_records) {
+            return;
+        }
+        if (keep == 0) {
+            m_file.resize(0);
+            m_file.seek(0);
+#if defined(Q_OS_UNIX)
+            ::fdatasync(m_file.handle());
+#endif
+            m_records = 0;
+            return;
+        }
+
+        const QString filePath = m_file.fileName();
+        QSaveFile tail(filePath);
+        const qint64 tailBytes = qint64(keep) * RECORD_SIZE;
+        if (!tail.open(QIODevice::WriteOnly) ||
+            tail.write(data.constData() + data.size() - tailBytes, tailBytes) != tailBytes ||
+            !tail.commit()) {
+            emit errorOccurred(QString("Failed to rewrite parameter journal %1: %2")
+                                   .arg(filePath, tail.errorString()));
+            return;
+        }
+
+        m_file.close();
+        if (!m_file.open(QIODevice::ReadWrite)) {
+            emit errorOccurred(QString("Failed to reopen parameter journal %1: %2")
+                                   .arg(filePath, m_file.errorString()));
+            m_records = 0;
+            return;
+        }
+        m_file.seek(m_file.size());
+        m_records = keep;
+    }
+
+    /**
+     * @brief Количество записей в журнале
+     */
+    int records() const {
+        QMutexLocker locker(&m_mutex);
+        return m_records;
+    }
+
+    /**
+     * @brief CRC-32 (IEEE 802.3, отражённый полином 0xEDB88320)
+     */
+    static quint32 crc32(const char *data, std::size_t size) {
+        static constexpr auto table = []() {
+            std::array<quint32, 256> t{};
+            for (quint32 i = 0; i < 256; ++i) {
+                quint32 c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                }
+                t[i] = c;
+            }
+            return t;
+        }();
+
+        quint32 crc = 0xFFFFFFFFu;
+        for (std::size_t i = 0; i < size; ++i) {
+            crc = table[(crc ^ static_cast<quint8>(data[i])) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+signals:
+    /**
+     * @brief Сигнал об ошибке работы с журналом
+     * @param message Текст ошибки
+     */
+    void errorOccurred(const QString &message);
+
+private:
+    static constexpr int KEY_OFFSET   = 4;
+    static constexpr int VALUE_OFFSET = KEY_OFFSET + KEY_SIZE;
+    static constexpr int CRC_OFFSET   = VALUE_OFFSET + 8;
+
+    static std::array<char, RECORD_SIZE> encode(const QByteArray &key, double value, quint32 sequence) {
+        std::array<char, RECORD_SIZE> record{};
+        quint64 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        qToLittleEndian(sequence, record.data());
+        std::memcpy(record.data() + KEY_OFFSET, key.constData(), key.size());
+        qToLittleEndian(bits, record.data() + VALUE_OFFSET);
+        qToLittleEndian(crc32(record.data(), CRC_OFFSET), record.data() + CRC_OFFSET);
+        return record;
+    }
+
+    static bool decode(const char *record, QString &key, double &value, quint32 &sequence) {
+        if (qFromLittleEndian<quint32>(record + CRC_OFFSET) != crc32(record, CRC_OFFSET)) {
+            return false;
+        }
+
+        const char *keyData = record + KEY_OFFSET;
+        const std::size_t keyLength = qstrnlen(keyData, KEY_SIZE);
+        if (keyLength == 0) {
+            return false;
+        }
+
+        const quint64 bits = qFromLittleEndian<quint64>(record + VALUE_OFFSET);
+        std::memcpy(&value, &bits, sizeof(value));
+        key      = QString::fromUtf8(keyData, static_cast<qsizetype>(keyLength));
+        sequence = qFromLittleEndian<quint32>(record);
+        return true;
+    }
+
+    mutable QMutex m_mutex;        //!< Защита файла и счётчиков
+    QFile          m_file;         //!< Файл журнала, открыт на чтение и запись
+    quint32        m_sequence = 0; //!< Номер следующей записи
+    int            m_records  = 0; //!< Записей в журнале
+};
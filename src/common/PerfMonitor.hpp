@@ -0,0 +1,241 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+#include <QVariantList>
+#include <QVariantMap>
+
+#include <algorithm>
+#include <vector>
+
+#include "Metrics.hpp"
+#include "ProcessStats.hpp"
+
+/**
+ * @brief Источник данных для экранной панели производительности
+ * @details Раз в UPDATE_INTERVAL мс собирает показатели за прошедшее окно:
+ *  - время кадра (p50/p99) из гистограммы frame_render_ns - стоимость
+ *    отрисовки от синхронизации сцены до показа кадра, поэтому
+ *    простаивающий экран не выглядит медленным;
+ *  - частоту кадров по числу записей в гистограмме frame_interval_ns;
+ *  - задержку цикла событий GUI: таймер-зонд на потоке GUI раз в
+ *    PROBE_INTERVAL мс измеряет опоздание своего срабатывания,
+ *    результат пишется в гистограмму gui_loop_latency_ns;
+ *  - глубину очередей логгера и обработчика сообщений;
+ *  - загрузку процессора по потокам и RSS из /proc.
+ * Пока монитор выключен, таймеры остановлены и он ничего не стоит.
+ * Живёт в потоке GUI.
+ */
+class PerfMonitor : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool         enabled          READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(double       frameP50Ms       READ frameP50Ms       NOTIFY updated)
+    Q_PROPERTY(double       frameP99Ms       READ frameP99Ms       NOTIFY updated)
+    Q_PROPERTY(double       fps              READ fps              NOTIFY updated)
+    Q_PROPERTY(double       loopLatencyP99Ms READ loopLatencyP99Ms NOTIFY updated)
+    Q_PROPERTY(double       loopLatencyMaxMs READ loopLatencyMaxMs NOTIFY updated)
+    Q_PROPERTY(int          loggerQueue      READ loggerQueue      NOTIFY updated)
+    Q_PROPERTY(int          messagesQueue    READ messagesQueue    NOTIFY updated)
+    Q_PROPERTY(double       rssMb            READ rssMb            NOTIFY updated)
+    Q_PROPERTY(QVariantList threads          READ threads          NOTIFY updated)
+
+public:
+    static constexpr int UPDATE_INTERVAL = 500; //!< Период обновления, мс (2 Гц)
+    static constexpr int PROBE_INTERVAL  = 50;  //!< Период зонда цикла событий, мс
+    static constexpr int MAX_THREADS     = 8;   //!< Сколько самых загруженных потоков показывать
+
+    explicit PerfMonitor(QObject *parent = nullptr)
+        : QObject(parent),
+          m_loopLatency(Metrics::Registry::instance().histogram(
+              "gui_loop_latency_ns", "GUI event loop dispatch delay, ns")) {
+        m_probeTimer.setTimerType(Qt::PreciseTimer);
+        m_probeTimer.setInterval(PROBE_INTERVAL);
+        connect(&m_probeTimer, &QTimer::timeout, this, &PerfMonitor::probe);
+
+        m_updateTimer.setInterval(UPDATE_INTERVAL);
+        connect(&m_updateTimer, &QTimer::timeout, this, &PerfMonitor::update);
+    }
+
+    bool enabled() const { return m_updateTimer.isActive(); }
+
+    /**
+     * @brief Включение и выключение сбора показателей
+     */
+    void setEnabled(bool enable) {
+        if (enable == enabled()) {
+            return;
+        }
+
+        if (enable) {
+            m_lastProbeNs  = Metrics::nowNs();
+            m_lastUpdateNs = m_lastProbeNs;
+            m_lastCpu.clear();
+            if (const Metrics::Histogram *frames = frameHistogram()) {
+                m_lastFrames = frames->snapshot();
+            }
+            if (const Metrics::Histogram *render = renderHistogram()) {
+                m_lastRender = render->snapshot();
+            }
+            m_lastLoop = m_loopLatency.snapshot();
+            m_probeTimer.start();
+            m_updateTimer.start();
+        } else {
+            m_probeTimer.stop();
+            m_updateTimer.stop();
+        }
+        emit enabledChanged();
+    }
+
+    double       frameP50Ms()       const { return m_frameP50Ms; }
+    double       frameP99Ms()       const { return m_frameP99Ms; }
+    double       fps()              const { return m_fps; }
+    double       loopLatencyP99Ms() const { return m_loopP99Ms; }
+    double       loopLatencyMaxMs() const { return m_loopMaxMs; }
+    int          loggerQueue()      const { return m_loggerQueue; }
+    int          messagesQueue()    const { return m_messagesQueue; }
+    double       rssMb()            const { return m_rssMb; }
+
+    /**
+     * @brief Самые загруженные потоки: список { name, cpu },
+     * cpu - загрузка одного ядра в процентах
+     */
+    QVariantList threads() const { return m_threads; }
+
+signals:
+    void enabledChanged();
+
+    /**
+     * @brief Показатели обновлены
+     */
+    void updated();
+
+private slots:
+    /**
+     * @brief Замер опоздания таймера-зонда
+     */
+    void probe() {
+        const qint64 now  = Metrics::nowNs();
+        const qint64 late = now - m_lastProbeNs - qint64(PROBE_INTERVAL) * 1000000;
+        m_loopLatency.record(static_cast<quint64>(std::max<qint64>(late, 0)));
+        m_lastProbeNs = now;
+    }
+
+    /**
+     * @brief Сбор показателей за прошедшее окно
+     */
+    void update() {
+        const qint64 now    = Metrics::nowNs();
+        const double wallMs = (now - m_lastUpdateNs) / 1e6;
+        m_lastUpdateNs = now;
+
+        if (const Metrics::Histogram *frames = frameHistogram()) {
+            const Metrics::Histogram::Snapshot snap   = frames->snapshot();
+            const Metrics::Histogram::Snapshot window = snap.since(m_lastFrames);
+            m_lastFrames = snap;
+            m_fps        = (wallMs > 0) ? window.count * 1000.0 / wallMs : 0.0;
+        }
+
+        if (const Metrics::Histogram *render = renderHistogram()) {
+            const Metrics::Histogram::Snapshot snap   = render->snapshot();
+            const Metrics::Histogram::Snapshot window = snap.since(m_lastRender);
+            m_lastRender = snap;
+
+            // Окно без кадров: время кадра не изменилось
+            if (window.count != 0) {
+                m_frameP50Ms = window.quantile(0.5)  / 1e6;
+                m_frameP99Ms = window.quantile(0.99) / 1e6;
+            }
+        }
+
+        const Metrics::Histogram::Snapshot loop   = m_loopLatency.snapshot();
+        const Metrics::Histogram::Snapshot window = loop.since(m_lastLoop);
+        m_lastLoop  = loop;
+        m_loopP99Ms = window.quantile(0.99) / 1e6;
+        m_loopMaxMs = window.max / 1e6;
+
+        m_loggerQueue   = gaugeValue("logger_queue_depth");
+        m_messagesQueue = gaugeValue("messages_queue_depth");
+        m_rssMb         = ProcessStats::rssKb() / 1024.0;
+
+        updateThreads(wallMs);
+
+        emit updated();
+    }
+
+private:
+    const Metrics::Histogram *frameHistogram() {
+        // Гистограмма регистрируется в main() после создания окна
+        if (!m_frames) {
+            m_frames = Metrics::Registry::instance().findHistogram("frame_interval_ns");
+        }
+        return m_frames;
+    }
+
+    const Metrics::Histogram *renderHistogram() {
+        if (!m_render) {
+            m_render = Metrics::Registry::instance().findHistogram("frame_render_ns");
+        }
+        return m_render;
+    }
+
+    static int gaugeValue(const QString &name) {
+        const Metrics::Gauge *gauge = Metrics::Registry::instance().findGauge(name);
+        return gauge ? static_cast<int>(gauge->value()) : 0;
+    }
+
+    void updateThreads(double wallMs) {
+        const QList<ProcessStats::ThreadCpu> current = ProcessStats::threadCpu();
+
+        struct Load {
+            QString name;
+            double  cpu;
+        };
+        std::vector<Load> loads;
+        loads.reserve(current.size());
+
+        QHash<qint64, qint64> cpuByTid;
+        for (const auto &thread : current) {
+            cpuByTid.insert(thread.tid, thread.cpuMs);
+            const auto previous = m_lastCpu.constFind(thread.tid);
+            if (previous != m_lastCpu.constEnd() && wallMs > 0) {
+                loads.push_back({ thread.name, (thread.cpuMs - *previous) * 100.0 / wallMs });
+            }
+        }
+        m_lastCpu = std::move(cpuByTid);
+
+        const std::size_t shown = std::min<std::size_t>(loads.size(), MAX_THREADS);
+        std::partial_sort(loads.begin(), loads.begin() + shown, loads.end(),
+                          [](const Load &a, const Load &b) { return a.cpu > b.cpu; });
+
+        m_threads.clear();
+        for (std::size_t i = 0; i < shown; ++i) {
+            m_threads.append(QVariantMap{ { "name", loads[i].name }, { "cpu", loads[i].cpu } });
+        }
+    }
+
+    QTimer m_probeTimer;  //!< Зонд цикла событий
+    QTimer m_updateTimer; //!< Обновление показателей
+
+    Metrics::Histogram       &m_loopLatency;       //!< Задержка цикла событий GUI
+    const Metrics::Histogram *m_frames = nullptr;  //!< Интервалы между кадрами
+    const Metrics::Histogram *m_render = nullptr;  //!< Стоимость отрисовки кадра
+    Metrics::Histogram::Snapshot m_lastFrames;     //!< Снимок кадров на начало окна
+    Metrics::Histogram::Snapshot m_lastRender;     //!< Снимок стоимости отрисовки на начало окна
+    Metrics::Histogram::Snapshot m_lastLoop;       //!< Снимок зонда на начало окна
+    QHash<qint64, qint64>     m_lastCpu;           //!< Время процессора по потокам на начало окна
+
+    qint64 m_lastProbeNs  = 0;
+    qint64 m_lastUpdateNs = 0;
+
+    double       m_frameP50Ms    = 0;
+    double       m_frameP99Ms    = 0;
+    double       m_fps           = 0;
+    double       m_loopP99Ms     = 0;
+    double       m_loopMaxMs     = 0;
+    int          m_loggerQueue   = 0;
+    int          m_messagesQueue = 0;
+    double       m_rssMb         = 0;
+    QVariantList m_threads;
+};
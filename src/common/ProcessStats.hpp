@@ -0,0 +1,118 @@
+#pragma once
+
+#include <QFile>
+#include <QByteArray>
+#include <QDir>
+#include <QList>
+#include <QString>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Чтение показателей процесса из /proc
+ * @details На системах без /proc (не Linux) методы возвращают -1
+ */
+namespace ProcessStats {
+
+    /**
+     * @brief Значение поля из /proc/self/status в килобайтах
+     * @param field Имя поля, например "VmRSS"
+     */
+    inline qint64 statusFieldKb(const QByteArray &field) {
+        QFile file("/proc/self/status");
+        if (!file.open(QIODevice::ReadOnly)) {
+            return -1;
+        }
+
+        const QByteArray prefix = field + ':';
+        while (!file.atEnd()) {
+            const QByteArray line = file.readLine();
+            if (line.startsWith(prefix)) {
+                return line.mid(prefix.size()).trimmed().split(' ').value(0).toLongLong();
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Резидентная память процесса (RSS), КБ
+     */
+    inline qint64 rssKb() { return statusFieldKb("VmRSS"); }
+
+    /**
+     * @brief Пиковая резидентная память процесса, КБ
+     */
+    inline qint64 peakRssKb() { return statusFieldKb("VmHWM"); }
+
+    /**
+     * @brief Количество потоков процесса
+     */
+    inline qint64 threadCount() { return statusFieldKb("Threads"); }
+
+    /**
+     * @brief Количество открытых файловых дескрипторов
+     */
+    inline qint64 openFdCount() {
+        QDir dir("/proc/self/fd");
+        if (!dir.exists()) {
+            return -1;
+        }
+        return dir.entryList(QDir::Files | QDir::System | QDir::NoDotAndDotDot).size();
+    }
+
+    /**
+     * @brief Процессорное время одного потока
+     */
+    struct ThreadCpu {
+        qint64  tid   = 0; //!< Идентификатор потока в системе
+        QString name;      //!< Имя потока (comm)
+        qint64  cpuMs = 0; //!< Время user + system, мс
+    };
+
+    /**
+     * @brief Процессорное время всех потоков процесса
+     * @details Читает /proc/self/task/<tid>/stat; на системах
+     * без /proc возвращает пустой список
+     */
+    inline QList<ThreadCpu> threadCpu() {
+        QList<ThreadCpu> result;
+#if defined(Q_OS_LINUX)
+        static const qint64 ticksPerSecond = sysconf(_SC_CLK_TCK);
+        if (ticksPerSecond <= 0) {
+            return result;
+        }
+
+        const QStringList tasks = QDir("/proc/self/task").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        result.reserve(tasks.size());
+        for (const QString &task : tasks) {
+            QFile file("/proc/self/task/" + task + "/stat");
+            if (!file.open(QIODevice::ReadOnly)) {
+                continue; // поток мог завершиться
+            }
+
+            // Имя потока в скобках может содержать пробелы,
+            // поэтому поля считаются от последней скобки
+            const QByteArray line = file.readAll();
+            const qsizetype open  = line.indexOf('(');
+            const qsizetype close = line.lastIndexOf(')');
+            if (open < 0 || close < open) {
+                continue;
+            }
+            const QList<QByteArray> fields = line.mid(close + 2).split(' ');
+            if (fields.size() < 13) {
+                continue;
+            }
+
+            ThreadCpu cpu;
+            cpu.tid   = task.toLongLong();
+            cpu.name  = QString::fromUtf8(line.mid(open + 1, close - open - 1));
+            // utime и stime - 14-е и 15-е поля stat
+            cpu.cpuMs = (fields[11].toLongLong() + fields[12].toLongLong()) * 1000 / ticksPerSecond;
+            result.append(cpu);
+        }
+#endif
+        return result;
+    }
+}
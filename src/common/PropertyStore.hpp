@@ -0,0 +1,147 @@
+#pragma once
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+
+/**
+ * @brief Хранилище свойств для пакетной доставки изменений в QML
+ * @details Потоки бэкенда записывают значения без блокировок:
+ * значение хранится как 64-битный образ в атомарной ячейке, а номер
+ * изменившегося свойства отмечается битом в атомарной маске.
+ * Поток GUI раз в кадр забирает маску и одним сигналом
+ * propertiesChanged сообщает, какие свойства изменились. Владелец
+ * хранилища (AppEngine) превращает маску в отдельные NOTIFY-сигналы,
+ * поэтому QML пересчитывает только зависящие от изменившихся
+ * свойств привязки, а межпоточный сигнал идёт не чаще раза за кадр.
+ * Таймер публикации запускается первой записью, изменившей значение,
+ * и останавливается, когда очередной кадр не нашёл изменений:
+ * без изменений поток GUI не просыпается.
+ */
+class PropertyStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MAX_PROPERTIES = 64; //!< Ограничено разрядностью маски
+
+    explicit PropertyStore(QObject *parent = nullptr)
+        : QObject(parent) {
+        for (auto &value : m_values) {
+            value.store(0, std::memory_order_relaxed);
+        }
+
+        m_frameTimer.setTimerType(Qt::PreciseTimer);
+        m_frameTimer.setInterval(DEFAULT_FRAME_INTERVAL);
+        connect(&m_frameTimer, &QTimer::timeout, this, &PropertyStore::publish);
+    }
+
+    /**
+     * @brief Интервал публикации изменений, мс
+     */
+    void setFrameInterval(int msec) { m_frameTimer.setInterval(msec); }
+
+    /**
+     * @brief Запись логического значения, из любого потока
+     * @param id Номер свойства, меньше MAX_PROPERTIES
+     */
+    void setBool(int id, bool value) { store(id, value ? 1 : 0); }
+
+    /**
+     * @brief Запись целого значения, из любого потока
+     */
+    void setInt(int id, qint64 value) { store(id, static_cast<quint64>(value)); }
+
+    /**
+     * @brief Запись вещественного значения, из любого потока
+     */
+    void setReal(int id, double value) {
+        quint64 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        store(id, bits);
+    }
+
+    bool   toBool(int id) const { return load(id) != 0; }
+    qint64 toInt(int id)  const { return static_cast<qint64>(load(id)); }
+    double toReal(int id) const {
+        const quint64 bits = load(id);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    /**
+     * @brief Немедленная публикация накопленных изменений
+     * @details Только из потока GUI, например после записи
+     * из QML, чтобы изменение отразилось в том же кадре
+     */
+    void flush() { publish(); }
+
+signals:
+    /**
+     * @brief Сигнал об изменении свойств, не чаще одного раза за кадр
+     * @param mask Битовая маска номеров изменившихся свойств
+     */
+    void propertiesChanged(quint64 mask);
+
+private slots:
+    void publish() {
+        const quint64 mask = m_dirty.exchange(0);
+        if (mask != 0) {
+            emit propertiesChanged(mask);
+            return;
+        }
+
+        // Кадр без изменений: таймер засыпает. Запись, успевшая отметить
+        // изменение до сброса m_armed, видна в повторной проверке маски
+        m_armed.store(false);
+        m_frameTimer.stop();
+        if (m_dirty.load() != 0 && !m_armed.exchange(true)) {
+            m_frameTimer.start();
+        }
+    }
+
+private:
+    static constexpr int DEFAULT_FRAME_INTERVAL = 16;
+
+    void store(int id, quint64 bits) {
+        Q_ASSERT(id >= 0 && id < MAX_PROPERTIES);
+
+        // Повторная запись того же значения не порождает уведомления
+        if (m_values[id].exchange(bits, std::memory_order_relaxed) != bits) {
+            m_dirty.fetch_or(quint64(1) << id);
+            wake();
+        }
+    }
+
+    /**
+     * @brief Запуск таймера публикации, если он стоит
+     * @details Из чужого потока таймер запускается через очередь
+     * событий потока GUI - одно событие на пробуждение
+     */
+    void wake() {
+        if (m_armed.exchange(true)) {
+            return;
+        }
+        if (QThread::currentThread() == thread()) {
+            m_frameTimer.start();
+        } else {
+            QMetaObject::invokeMethod(&m_frameTimer, [this]() { m_frameTimer.start(); },
+                                      Qt::QueuedConnection);
+        }
+    }
+
+    quint64 load(int id) const {
+        Q_ASSERT(id >= 0 && id < MAX_PROPERTIES);
+        return m_values[id].load(std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<quint64>, MAX_PROPERTIES> m_values;   //!< Образы значений свойств
+    std::atomic<quint64>                             m_dirty{0}; //!< Маска изменившихся свойств
+    std::atomic<bool>                                m_armed{false}; //!< Таймер публикации запущен или запускается
+    QTimer                                           m_frameTimer; //!< Таймер публикации
+};
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QStringList>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#if defined(Q_OS_LINUX) && __has_include(<execinfo.h>)
+#define STALL_WATCHDOG_BACKTRACE
+#include <execinfo.h>
+#include <cxxabi.h>
+#include <pthread.h>
+#include <csignal>
+#include <cerrno>
+#include <cstdlib>
+#endif
+
+#include "Metrics.hpp"
+
+/**
+ * @brief Сторож зависаний потока GUI
+ * @details Отдельный поток каждые threshold/4 мс ставит в очередь потока
+ * GUI пустое событие-пульс и следит, когда оно будет обработано. Время
+ * от постановки до обработки пишется в гистограмму gui_heartbeat_latency_ns.
+ * Если пульс не обработан дольше порога, сторож один раз за зависание
+ * снимает стек потока GUI и сообщает о нём сигналом stallDetected,
+ * а после обработки пульса - сигналом stallEnded с полной длительностью.
+ *
+ * Стек снимается на Linux: потоку GUI посылается сигнал SIGRTMIN + 3,
+ * обработчик которого записывает адреса возврата (backtrace) в
+ * статический буфер. Символы разрешаются уже в потоке сторожа; для имён
+ * функций исполняемый файл собирается с экспортом символов (-rdynamic).
+ * На других системах сообщается только длительность.
+ *
+ * Сигналы испускаются из потока сторожа, пока поток GUI стоит, поэтому
+ * подключать их нужно через Qt::DirectConnection к потокобезопасному
+ * получателю (AsyncLogger).
+ */
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MAX_FRAMES = 64;  //!< Глубина снимаемого стека
+    static constexpr int MIN_PERIOD = 10;  //!< Минимальный период пульса, мс
+
+    /**
+     * @brief Создание сторожа
+     * @details Создаётся в потоке GUI: этот поток и будет отслеживаться
+     */
+    explicit StallWatchdog(QObject *parent = nullptr)
+        : QObject(parent),
+          m_heartbeatLatency(Metrics::Registry::instance().histogram(
+              "gui_heartbeat_latency_ns", "GUI thread heartbeat dispatch latency, ns")),
+          m_stalls(Metrics::Registry::instance().counter(
+              "gui_stalls_total", "GUI thread stalls over the watchdog threshold")) {
+#if defined(STALL_WATCHDOG_BACKTRACE)
+        m_guiThread = pthread_self();
+#endif
+    }
+
+    ~StallWatchdog() { stop(); }
+
+    /**
+     * @brief Запуск сторожа
+     * @param thresholdMs Порог зависания, мс; 0 - не запускать
+     */
+    void start(int thresholdMs) {
+        if (m_thread || thresholdMs <= 0) {
+            return;
+        }
+
+        m_thresholdNs = qint64(thresholdMs) * 1000000;
+        m_periodMs    = std::max(thresholdMs / 4, MIN_PERIOD);
+        m_stop        = false;
+
+#if defined(STALL_WATCHDOG_BACKTRACE)
+        installSignalHandler();
+#endif
+
+        m_thread.reset(QThread::create([this]() { watchLoop(); }));
+        m_thread->setObjectName("stall-watchdog");
+        m_thread->start(QThread::HighPriority);
+    }
+
+    /**
+     * @brief Остановка сторожа с ожиданием потока
+     */
+    void stop() {
+        if (!m_thread) {
+            return;
+        }
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stop = true;
+            m_condition.wakeAll();
+        }
+        m_thread->wait();
+        m_thread.reset();
+    }
+
+signals:
+    /**
+     * @brief Поток GUI не отвечает дольше порога
+     * @param stalledMs Сколько поток уже стоит, мс
+     * @param stack Стек потока GUI в момент обнаружения, может быть пустым
+     */
+    void stallDetected(qint64 stalledMs, const QStringList &stack);
+
+    /**
+     * @brief Поток GUI снова отвечает после зависания
+     * @param durationMs Полная длительность зависания, мс
+     */
+    void stallEnded(qint64 durationMs);
+
+private:
+    void watchLoop() {
+        bool reported = false;
+
+        QMutexLocker locker(&m_mutex);
+        while (!m_stop) {
+            m_condition.wait(&m_mutex, m_periodMs);
+            if (m_stop) {
+                break;
+            }
+
+            const qint64 now     = Metrics::nowNs();
+            const qint64 pending = m_pendingSince.load(std::memory_order_acquire);
+
+            if (pending == 0) {
+                if (reported) {
+                    reported = false;
+                    emit stallEnded(m_lastLatencyNs.load(std::memory_order_relaxed) / 1000000);
+                }
+
+                m_pendingSince.store(now, std::memory_order_release);
+                QMetaObject::invokeMethod(this, [this]() { heartbeat(); }, Qt::QueuedConnection);
+            } else if (!reported && now - pending >= m_thresholdNs) {
+                reported = true;
+                m_stalls.add();
+                emit stallDetected((now - pending) / 1000000, captureGuiStack());
+            }
+        }
+    }
+
+    /**
+     * @brief Обработка пульса в потоке GUI
+     */
+    void heartbeat() {
+        const qint64 posted  = m_pendingSince.load(std::memory_order_acquire);
+        const qint64 latency = Metrics::nowNs() - posted;
+        m_heartbeatLatency.record(static_cast<quint64>(latency));
+        m_lastLatencyNs.store(latency, std::memory_order_relaxed);
+        m_pendingSince.store(0, std::memory_order_release);
+    }
+
+#if defined(STALL_WATCHDOG_BACKTRACE)
+    //! Сигнал для снятия стека, не используется Qt и приложением
+    static int stackSignal() { return SIGRTMIN + 3; }
+
+    /**
+     * @brief Обработчик сигнала в потоке GUI
+     * @details Только запись адресов в статический буфер; backtrace()
+     * заранее вызывается в installSignalHandler(), чтобы libgcc была
+     * загружена и в обработчике не было выделения памяти
+     */
+    static void onStackSignal(int) {
+        const int savedErrno = errno;
+        s_depth = backtrace(s_frames.data(), MAX_FRAMES);
+        s_captured.store(true, std::memory_order_release);
+        errno = savedErrno;
+    }
+
+    static void installSignalHandler() {
+        static std::once_flag once;
+        std::call_once(once, []() {
+            void *warmup[1];
+            backtrace(warmup, 1);
+
+            struct sigaction action = {};
+            action.sa_handler = &StallWatchdog::onStackSignal;
+            action.sa_flags   = SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            sigaction(stackSignal(), &action, nullptr);
+        });
+    }
+
+    /**
+     * @brief Снятие стека потока GUI
+     * @details Ждёт ответа обработчика не дольше CAPTURE_TIMEOUT мс
+     */
+    QStringList captureGuiStack() {
+        static constexpr int CAPTURE_TIMEOUT = 100;
+
+        s_captured.store(false, std::memory_order_release);
+        if (pthread_kill(m_guiThread, stackSignal()) != 0) {
+            return {};
+        }
+
+        for (int waited = 0; !s_captured.load(std::memory_order_acquire); ++waited) {
+            if (waited >= CAPTURE_TIMEOUT) {
+                return { "<stack capture timed out>" };
+            }
+            QThread::msleep(1);
+        }
+
+        QStringList stack;
+        char **symbols = backtrace_symbols(s_frames.data(), s_depth);
+        if (!symbols) {
+            return stack;
+        }
+        // Первые кадры - обработчик сигнала и трамплин ядра
+        for (int i = 2; i < s_depth; ++i) {
+            stack.append(demangle(symbols[i]));
+        }
+        std::free(symbols);
+        return stack;
+    }
+
+    /**
+     * @brief Строка backtrace_symbols с расшифрованным именем функции
+     * @details Формат строки: "файл(имя+смещение) [адрес]"
+     */
+    static QString demangle(const char *symbol) {
+        const QByteArray line(symbol);
+        const qsizetype open = line.indexOf('(');
+        const qsizetype plus = line.indexOf('+', open);
+        if (open < 0 || plus <= open + 1) {
+            return QString::fromLocal8Bit(line);
+        }
+
+        const QByteArray mangled = line.mid(open + 1, plus - open - 1);
+        int status = 0;
+        char *name = abi::__cxa_demangle(mangled.constData(), nullptr, nullptr, &status);
+        if (status != 0 || !name) {
+            return QString::fromLocal8Bit(line);
+        }
+
+        const QString result = QString::fromLocal8Bit(line.left(open + 1)) +
+                               QString::fromLocal8Bit(name) +
+                               QString::fromLocal8Bit(line.mid(plus));
+        std::free(name);
+        return result;
+    }
+
+    inline static std::array<void *, MAX_FRAMES> s_frames{};      //!< Адреса стека потока GUI
+    inline static int                            s_depth = 0;     //!< Глубина снятого стека
+    inline static std::atomic<bool>              s_captured{false}; //!< Стек снят
+
+    pthread_t m_guiThread; //!< Отслеживаемый поток
+#else
+    QStringList captureGuiStack() { return {}; }
+#endif
+
+    Metrics::Histogram &m_heartbeatLatency; //!< Задержка обработки пульса
+    Metrics::Counter   &m_stalls;           //!< Количество зависаний
+
+    std::unique_ptr<QThread> m_thread;    //!< Поток сторожа
+    QMutex                   m_mutex;     //!< Защита флага остановки
+    QWaitCondition           m_condition; //!< Пробуждение при остановке
+    bool                     m_stop = false;
+
+    qint64 m_thresholdNs = 0; //!< Порог зависания, нс
+    int    m_periodMs    = 0; //!< Период пульса, мс
+
+    std::atomic<qint64> m_pendingSince{0};  //!< Время отправки необработанного пульса, 0 - нет
+    std::atomic<qint64> m_lastLatencyNs{0}; //!< Задержка последнего обработанного пульса
+};
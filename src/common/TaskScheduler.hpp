@@ -0,0 +1,539 @@
+#pragma once
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ThreadTopology.hpp"
+#include "TimerWheel.hpp"
+
+/**
+ * @brief Планировщик периодических и однократных задач
+ * @details Состоит из двух частей:
+ *  - поток таймера с иерархическим колесом таймеров (шаг 1 мс,
+ *    уровни 256 x 64 x 64 слотов). Поток спит до ближайшего срабатывания
+ *    по абсолютному времени, поэтому периодические задачи не накапливают
+ *    дрейф, а постановка и снятие таймера стоят O(1);
+ *  - пул рабочих потоков по числу ядер. У каждого рабочего свои очереди
+ *    по классам приоритета; свободный рабочий сначала берёт задачу из
+ *    своей очереди, затем крадёт из хвоста очередей соседей, всегда
+ *    начиная с более высокого приоритета.
+ * Для каждой задачи собирается статистика: число запусков, время
+ * выполнения, опоздание запуска и число перегрузок (задача не успела
+ * завершиться к следующему периоду - такой запуск пропускается).
+ * Глобальный пул QtConcurrent не используется, поэтому долгие задачи
+ * логгера и обработчика сообщений не влияют на задачи планировщика.
+ */
+class TaskScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    using TaskId = quint64;
+    using Clock  = std::chrono::steady_clock;
+
+    /**
+     * @brief Классы приоритета задач
+     */
+    enum Priority {
+        High,   //!< Контуры управления, сбор данных
+        Normal, //!< Обычная фоновая работа
+        Low,    //!< Обслуживание: сжатие, очистка, снимки
+        PriorityCount
+    };
+    Q_ENUM(Priority)
+
+    /**
+     * @brief Статистика выполнения задачи
+     */
+    struct TaskStats {
+        TaskId   id          = 0;
+        QString  name;              //!< Имя задачи
+        Priority priority    = Normal;
+        qint64   periodUs    = 0;   //!< Период, 0 - однократная задача
+        quint64  runs        = 0;   //!< Количество запусков
+        quint64  overruns    = 0;   //!< Пропущенные из-за перегрузки запуски
+        qint64   lastRunUs   = 0;   //!< Длительность последнего запуска
+        qint64   maxRunUs    = 0;   //!< Максимальная длительность
+        qint64   meanRunUs   = 0;   //!< Средняя длительность
+        qint64   maxLateUs   = 0;   //!< Максимальное опоздание запуска
+    };
+
+    /**
+     * @brief Конструктор планировщика
+     * @param workers Количество рабочих потоков, 0 - по числу ядер
+     */
+    explicit TaskScheduler(int workers = 0, QObject *parent = nullptr)
+        : QObject(parent),
+          m_epoch(Clock::now()) {
+        const int count = (workers > 0) ? workers : std::max(QThread::idealThreadCount(), 1);
+        for (int i = 0; i < count; ++i) {
+            m_workers.push_back(std::make_unique<Worker>());
+        }
+    }
+
+    ~TaskScheduler() { stop(); }
+
+    /**
+     * @brief Запуск потока таймера и рабочих потоков
+     */
+    void start() {
+        if (m_running.exchange(true)) {
+            return;
+        }
+        m_stop.store(false);
+        m_wheel.reset(currentTick());
+
+        for (std::size_t i = 0; i < m_workers.size(); ++i) {
+            auto &worker = m_workers[i];
+            worker->thread.reset(QThread::create([this, i]() { workerLoop(i); }));
+            worker->thread->setObjectName(QString("sched-worker-%1").arg(i));
+            worker->thread->start();
+        }
+
+        m_timerThread.reset(QThread::create([this]() { timerLoop(); }));
+        m_timerThread->setObjectName("sched-timer");
+        m_timerThread->start(QThread::TimeCriticalPriority);
+    }
+
+    /**
+     * @brief Остановка планировщика с ожиданием текущих задач
+     * @details Задачи, ещё не начавшие выполнение, отбрасываются.
+     * Повторный запуск после остановки не предусмотрен
+     */
+    void stop() {
+        if (!m_running.exchange(false)) {
+            return;
+        }
+        {
+            QMutexLocker locker(&m_timerMutex);
+            m_stop.store(true);
+            m_timerCondition.wakeAll();
+        }
+        {
+            QMutexLocker locker(&m_idleMutex);
+            m_idleCondition.wakeAll();
+        }
+
+        m_timerThread->wait();
+        for (auto &worker : m_workers) {
+            worker->thread->wait();
+            QMutexLocker locker(&worker->mutex);
+            for (auto &queue : worker->queues) {
+                queue.clear();
+            }
+        }
+        m_pending.store(0);
+    }
+
+    /**
+     * @brief Постановка периодической задачи
+     * @param name Имя задачи для статистики
+     * @param period Период, округляется вверх до 1 мс
+     * @param fn Функция задачи, выполняется в рабочем потоке
+     * @param priority Класс приоритета
+     * @return Идентификатор задачи для cancel()
+     */
+    TaskId schedulePeriodic(const QString &name, std::chrono::microseconds period,
+                            std::function<void()> fn, Priority priority = Normal) {
+        return addTask(name, period, period, std::move(fn), priority);
+    }
+
+    /**
+     * @brief Постановка однократной задачи с задержкой
+     * @param name Имя задачи для статистики
+     * @param delay Задержка перед запуском
+     * @param fn Функция задачи, выполняется в рабочем потоке
+     * @param priority Класс приоритета
+     * @return Идентификатор задачи для cancel()
+     */
+    TaskId scheduleOnce(const QString &name, std::chrono::microseconds delay,
+                        std::function<void()> fn, Priority priority = Normal) {
+        return addTask(name, delay, std::chrono::microseconds(0), std::move(fn), priority);
+    }
+
+    /**
+     * @brief Немедленная отправка функции в пул без таймера и статистики
+     */
+    void post(std::function<void()> fn, Priority priority = Normal) {
+        auto task = std::make_shared<Task>();
+        task->fn       = std::move(fn);
+        task->priority = priority;
+        task->oneShot  = true;
+        dispatch(task, Clock::now());
+    }
+
+    /**
+     * @brief Снятие задачи
+     * @return true, если задача была найдена
+     * @details Уже выполняющийся запуск завершится штатно
+     */
+    bool cancel(TaskId id) {
+        QMutexLocker locker(&m_tasksMutex);
+        auto it = m_tasks.find(id);
+        if (it == m_tasks.end()) {
+            return false;
+        }
+        it.value()->cancelled.store(true);
+        m_tasks.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief Снятие задачи с ожиданием её текущего запуска
+     * @return true, если задача была найдена
+     * @details После возврата функция задачи больше не выполняется, поэтому
+     * владелец может разрушить объекты, которые она использует. Нельзя
+     * вызывать из самой задачи. Однократная задача после срабатывания уже
+     * снята и не ожидается
+     */
+    bool cancelAndWait(TaskId id) {
+        TaskPtr task;
+        {
+            QMutexLocker locker(&m_tasksMutex);
+            auto it = m_tasks.find(id);
+            if (it == m_tasks.end()) {
+                return false;
+            }
+            task = it.value();
+            task->cancelled.store(true);
+            m_tasks.erase(it);
+        }
+
+        // Запуск, взятый в работу до снятия, завершится штатно;
+        // задание, ещё стоящее в очереди, увидит cancelled и сбросит флаг
+        while (task->running.load()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Снимок статистики всех задач
+     */
+    QList<TaskStats> stats() const {
+        QList<TaskStats> result;
+        QMutexLocker locker(&m_tasksMutex);
+        result.reserve(m_tasks.size());
+
+        for (const auto &task : m_tasks) {
+            TaskStats s;
+            s.id        = task->id;
+            s.name      = task->name;
+            s.priority  = task->priority;
+            s.periodUs  = task->periodTicks * TICK_US;
+            s.runs      = task->runs.load(std::memory_order_relaxed);
+            s.overruns  = task->overruns.load(std::memory_order_relaxed);
+            s.lastRunUs = task->lastRunUs.load(std::memory_order_relaxed);
+            s.maxRunUs  = task->maxRunUs.load(std::memory_order_relaxed);
+            s.maxLateUs = task->maxLateUs.load(std::memory_order_relaxed);
+            s.meanRunUs = (s.runs > 0)
+                              ? task->totalRunUs.load(std::memory_order_relaxed) / static_cast<qint64>(s.runs)
+                              : 0;
+            result.append(s);
+        }
+        return result;
+    }
+
+    int workerCount() const { return static_cast<int>(m_workers.size()); }
+
+private:
+    static constexpr qint64 TICK_US = 1000; //!< Шаг колеса таймеров
+
+    /**
+     * @brief Задача планировщика
+     */
+    struct Task {
+        TaskId                id = 0;
+        QString               name;
+        Priority              priority    = Normal;
+        qint64                periodTicks = 0;
+        bool                  oneShot     = false;
+        std::function<void()> fn;
+
+        std::atomic<bool>    cancelled{false};
+        std::atomic<bool>    running{false};
+        std::atomic<quint64> runs{0};
+        std::atomic<quint64> overruns{0};
+        std::atomic<qint64>  lastRunUs{0};
+        std::atomic<qint64>  maxRunUs{0};
+        std::atomic<qint64>  totalRunUs{0};
+        std::atomic<qint64>  maxLateUs{0};
+    };
+    using TaskPtr = std::shared_ptr<Task>;
+
+    /**
+     * @brief Задание в очереди рабочего потока
+     */
+    struct Job {
+        TaskPtr           task;
+        Clock::time_point due;
+    };
+
+    /**
+     * @brief Рабочий поток с собственными очередями по приоритетам
+     */
+    struct Worker {
+        std::unique_ptr<QThread>                   thread;
+        QMutex                                     mutex;
+        std::array<std::deque<Job>, PriorityCount> queues;
+    };
+
+    using Wheel = TimerWheel<TaskPtr>;
+
+    TaskId addTask(const QString &name, std::chrono::microseconds delay,
+                   std::chrono::microseconds period, std::function<void()> fn,
+                   Priority priority) {
+        auto task = std::make_shared<Task>();
+        task->id          = m_nextId.fetch_add(1);
+        task->name        = name;
+        task->priority    = priority;
+        task->fn          = std::move(fn);
+        task->periodTicks = (period.count() > 0) ? std::max<qint64>((period.count() + TICK_US - 1) / TICK_US, 1) : 0;
+        task->oneShot     = (task->periodTicks == 0);
+
+        {
+            QMutexLocker locker(&m_tasksMutex);
+            m_tasks.insert(task->id, task);
+        }
+
+        const qint64 delayTicks = std::max<qint64>((delay.count() + TICK_US - 1) / TICK_US, 1);
+        {
+            QMutexLocker locker(&m_timerMutex);
+            m_incoming.push_back({ task, currentTick() + delayTicks });
+            m_timerCondition.wakeOne();
+        }
+        return task->id;
+    }
+
+    qint64 currentTick() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_epoch).count() / TICK_US;
+    }
+
+    Clock::time_point tickTime(qint64 tick) const {
+        return m_epoch + std::chrono::microseconds(tick * TICK_US);
+    }
+
+    /**
+     * @brief Цикл потока таймера
+     */
+    void timerLoop() {
+        ThreadTopology::Scope topology(ThreadTopology::Acquisition, "sched-timer");
+        std::vector<Wheel::Entry> expired;
+
+        forever {
+            {
+                QMutexLocker locker(&m_timerMutex);
+
+                for (auto &entry : m_incoming) {
+                    m_wheel.insert(std::move(entry));
+                }
+                m_incoming.clear();
+
+                if (m_stop.load()) {
+                    break;
+                }
+
+                if (m_wheel.isEmpty()) {
+                    m_timerCondition.wait(&m_timerMutex);
+                    // За время ожидания колесо могло отстать от часов
+                    m_wheel.reset(currentTick());
+                    continue;
+                }
+
+                const auto wake = tickTime(m_wheel.nextWakeTick());
+                const auto now  = Clock::now();
+                if (wake > now) {
+                    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(wake - now).count();
+                    if (ms > 1) {
+                        // Грубое ожидание с возможностью прерывания новой задачей,
+                        // последнюю миллисекунду добираем точным сном ниже
+                        m_timerCondition.wait(&m_timerMutex, static_cast<unsigned long>(ms - 1));
+                        if (!m_incoming.empty() || m_stop.load()) {
+                            continue;
+                        }
+                    }
+                }
+            }
+
+            const qint64 target = m_wheel.nextWakeTick();
+            std::this_thread::sleep_until(tickTime(target));
+
+            const qint64 now = std::max(currentTick(), target);
+            while (m_wheel.now() < now) {
+                m_wheel.tick(expired);
+            }
+
+            for (auto &entry : expired) {
+                fire(entry);
+            }
+            expired.clear();
+        }
+    }
+
+    /**
+     * @brief Обработка сработавшего таймера
+     */
+    void fire(Wheel::Entry &entry) {
+        TaskPtr &task = entry.payload;
+        if (task->cancelled.load()) {
+            return;
+        }
+
+        if (task->running.load(std::memory_order_acquire)) {
+            task->overruns.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // Запись running и повторное чтение cancelled - seq_cst, как и
+            // запись cancelled и чтение running в cancelAndWait(): хотя бы
+            // одна сторона увидит запись другой, и снятая задача либо не
+            // уйдёт в очередь, либо cancelAndWait() дождётся её запуска
+            task->running.store(true);
+            if (task->cancelled.load()) {
+                task->running.store(false, std::memory_order_release);
+                return;
+            }
+            dispatch(task, tickTime(entry.expiry));
+        }
+
+        if (!task->oneShot) {
+            // Следующий срок отсчитывается от расчётного, а не от фактического времени
+            m_wheel.insert({ task, entry.expiry + task->periodTicks });
+        } else {
+            QMutexLocker locker(&m_tasksMutex);
+            m_tasks.remove(task->id);
+        }
+    }
+
+    /**
+     * @brief Передача задачи в очередь рабочего потока
+     */
+    void dispatch(const TaskPtr &task, Clock::time_point due) {
+        const std::size_t index = m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+        {
+            QMutexLocker locker(&m_workers[index]->mutex);
+            m_workers[index]->queues[task->priority].push_back({ task, due });
+        }
+        m_pending.fetch_add(1, std::memory_order_release);
+
+        QMutexLocker locker(&m_idleMutex);
+        m_idleCondition.wakeOne();
+    }
+
+    /**
+     * @brief Поиск задания: своя очередь, затем кража у соседей
+     */
+    bool takeJob(std::size_t self, Job &job) {
+        for (int prio = High; prio < PriorityCount; ++prio) {
+            {
+                Worker &own = *m_workers[self];
+                QMutexLocker locker(&own.mutex);
+                auto &queue = own.queues[prio];
+                if (!queue.empty()) {
+                    job = std::move(queue.front());
+                    queue.pop_front();
+                    return true;
+                }
+            }
+
+            for (std::size_t k = 1; k < m_workers.size(); ++k) {
+                Worker &victim = *m_workers[(self + k) % m_workers.size()];
+                QMutexLocker locker(&victim.mutex);
+                auto &queue = victim.queues[prio];
+                if (!queue.empty()) {
+                    job = std::move(queue.back());
+                    queue.pop_back();
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Цикл рабочего потока
+     */
+    void workerLoop(std::size_t self) {
+        ThreadTopology::Scope topology(ThreadTopology::Background, QString("sched-worker-%1").arg(self));
+
+        forever {
+            Job job;
+            if (takeJob(self, job)) {
+                m_pending.fetch_sub(1, std::memory_order_relaxed);
+                run(job);
+                continue;
+            }
+
+            QMutexLocker locker(&m_idleMutex);
+            if (m_stop.load()) {
+                break;
+            }
+            if (m_pending.load(std::memory_order_acquire) == 0) {
+                m_idleCondition.wait(&m_idleMutex);
+            }
+        }
+    }
+
+    /**
+     * @brief Выполнение задания со сбором статистики
+     */
+    void run(Job &job) {
+        Task &task = *job.task;
+        if (task.cancelled.load()) {
+            task.running.store(false, std::memory_order_release);
+            return;
+        }
+
+        const auto started = Clock::now();
+        task.fn();
+        const auto finished = Clock::now();
+
+        const qint64 runUs  = std::chrono::duration_cast<std::chrono::microseconds>(finished - started).count();
+        const qint64 lateUs = std::chrono::duration_cast<std::chrono::microseconds>(started - job.due).count();
+
+        task.runs.fetch_add(1, std::memory_order_relaxed);
+        task.lastRunUs.store(runUs, std::memory_order_relaxed);
+        task.totalRunUs.fetch_add(runUs, std::memory_order_relaxed);
+        updateMax(task.maxRunUs, runUs);
+        updateMax(task.maxLateUs, lateUs);
+
+        task.running.store(false, std::memory_order_release);
+    }
+
+    static void updateMax(std::atomic<qint64> &target, qint64 value) {
+        qint64 current = target.load(std::memory_order_relaxed);
+        while (value > current &&
+               !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_workers;         //!< Рабочие потоки
+    std::unique_ptr<QThread>             m_timerThread;     //!< Поток колеса таймеров
+    Wheel                                m_wheel;           //!< Колесо таймеров (поток таймера)
+    std::vector<Wheel::Entry>            m_incoming;        //!< Новые таймеры для колеса
+    QMutex                               m_timerMutex;      //!< Защита m_incoming
+    QWaitCondition                       m_timerCondition;  //!< Пробуждение потока таймера
+    QMutex                               m_idleMutex;       //!< Мьютекс ожидания рабочих
+    QWaitCondition                       m_idleCondition;   //!< Пробуждение рабочих
+    QHash<TaskId, TaskPtr>               m_tasks;           //!< Активные задачи
+    mutable QMutex                       m_tasksMutex;      //!< Защита m_tasks
+    Clock::time_point                    m_epoch;           //!< Нулевой тик
+    std::atomic<TaskId>                  m_nextId{1};       //!< Следующий идентификатор
+    std::atomic<std::size_t>             m_nextWorker{0};   //!< Очередной рабочий для раздачи
+    std::atomic<int>                     m_pending{0};      //!< Заданий в очередях
+    std::atomic<bool>                    m_running{false};  //!< Планировщик запущен
+    std::atomic<bool>                    m_stop{false};     //!< Флаг остановки потоков
+};
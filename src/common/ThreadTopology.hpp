@@ -0,0 +1,355 @@
+#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QThread>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#if defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "structures.hpp"
+
+/**
+ * @brief Имена, ядра и классы планирования потоков по ролям
+ * @details Долгоживущие потоки приложения регистрируются с ролью
+ * (объект Scope в начале функции потока). Регистрация даёт потоку имя
+ * в системе (top -H, perf, /proc/<pid>/task) и, если настройки уже
+ * заданы, сразу применяет настройки роли. configure() применяет
+ * настройки к уже зарегистрированным потокам: логгер, например,
+ * запускается раньше чтения config.json.
+ *
+ * Роли:
+ *  - Render - поток GUI и поток отрисовки Qt Quick;
+ *  - Acquisition - сбор данных и таймер планировщика;
+ *  - Logging - запись и отправка лога;
+ *  - Background - рабочие планировщика, сжатие логов.
+ *
+ * Потоки наследуют ядра и приоритет создавшего потока, поэтому
+ * ядра роли без списка cpus сбрасываются на все ядра процесса, а
+ * унаследованный SCHED_FIFO - на обычное планирование. Классы
+ * SCHED_IDLE и SCHED_BATCH, выбранные самим потоком, не меняются.
+ *
+ * Главный поток создаёт незарегистрированные потоки (пулы QML и
+ * QThreadPool, загрузчики), и они наследуют его настройки. Поэтому
+ * configure() главный поток не трогает: его настройки применяет
+ * applyMainThread(), вызванный после создания движка QML, а
+ * SCHED_FIFO главному потоку не назначается никогда - его унаследовали
+ * бы и потоки пулов, созданные позже.
+ *
+ * Ядра, nice и SCHED_FIFO применяются только на Linux; отказ (например,
+ * SCHED_FIFO и отрицательный nice без CAP_SYS_NICE) не мешает работе
+ * и виден в отчёте report().
+ */
+class ThreadTopology
+{
+public:
+    /**
+     * @brief Роли потоков
+     */
+    enum Role {
+        Render,
+        Acquisition,
+        Logging,
+        Background,
+        RoleCount
+    };
+
+    /**
+     * @brief Регистрация текущего потока на время жизни объекта
+     */
+    class Scope {
+    public:
+        /**
+         * @param role Роль потока
+         * @param name Имя потока, в системе обрезается до 15 байт
+         * @param rename false - не переименовывать поток в системе
+         * (главный поток: его имя - имя процесса)
+         */
+        Scope(Role role, const QString &name, bool rename = true) {
+            ThreadTopology::instance().enter(role, name, rename);
+        }
+        ~Scope() { ThreadTopology::instance().leave(); }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    static ThreadTopology &instance() {
+        static ThreadTopology topology;
+        return topology;
+    }
+
+    ThreadTopology(const ThreadTopology &) = delete;
+    ThreadTopology &operator=(const ThreadTopology &) = delete;
+
+    /**
+     * @brief Регистрация текущего потока
+     * @details Повторная регистрация потока заменяет роль и имя
+     */
+    void enter(Role role, const QString &name, bool rename = true) {
+        const qint64 tid = currentTid();
+
+#if defined(Q_OS_LINUX)
+        if (rename) {
+            pthread_setname_np(pthread_self(), name.toUtf8().left(15).constData());
+        }
+#else
+        Q_UNUSED(rename)
+#endif
+
+        QMutexLocker locker(&m_mutex);
+        ThreadEntry *entry = find(tid);
+        if (!entry) {
+            m_threads.append(ThreadEntry{});
+            entry = &m_threads.last();
+        }
+        entry->tid   = tid;
+        entry->role  = role;
+        entry->name  = name;
+        entry->error.clear();
+
+        if (m_configured && (!isMainThread(tid) || m_mainApplied)) {
+            apply(*entry);
+        }
+    }
+
+    /**
+     * @brief Снятие регистрации текущего потока
+     */
+    void leave() {
+        const qint64 tid = currentTid();
+
+        QMutexLocker locker(&m_mutex);
+        m_threads.removeIf([tid](const ThreadEntry &entry) { return entry.tid == tid; });
+    }
+
+    /**
+     * @brief Применение настроек ко всем зарегистрированным и будущим потокам
+     * @details Вызывается один раз, из главного потока. Сам главный
+     * поток получает настройки только в applyMainThread()
+     */
+    void configure(const ThreadSettings &settings) {
+        QMutexLocker locker(&m_mutex);
+        m_roles = { settings.render, settings.acquisition, settings.logging, settings.background };
+
+#if defined(Q_OS_LINUX)
+        // Ядра процесса до закрепления главного потока
+        if (!m_configured) {
+            CPU_ZERO(&m_processCpus);
+            sched_getaffinity(0, sizeof(m_processCpus), &m_processCpus);
+        }
+#endif
+        m_configured = true;
+
+        for (ThreadEntry &entry : m_threads) {
+            if (isMainThread(entry.tid) && !m_mainApplied) {
+                continue;
+            }
+            entry.error.clear();
+            apply(entry);
+        }
+    }
+
+    /**
+     * @brief Применение настроек роли к главному потоку
+     * @details Вызывается после engine.load(): потоки, которые движок
+     * QML создаёт при загрузке, к этому времени уже запущены с
+     * настройками процесса по умолчанию. До configure() только
+     * запоминает, что главный поток можно настраивать
+     */
+    void applyMainThread() {
+        QMutexLocker locker(&m_mutex);
+        m_mainApplied = true;
+        if (!m_configured) {
+            return;
+        }
+        for (ThreadEntry &entry : m_threads) {
+            if (isMainThread(entry.tid)) {
+                entry.error.clear();
+                apply(entry);
+            }
+        }
+    }
+
+    /**
+     * @brief Действующие настройки зарегистрированных потоков
+     * @return По строке на поток, значения прочитаны у системы
+     */
+    QStringList report() const {
+        QMutexLocker locker(&m_mutex);
+        QStringList lines;
+
+        for (const ThreadEntry &entry : m_threads) {
+            QString line = QString("%1 [%2] tid %3: %4")
+                               .arg(entry.name, roleName(entry.role))
+                               .arg(entry.tid)
+                               .arg(effective(entry.tid));
+            if (!entry.error.isEmpty()) {
+                line += QString(" (%1)").arg(entry.error);
+            }
+            lines << line;
+        }
+        return lines;
+    }
+
+    static QString roleName(Role role) {
+        switch (role) {
+        case Render:      return "render";
+        case Acquisition: return "acquisition";
+        case Logging:     return "logging";
+        case Background:  return "background";
+        default:          return "unknown";
+        }
+    }
+
+private:
+    ThreadTopology() = default;
+
+    struct ThreadEntry {
+        qint64  tid  = 0;
+        Role    role = Background;
+        QString name;
+        QString error; //!< Что не удалось применить
+    };
+
+    static qint64 currentTid() {
+#if defined(Q_OS_LINUX)
+        return static_cast<qint64>(::syscall(SYS_gettid));
+#else
+        return reinterpret_cast<qint64>(QThread::currentThreadId());
+#endif
+    }
+
+    static bool isMainThread(qint64 tid) {
+#if defined(Q_OS_LINUX)
+        return tid == static_cast<qint64>(::getpid());
+#else
+        Q_UNUSED(tid)
+        return false;
+#endif
+    }
+
+    ThreadEntry *find(qint64 tid) {
+        for (ThreadEntry &entry : m_threads) {
+            if (entry.tid == tid) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Применение настроек роли к потоку по tid
+     */
+    void apply(ThreadEntry &entry) {
+#if defined(Q_OS_LINUX)
+        const ThreadRoleSettings &settings = m_roles[entry.role];
+        const pid_t tid = static_cast<pid_t>(entry.tid);
+        QStringList errors;
+
+        cpu_set_t cpus;
+        if (settings.cpus.isEmpty()) {
+            cpus = m_processCpus;
+        } else {
+            CPU_ZERO(&cpus);
+            for (int cpu : settings.cpus) {
+                if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                    CPU_SET(cpu, &cpus);
+                }
+            }
+        }
+        if (sched_setaffinity(tid, sizeof(cpus), &cpus) != 0) {
+            errors << QString("affinity: %1").arg(std::strerror(errno));
+        }
+
+        const int policy = sched_getscheduler(tid);
+        if (settings.fifoPriority > 0 && isMainThread(entry.tid)) {
+            errors << QString("SCHED_FIFO %1: not applied to the main thread, "
+                              "threads it creates would inherit it").arg(settings.fifoPriority);
+        } else if (settings.fifoPriority > 0) {
+            sched_param param{};
+            param.sched_priority = settings.fifoPriority;
+            if (sched_setscheduler(tid, SCHED_FIFO, &param) != 0) {
+                errors << QString("SCHED_FIFO %1: %2").arg(settings.fifoPriority).arg(std::strerror(errno));
+            }
+        } else if (policy == SCHED_FIFO || policy == SCHED_RR) {
+            sched_param param{};
+            sched_setscheduler(tid, SCHED_OTHER, &param);
+        }
+
+        // nice действует на поток, если передать tid
+        errno = 0;
+        const int currentNice = getpriority(PRIO_PROCESS, static_cast<id_t>(tid));
+        if (errno == 0 && currentNice != settings.nice &&
+            setpriority(PRIO_PROCESS, static_cast<id_t>(tid), settings.nice) != 0) {
+            errors << QString("nice %1: %2").arg(settings.nice).arg(std::strerror(errno));
+        }
+
+        entry.error = errors.join(", ");
+#else
+        Q_UNUSED(entry)
+#endif
+    }
+
+    /**
+     * @brief Действующие ядра, класс планирования и nice потока
+     */
+    static QString effective(qint64 tid) {
+#if defined(Q_OS_LINUX)
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        if (sched_getaffinity(static_cast<pid_t>(tid), sizeof(cpus), &cpus) != 0) {
+            return QString("unavailable: %1").arg(std::strerror(errno));
+        }
+
+        QStringList cpuList;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &cpus)) {
+                cpuList << QString::number(cpu);
+            }
+        }
+
+        QString policy;
+        sched_param param{};
+        sched_getparam(static_cast<pid_t>(tid), &param);
+        switch (sched_getscheduler(static_cast<pid_t>(tid))) {
+        case SCHED_FIFO:  policy = QString("SCHED_FIFO %1").arg(param.sched_priority); break;
+        case SCHED_RR:    policy = QString("SCHED_RR %1").arg(param.sched_priority);   break;
+        case SCHED_BATCH: policy = "SCHED_BATCH"; break;
+        case SCHED_IDLE:  policy = "SCHED_IDLE";  break;
+        default:          policy = "SCHED_OTHER"; break;
+        }
+
+        errno = 0;
+        const int nice = getpriority(PRIO_PROCESS, static_cast<id_t>(tid));
+        return QString("cpus %1, %2, nice %3")
+            .arg(cpuList.join(','), policy)
+            .arg(errno == 0 ? QString::number(nice) : QString("?"));
+#else
+        Q_UNUSED(tid)
+        return QString("not applied on this platform");
+#endif
+    }
+
+    mutable QMutex     m_mutex;
+    QList<ThreadEntry> m_threads;            //!< Зарегистрированные потоки
+    bool               m_configured = false; //!< configure() уже вызван
+    bool               m_mainApplied = false; //!< Главный поток можно настраивать (applyMainThread())
+
+    std::array<ThreadRoleSettings, RoleCount> m_roles; //!< Настройки по ролям
+
+#if defined(Q_OS_LINUX)
+    cpu_set_t          m_processCpus;        //!< Ядра процесса на момент configure()
+#endif
+};
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Иерархическое колесо таймеров
+ * @details Уровень 0 - 256 слотов по 1 тику, уровни 1 и 2 - по 64 слота,
+ * каждый слот покрывает весь предыдущий уровень. При переходе младшего
+ * уровня через ноль слот старшего уровня раскладывается вниз.
+ * Срабатывания дальше горизонта колеса (~17.9 мин при тике 1 мс)
+ * ставятся в последний слот и перекладываются до наступления срока.
+ *
+ * Срок записи (expiry) колесо не меняет: запись, срок которой наступил
+ * при перекладке, сразу попадает в сработавшие, а просроченная при
+ * постановке - в ближайший тик. Поэтому периодический таймер,
+ * переставленный на expiry + период, не накапливает дрейф.
+ *
+ * Заголовок не зависит от Qt.
+ */
+template <typename Payload>
+class TimerWheel {
+public:
+    struct Entry {
+        Payload      payload;
+        std::int64_t expiry;
+    };
+
+    void reset(std::int64_t now) {
+        m_now = now;
+        for (auto &slot : m_level0) slot.clear();
+        for (auto &slot : m_level1) slot.clear();
+        for (auto &slot : m_level2) slot.clear();
+        m_size = 0;
+    }
+
+    bool isEmpty() const { return m_size == 0; }
+    std::size_t size() const { return m_size; }
+    std::int64_t now() const { return m_now; }
+
+    /**
+     * @brief Постановка записи
+     * @details Запись со сроком не позже now() сработает на следующем тике
+     */
+    void insert(Entry entry) {
+        ++m_size;
+        if (entry.expiry - m_now <= 0) {
+            m_level0[(m_now + 1) & L0_MASK].push_back(std::move(entry));
+        } else {
+            place(std::move(entry));
+        }
+    }
+
+    /**
+     * @brief Продвижение колеса на один тик
+     * @param expired Сработавшие записи добавляются сюда
+     */
+    void tick(std::vector<Entry> &expired) {
+        ++m_now;
+
+        if ((m_now & L0_MASK) == 0) {
+            cascade(m_level1[(m_now >> L0_BITS) & L1_MASK], expired);
+            if (((m_now >> L0_BITS) & L1_MASK) == 0) {
+                cascade(m_level2[(m_now >> (L0_BITS + L1_BITS)) & L2_MASK], expired);
+            }
+        }
+
+        auto &slot = m_level0[m_now & L0_MASK];
+        for (auto &entry : slot) {
+            expired.push_back(std::move(entry));
+        }
+        m_size -= slot.size();
+        slot.clear();
+    }
+
+    /**
+     * @brief Ближайший тик, на котором колесу нужно проснуться
+     * @details Либо срабатывание на уровне 0, либо граница
+     * перекладки старших уровней - что раньше
+     */
+    std::int64_t nextWakeTick() const {
+        const std::int64_t boundary = (m_now | L0_MASK) + 1;
+        for (std::int64_t t = m_now + 1; t < boundary; ++t) {
+            if (!m_level0[t & L0_MASK].empty()) {
+                return t;
+            }
+        }
+        return boundary;
+    }
+
+private:
+    static constexpr int          L0_BITS = 8;
+    static constexpr int          L1_BITS = 6;
+    static constexpr int          L2_BITS = 6;
+    static constexpr std::int64_t L0_MASK = (1 << L0_BITS) - 1;
+    static constexpr std::int64_t L1_MASK = (1 << L1_BITS) - 1;
+    static constexpr std::int64_t L2_MASK = (1 << L2_BITS) - 1;
+
+    /**
+     * @brief Раскладка записи со сроком позже now()
+     */
+    void place(Entry entry) {
+        const std::int64_t delta = entry.expiry - m_now;
+
+        if (delta <= L0_MASK) {
+            m_level0[entry.expiry & L0_MASK].push_back(std::move(entry));
+        } else if (delta < (std::int64_t(1) << (L0_BITS + L1_BITS))) {
+            m_level1[(entry.expiry >> L0_BITS) & L1_MASK].push_back(std::move(entry));
+        } else {
+            const std::int64_t horizon = (std::int64_t(1) << (L0_BITS + L1_BITS + L2_BITS)) - 1;
+            const std::int64_t at = m_now + std::min(delta, horizon);
+            m_level2[(at >> (L0_BITS + L1_BITS)) & L2_MASK].push_back(std::move(entry));
+        }
+    }
+
+    void cascade(std::vector<Entry> &slot, std::vector<Entry> &expired) {
+        std::vector<Entry> entries;
+        entries.swap(slot);
+        for (auto &entry : entries) {
+            if (entry.expiry - m_now <= 0) {
+                // Срок - текущий тик: сразу в сработавшие, срок не переносится
+                expired.push_back(std::move(entry));
+                --m_size;
+            } else {
+                place(std::move(entry));
+            }
+        }
+    }
+
+    std::array<std::vector<Entry>, 1 << L0_BITS> m_level0;
+    std::array<std::vector<Entry>, 1 << L1_BITS> m_level1;
+    std::array<std::vector<Entry>, 1 << L2_BITS> m_level2;
+    std::int64_t m_now  = 0;
+    std::size_t  m_size = 0;
+};
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QCoreApplication>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Трассировка интервалов выполнения в формате Chrome trace-event
+ * @details Интервалы отмечаются макросами TRACE_SCOPE("имя") и
+ * TRACE_INSTANT("имя"). Каждый поток пишет в собственный буфер фиксированного
+ * размера без блокировок; мьютекс берётся только один раз при первой записи
+ * из нового потока. Время - монотонные часы в наносекундах от старта
+ * трассировщика. Результат сохраняется в JSON, который открывается в
+ * chrome://tracing и ui.perfetto.dev.
+ *
+ * Трассировка собирается только при опции CMake QTAPP_ENABLE_TRACING;
+ * без неё макросы раскрываются в пустые выражения и ничего не стоят.
+ * Файл пишется при выходе из приложения (путь из переменной окружения
+ * QTAPP_TRACE_FILE, по умолчанию trace.json) или по запросу через dump().
+ */
+namespace Trace {
+
+    /**
+     * @brief Событие трассировки
+     */
+    struct Event {
+        const char *name;     //!< Имя, строковый литерал
+        const char *category; //!< Категория, строковый литерал
+        qint64      startNs;  //!< Начало от старта трассировщика, нс
+        qint64      durNs;    //!< Длительность, нс; -1 - мгновенное событие
+    };
+
+    /**
+     * @brief Буфер событий одного потока
+     * @details Пишет только поток-владелец, читает dump():
+     * событие публикуется увеличением счётчика с release-семантикой
+     */
+    struct ThreadBuffer {
+        static constexpr std::size_t CAPACITY = 8192;
+
+        std::array<Event, CAPACITY> events;
+        std::atomic<std::size_t>    count{0};
+        std::atomic<quint64>        dropped{0};
+        quint64                     tid = 0;
+        QString                     threadName;
+    };
+
+    /**
+     * @brief Реестр буферов потоков и запись результата
+     */
+    class Tracer {
+    public:
+        static Tracer &instance() {
+            static Tracer tracer;
+            return tracer;
+        }
+
+        Tracer(const Tracer &) = delete;
+        Tracer &operator=(const Tracer &) = delete;
+
+        /**
+         * @brief Монотонное время от старта трассировщика, нс
+         */
+        qint64 nowNs() const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - m_epoch).count();
+        }
+
+        /**
+         * @brief Запись события в буфер текущего потока
+         * @details При переполнении буфера событие отбрасывается
+         * и учитывается в счётчике потерь
+         */
+        void record(const char *name, const char *category, qint64 startNs, qint64 durNs) {
+            ThreadBuffer *buffer = threadBuffer();
+            const std::size_t index = buffer->count.load(std::memory_order_relaxed);
+            if (index >= ThreadBuffer::CAPACITY) {
+                buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            buffer->events[index] = { name, category, startNs, durNs };
+            buffer->count.store(index + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Сохранение собранных событий в файл
+         * @param filePath Путь к файлу JSON
+         * @return true, если файл записан
+         * @details Можно вызывать в любой момент, в том числе
+         * пока другие потоки продолжают писать
+         */
+        bool dump(const QString &filePath) {
+            QFile file(filePath);
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                return false;
+            }
+
+            const qint64 pid = QCoreApplication::applicationPid();
+
+            QByteArray out;
+            out.reserve(1 << 20);
+            out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+            bool first = true;
+            auto separator = [&]() {
+                if (!first) {
+                    out += ",\n";
+                }
+                first = false;
+            };
+
+            QMutexLocker locker(&m_mutex);
+            for (const auto &buffer : m_buffers) {
+                separator();
+                out += QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%1,\"tid\":%2,"
+                               "\"args\":{\"name\":\"%3\"}}")
+                           .arg(pid).arg(buffer->tid).arg(buffer->threadName).toUtf8();
+
+                const std::size_t count = buffer->count.load(std::memory_order_acquire);
+                for (std::size_t i = 0; i < count; ++i) {
+                    const Event &e = buffer->events[i];
+                    separator();
+                    if (e.durNs < 0) {
+                        out += QString("{\"name\":\"%1\",\"cat\":\"%2\",\"ph\":\"i\",\"s\":\"t\","
+                                       "\"ts\":%3,\"pid\":%4,\"tid\":%5}")
+                                   .arg(QLatin1String(e.name), QLatin1String(e.category))
+                                   .arg(e.startNs / 1000.0, 0, 'f', 3)
+                                   .arg(pid).arg(buffer->tid).toUtf8();
+                    } else {
+                        out += QString("{\"name\":\"%1\",\"cat\":\"%2\",\"ph\":\"X\","
+                                       "\"ts\":%3,\"dur\":%4,\"pid\":%5,\"tid\":%6}")
+                                   .arg(QLatin1String(e.name), QLatin1String(e.category))
+                                   .arg(e.startNs / 1000.0, 0, 'f', 3)
+                                   .arg(e.durNs / 1000.0, 0, 'f', 3)
+                                   .arg(pid).arg(buffer->tid).toUtf8();
+                    }
+                }
+
+                const quint64 dropped = buffer->dropped.load(std::memory_order_relaxed);
+                if (dropped > 0) {
+                    separator();
+                    out += QString("{\"name\":\"dropped %1 events\",\"ph\":\"i\",\"s\":\"t\","
+                                   "\"ts\":0,\"pid\":%2,\"tid\":%3}")
+                               .arg(dropped).arg(pid).arg(buffer->tid).toUtf8();
+                }
+            }
+            locker.unlock();
+
+            out += "\n]}\n";
+            return file.write(out) == out.size();
+        }
+
+        /**
+         * @brief Сохранение в файл из QTAPP_TRACE_FILE или trace.json
+         */
+        bool dumpToDefaultFile() {
+            const QString path = qEnvironmentVariable("QTAPP_TRACE_FILE", "trace.json");
+            return dump(path);
+        }
+
+    private:
+        Tracer() : m_epoch(std::chrono::steady_clock::now()) {}
+
+        /**
+         * @brief Буфер текущего потока, создаётся при первом обращении
+         */
+        ThreadBuffer *threadBuffer() {
+            thread_local ThreadBuffer *buffer = nullptr;
+            if (buffer) {
+                return buffer;
+            }
+
+            auto created = std::make_unique<ThreadBuffer>();
+            created->tid = reinterpret_cast<quintptr>(QThread::currentThreadId());
+            created->threadName = QThread::currentThread()->objectName();
+            if (created->threadName.isEmpty()) {
+                created->threadName = QString("thread-%1").arg(created->tid);
+            }
+
+            QMutexLocker locker(&m_mutex);
+            buffer = created.get();
+            // Буферы живут до конца процесса: события завершившихся
+            // потоков тоже попадают в результат
+            m_buffers.push_back(std::move(created));
+            return buffer;
+        }
+
+        const std::chrono::steady_clock::time_point m_epoch;   //!< Нулевая отметка времени
+        QMutex                                      m_mutex;   //!< Защита списка буферов
+        std::vector<std::unique_ptr<ThreadBuffer>>  m_buffers; //!< Буферы всех потоков
+    };
+
+    /**
+     * @brief Интервал от создания до разрушения объекта
+     */
+    class ScopedSpan {
+    public:
+        ScopedSpan(const char *name, const char *category)
+            : m_name(name),
+              m_category(category),
+              m_start(Tracer::instance().nowNs()) {}
+
+        ~ScopedSpan() {
+            Tracer &tracer = Tracer::instance();
+            tracer.record(m_name, m_category, m_start, tracer.nowNs() - m_start);
+        }
+
+        ScopedSpan(const ScopedSpan &) = delete;
+        ScopedSpan &operator=(const ScopedSpan &) = delete;
+
+    private:
+        const char *m_name;
+        const char *m_category;
+        qint64      m_start;
+    };
+}
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#if defined(QTAPP_ENABLE_TRACING)
+    //! Интервал до конца текущей области видимости
+    #define TRACE_SCOPE(name) \
+        Trace::ScopedSpan TRACE_CONCAT(traceSpan_, __LINE__)(name, "app")
+    //! Интервал с указанием категории
+    #define TRACE_SCOPE_CAT(name, category) \
+        Trace::ScopedSpan TRACE_CONCAT(traceSpan_, __LINE__)(name, category)
+    //! Мгновенное событие
+    #define TRACE_INSTANT(name) \
+        Trace::Tracer::instance().record(name, "app", Trace::Tracer::instance().nowNs(), -1)
+    //! Начало интервала, который нельзя оформить областью видимости
+    #define TRACE_BEGIN(id) \
+        const qint64 TRACE_CONCAT(traceStart_, id) = Trace::Tracer::instance().nowNs()
+    //! Конец интервала, начатого TRACE_BEGIN с тем же id
+    #define TRACE_END(id, name) \
+        Trace::Tracer::instance().record(name, "app", TRACE_CONCAT(traceStart_, id), \
+                                         Trace::Tracer::instance().nowNs() - TRACE_CONCAT(traceStart_, id))
+#else
+    #define TRACE_SCOPE(name)               ((void)0)
+    #define TRACE_SCOPE_CAT(name, category) ((void)0)
+    #define TRACE_INSTANT(name)             ((void)0)
+    #define TRACE_BEGIN(id)                 ((void)0)
+    #define TRACE_END(id, name)             ((void)0)
+#endif
@@ -4,6 +4,9 @@
 #include <QObject>
 #include <QString>
 #include <QJsonObject>
+#include <QJsonArray>
+#include <QList>
+#include <QVariantMap>
 
 
 namespace Logic {
@@ -43,31 +46,6 @@ namespace Logger {
 using namespace Logger;
 using namespace Logic;
 
-/**
- * @brief Структура для хранения сообщений для QML
- */
-struct QmlDialogMessage {
-    Q_GADGET
-
-public:
-    Q_PROPERTY(QString     text  MEMBER text )
-    Q_PROPERTY(MessageType type  MEMBER type )
-
-    QString     text; //!< Текст сообщения
-    MessageType type; //!< Тип сообщения
-
-    bool operator == (const QmlDialogMessage &other) const {
-        return text == other.text  &&
-               type == other.type;
-    }
-
-    bool operator != (const QmlDialogMessage &other) const {
-        return !(*this == other);
-    }
-};
-
-Q_DECLARE_METATYPE(QmlDialogMessage)
-
 /**
  * @brief Структура для настроек приложения
  */
@@ -129,3 +107,179 @@ public:
         return !(*this == other);
     }
 };
+
+/**
+ * @brief Структура для настроек диагностики
+ * @details Секция необязательная: при её отсутствии
+ * используются значения по умолчанию
+ */
+struct DiagnosticsSettings {
+    Q_GADGET
+
+public:
+    Q_PROPERTY(int     metricsPort         MEMBER metricsPort)
+    Q_PROPERTY(QString metricsSocket       MEMBER metricsSocket)
+    Q_PROPERTY(QString metricsSnapshotFile MEMBER metricsSnapshotFile)
+    Q_PROPERTY(int     snapshotIntervalSec MEMBER snapshotIntervalSec)
+    Q_PROPERTY(int     stallThresholdMs    MEMBER stallThresholdMs)
+    Q_PROPERTY(QString liveChannel         MEMBER liveChannel)
+    Q_PROPERTY(int     liveSlots           MEMBER liveSlots)
+    Q_PROPERTY(QString logCollectorSocket  MEMBER logCollectorSocket)
+    Q_PROPERTY(QString logSpoolDir         MEMBER logSpoolDir)
+    Q_PROPERTY(int     logSpoolLimitMb     MEMBER logSpoolLimitMb)
+    Q_PROPERTY(int     logBatchKb          MEMBER logBatchKb)
+    Q_PROPERTY(int     logBatchIntervalMs  MEMBER logBatchIntervalMs)
+    Q_PROPERTY(int     logRotateMb         MEMBER logRotateMb)
+    Q_PROPERTY(bool    logArchive          MEMBER logArchive)
+    Q_PROPERTY(int     logArchiveBudgetMb  MEMBER logArchiveBudgetMb)
+    Q_PROPERTY(QVariantMap allocBudgetsKb  MEMBER allocBudgetsKb)
+
+    int     metricsPort         = 0;  //!< TCP-порт метрик на localhost, 0 - выключено
+    QString metricsSocket;            //!< Путь к Unix-сокету метрик, пусто - выключено
+    QString metricsSnapshotFile;      //!< Файл периодического снимка метрик, пусто - выключено
+    int     snapshotIntervalSec = 60; //!< Период записи снимка, с
+    int     stallThresholdMs    = 250; //!< Порог зависания потока GUI, мс, 0 - сторож выключен
+    QString liveChannel;              //!< Имя сегмента разделяемой памяти с отсчётами, пусто - выключено
+    int     liveSlots           = 256; //!< Количество блоков в кольце живого канала
+    QString logCollectorSocket;       //!< Unix-сокет сборщика логов, пусто - отправка выключена
+    QString logSpoolDir         = "log-spool"; //!< Каталог пакетов лога, пока сборщик недоступен
+    int     logSpoolLimitMb     = 16;   //!< Предельный объём каталога пакетов, МБ
+    int     logBatchKb          = 64;   //!< Размер пакета лога до сжатия, КБ
+    int     logBatchIntervalMs  = 2000; //!< Наибольшее время накопления пакета, мс
+    int     logRotateMb         = 64;   //!< Размер файла лога до перехода к новому, МБ
+    bool    logArchive          = true; //!< Сжимать закрытые файлы лога
+    int     logArchiveBudgetMb  = 0;    //!< Предельный объём сжатых логов, МБ, 0 - без удаления
+    QVariantMap allocBudgetsKb;       //!< Бюджеты памяти подсистем, КБ (при QTAPP_ALLOC_TRACKING)
+
+    /**
+     * @brief Метод для загрузки данных из JSON-объекта
+     * @param json Объект с настройками диагностики
+     */
+    void loadFromJson(const QJsonObject &json) {
+        metricsPort         = json["metricsPort"].toInt(0);
+        metricsSocket       = json["metricsSocket"].toString();
+        metricsSnapshotFile = json["metricsSnapshotFile"].toString();
+        snapshotIntervalSec = json["snapshotIntervalSec"].toInt(60);
+        stallThresholdMs    = json["stallThresholdMs"].toInt(250);
+        liveChannel         = json["liveChannel"].toString();
+        liveSlots           = json["liveSlots"].toInt(256);
+        logCollectorSocket  = json["logCollectorSocket"].toString();
+        logSpoolDir         = json["logSpoolDir"].toString("log-spool");
+        logSpoolLimitMb     = json["logSpoolLimitMb"].toInt(16);
+        logBatchKb          = json["logBatchKb"].toInt(64);
+        logBatchIntervalMs  = json["logBatchIntervalMs"].toInt(2000);
+        logRotateMb         = json["logRotateMb"].toInt(64);
+        logArchive          = json["logArchive"].toBool(true);
+        logArchiveBudgetMb  = json["logArchiveBudgetMb"].toInt(0);
+        allocBudgetsKb      = json["allocBudgetsKb"].toObject().toVariantMap();
+    }
+
+    bool operator == (const DiagnosticsSettings &other) const {
+        return metricsPort         == other.metricsPort &&
+               metricsSocket       == other.metricsSocket &&
+               metricsSnapshotFile == other.metricsSnapshotFile &&
+               snapshotIntervalSec == other.snapshotIntervalSec &&
+               stallThresholdMs    == other.stallThresholdMs &&
+               liveChannel         == other.liveChannel &&
+               liveSlots           == other.liveSlots &&
+               logCollectorSocket  == other.logCollectorSocket &&
+               logSpoolDir         == other.logSpoolDir &&
+               logSpoolLimitMb     == other.logSpoolLimitMb &&
+               logBatchKb          == other.logBatchKb &&
+               logBatchIntervalMs  == other.logBatchIntervalMs &&
+               logRotateMb         == other.logRotateMb &&
+               logArchive          == other.logArchive &&
+               logArchiveBudgetMb  == other.logArchiveBudgetMb &&
+               allocBudgetsKb      == other.allocBudgetsKb;
+    }
+
+    bool operator != (const DiagnosticsSettings &other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * @brief Настройки потоков одной роли
+ * @details Значения по умолчанию ничего не меняют
+ */
+struct ThreadRoleSettings {
+    Q_GADGET
+
+public:
+    Q_PROPERTY(QList<int> cpus         MEMBER cpus)
+    Q_PROPERTY(int        nice         MEMBER nice)
+    Q_PROPERTY(int        fifoPriority MEMBER fifoPriority)
+
+    QList<int> cpus;             //!< Допустимые ядра, пусто - все ядра процесса
+    int        nice         = 0; //!< Приоритет nice, -20..19
+    int        fifoPriority = 0; //!< Приоритет SCHED_FIFO 1..99, 0 - обычное планирование
+
+    /**
+     * @brief Метод для загрузки данных из JSON-объекта
+     * @param json Объект с настройками роли
+     */
+    void loadFromJson(const QJsonObject &json) {
+        cpus.clear();
+        for (const QJsonValue &cpu : json["cpus"].toArray()) {
+            cpus << cpu.toInt();
+        }
+        nice         = json["nice"].toInt(0);
+        fifoPriority = json["fifoPriority"].toInt(0);
+    }
+
+    bool operator == (const ThreadRoleSettings &other) const {
+        return cpus         == other.cpus &&
+               nice         == other.nice &&
+               fifoPriority == other.fifoPriority;
+    }
+
+    bool operator != (const ThreadRoleSettings &other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * @brief Настройки потоков по ролям
+ * @details Секция необязательная: без неё потокам только
+ * даются имена, ядра и приоритеты не меняются
+ */
+struct ThreadSettings {
+    Q_GADGET
+
+public:
+    Q_PROPERTY(bool               enabled     MEMBER enabled)
+    Q_PROPERTY(ThreadRoleSettings render      MEMBER render)
+    Q_PROPERTY(ThreadRoleSettings acquisition MEMBER acquisition)
+    Q_PROPERTY(ThreadRoleSettings logging     MEMBER logging)
+    Q_PROPERTY(ThreadRoleSettings background  MEMBER background)
+
+    bool               enabled = false; //!< Секция присутствует в config.json
+    ThreadRoleSettings render;          //!< Поток GUI и поток отрисовки
+    ThreadRoleSettings acquisition;     //!< Сбор данных, таймер планировщика
+    ThreadRoleSettings logging;         //!< Запись и отправка лога
+    ThreadRoleSettings background;      //!< Рабочие планировщика, сообщения, сжатие логов
+
+    /**
+     * @brief Метод для загрузки данных из JSON-объекта
+     * @param json Объект с настройками ролей
+     */
+    void loadFromJson(const QJsonObject &json) {
+        enabled = !json.isEmpty();
+        render.loadFromJson(json["render"].toObject());
+        acquisition.loadFromJson(json["acquisition"].toObject());
+        logging.loadFromJson(json["logging"].toObject());
+        background.loadFromJson(json["background"].toObject());
+    }
+
+    bool operator == (const ThreadSettings &other) const {
+        return enabled     == other.enabled &&
+               render      == other.render &&
+               acquisition == other.acquisition &&
+               logging     == other.logging &&
+               background  == other.background;
+    }
+
+    bool operator != (const ThreadSettings &other) const {
+        return !(*this == other);
+    }
+};
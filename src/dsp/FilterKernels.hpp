@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+
+#if !defined(DSP_FORCE_SCALAR) && defined(__SSE2__)
+#include <emmintrin.h>
+#define DSP_SIMD_SSE 1
+#elif !defined(DSP_FORCE_SCALAR) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define DSP_SIMD_NEON 1
+#endif
+
+/**
+ * @brief Вычислительные ядра фильтров
+ * @details Каждое ядро имеет скалярную эталонную реализацию (суффикс Scalar)
+ * и векторную (SSE2 на x86, NEON на ARM), выбираемую при компиляции.
+ * Векторные версии суммируют в том же порядке, что и скалярные,
+ * поэтому результаты совпадают побитово. При определении DSP_FORCE_SCALAR
+ * используются только скалярные реализации.
+ */
+namespace Dsp::Kernels {
+
+/**
+ * @brief Название активного набора инструкций
+ */
+inline const char *simdName() {
+#if defined(DSP_SIMD_SSE)
+    return "SSE2";
+#elif defined(DSP_SIMD_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+/**
+ * @brief КИХ-фильтр, скалярная реализация
+ * @param x Вход: taps - 1 отсчётов истории, затем n новых отсчётов
+ * @param hRev Коэффициенты фильтра в обратном порядке
+ * @param taps Количество коэффициентов
+ * @param y Выход, n отсчётов
+ * @param n Количество выходных отсчётов
+ */
+inline void firScalar(const float *x, const float *hRev, std::size_t taps,
+                      float *y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        float acc = 0.0f;
+        for (std::size_t k = 0; k < taps; ++k) {
+            acc += x[i + k] * hRev[k];
+        }
+        y[i] = acc;
+    }
+}
+
+/**
+ * @brief КИХ-фильтр, векторная реализация
+ * @details Параллелится по четырём соседним выходным отсчётам:
+ * коэффициент размножается на все полосы регистра, вход читается
+ * невыровненной загрузкой. Параметры как у firScalar()
+ */
+inline void fir(const float *x, const float *hRev, std::size_t taps,
+                float *y, std::size_t n) {
+    std::size_t i = 0;
+#if defined(DSP_SIMD_SSE)
+    for (; i + 4 <= n; i += 4) {
+        __m128 acc = _mm_setzero_ps();
+        for (std::size_t k = 0; k < taps; ++k) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(x + i + k), _mm_set1_ps(hRev[k])));
+        }
+        _mm_storeu_ps(y + i, acc);
+    }
+#elif defined(DSP_SIMD_NEON)
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (std::size_t k = 0; k < taps; ++k) {
+            acc = vaddq_f32(acc, vmulq_f32(vld1q_f32(x + i + k), vdupq_n_f32(hRev[k])));
+        }
+        vst1q_f32(y + i, acc);
+    }
+#endif
+    firScalar(x + i, hRev, taps, y + i, n - i);
+}
+
+/**
+ * @brief Медиана по окну из трёх отсчётов, скалярная реализация
+ * @param x Вход: 2 отсчёта истории, затем n новых отсчётов
+ * @param y Выход, n отсчётов
+ * @param n Количество выходных отсчётов
+ */
+inline void median3Scalar(const float *x, float *y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        const float a = x[i], b = x[i + 1], c = x[i + 2];
+        y[i] = std::max(std::min(a, b), std::min(std::max(a, b), c));
+    }
+}
+
+/**
+ * @brief Медиана по окну из трёх отсчётов, векторная реализация
+ * @details Сеть сравнений min/max без ветвлений. Параметры как у median3Scalar()
+ */
+inline void median3(const float *x, float *y, std::size_t n) {
+    std::size_t i = 0;
+#if defined(DSP_SIMD_SSE)
+    for (; i + 4 <= n; i += 4) {
+        const __m128 a = _mm_loadu_ps(x + i);
+        const __m128 b = _mm_loadu_ps(x + i + 1);
+        const __m128 c = _mm_loadu_ps(x + i + 2);
+        const __m128 r = _mm_max_ps(_mm_min_ps(a, b), _mm_min_ps(_mm_max_ps(a, b), c));
+        _mm_storeu_ps(y + i, r);
+    }
+#elif defined(DSP_SIMD_NEON)
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t a = vld1q_f32(x + i);
+        const float32x4_t b = vld1q_f32(x + i + 1);
+        const float32x4_t c = vld1q_f32(x + i + 2);
+        vst1q_f32(y + i, vmaxq_f32(vminq_f32(a, b), vminq_f32(vmaxq_f32(a, b), c)));
+    }
+#endif
+    median3Scalar(x + i, y + i, n - i);
+}
+
+/**
+ * @brief Умножение отсчётов на коэффициент, скалярная реализация
+ * @param data Отсчёты, изменяются на месте
+ * @param n Количество отсчётов
+ * @param gain Коэффициент
+ */
+inline void scaleScalar(float *data, std::size_t n, float gain) {
+    for (std::size_t i = 0; i < n; ++i) {
+        data[i] *= gain;
+    }
+}
+
+/**
+ * @brief Умножение отсчётов на коэффициент, векторная реализация
+ */
+inline void scale(float *data, std::size_t n, float gain) {
+    std::size_t i = 0;
+#if defined(DSP_SIMD_SSE)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), g));
+    }
+#elif defined(DSP_SIMD_NEON)
+    const float32x4_t g = vdupq_n_f32(gain);
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), g));
+    }
+#endif
+    scaleScalar(data + i, n - i, gain);
+}
+
+/**
+ * @brief Поиск минимума и максимума, скалярная реализация
+ * @param data Отсчёты
+ * @param n Количество отсчётов, больше нуля
+ * @param minValue Найденный минимум
+ * @param maxValue Найденный максимум
+ */
+inline void minMaxScalar(const float *data, std::size_t n, float &minValue, float &maxValue) {
+    float mn = data[0], mx = data[0];
+    for (std::size_t i = 1; i < n; ++i) {
+        mn = std::min(mn, data[i]);
+        mx = std::max(mx, data[i]);
+    }
+    minValue = mn;
+    maxValue = mx;
+}
+
+/**
+ * @brief Поиск минимума и максимума, векторная реализация
+ */
+inline void minMax(const float *data, std::size_t n, float &minValue, float &maxValue) {
+#if defined(DSP_SIMD_SSE)
+    if (n >= 8) {
+        __m128 mn = _mm_loadu_ps(data), mx = mn;
+        std::size_t i = 4;
+        for (; i + 4 <= n; i += 4) {
+            const __m128 v = _mm_loadu_ps(data + i);
+            mn = _mm_min_ps(mn, v);
+            mx = _mm_max_ps(mx, v);
+        }
+        alignas(16) float lo[4], hi[4];
+        _mm_store_ps(lo, mn);
+        _mm_store_ps(hi, mx);
+        minValue = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+        maxValue = std::max(std::max(hi[0], hi[1]), std::max(hi[2], hi[3]));
+        for (; i < n; ++i) {
+            minValue = std::min(minValue, data[i]);
+            maxValue = std::max(maxValue, data[i]);
+        }
+        return;
+    }
+#elif defined(DSP_SIMD_NEON)
+    if (n >= 8) {
+        float32x4_t mn = vld1q_f32(data), mx = mn;
+        std::size_t i = 4;
+        for (; i + 4 <= n; i += 4) {
+            const float32x4_t v = vld1q_f32(data + i);
+            mn = vminq_f32(mn, v);
+            mx = vmaxq_f32(mx, v);
+        }
+        float lo[4], hi[4];
+        vst1q_f32(lo, mn);
+        vst1q_f32(hi, mx);
+        minValue = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+        maxValue = std::max(std::max(hi[0], hi[1]), std::max(hi[2], hi[3]));
+        for (; i < n; ++i) {
+            minValue = std::min(minValue, data[i]);
+            maxValue = std::max(maxValue, data[i]);
+        }
+        return;
+    }
+#endif
+    minMaxScalar(data, n, minValue, maxValue);
+}
+
+/**
+ * @brief Прореживание: каждый factor-й отсчёт
+ * @param x Вход
+ * @param n Количество входных отсчётов
+ * @param factor Коэффициент прореживания
+ * @param phase Смещение первого сохраняемого отсчёта, меньше factor
+ * @param y Выход, может совпадать с x
+ * @return Количество выходных отсчётов
+ * @details Выборка с шагом не векторизуется выгодно,
+ * поэтому реализация одна для всех платформ
+ */
+inline std::size_t decimate(const float *x, std::size_t n, std::size_t factor,
+                            std::size_t phase, float *y) {
+    std::size_t out = 0;
+    for (std::size_t i = phase; i < n; i += factor) {
+        y[out++] = x[i];
+    }
+    return out;
+}
+
+}
@@ -0,0 +1,462 @@
+#pragma once
+
+#include <cmath>
+#include <numbers>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include "SampleBlock.hpp"
+#include "FilterKernels.hpp"
+
+namespace Dsp {
+
+/**
+ * @brief Базовый класс звена конвейера фильтрации
+ * @details Звено обрабатывает блок на месте и хранит состояние
+ * (историю) для каждого канала отдельно, поэтому блоки одного потока
+ * можно подавать подряд любого размера. При смене количества
+ * каналов состояние сбрасывается.
+ */
+class FilterStage {
+public:
+    virtual ~FilterStage() = default;
+
+    /**
+     * @brief Обработка блока отсчётов на месте
+     * @param block Блок, размер которого звено может уменьшить
+     */
+    virtual void process(SampleBlock &block) = 0;
+
+    /**
+     * @brief Сброс внутреннего состояния
+     */
+    virtual void reset() = 0;
+
+    /**
+     * @brief Имя звена для диагностики
+     */
+    virtual const char *name() const = 0;
+
+protected:
+    /**
+     * @brief Подготовка рабочего буфера: история + новый блок
+     * @param history История канала
+     * @param input Новые отсчёты
+     * @param n Количество новых отсчётов
+     * @return Указатель на начало рабочего буфера
+     */
+    float *prepareScratch(const std::vector<float> &history, const float *input, std::size_t n) {
+        const std::size_t total = history.size() + n;
+        if (m_scratch.size() < total) {
+            m_scratch.resize(total);
+        }
+        std::copy(history.begin(), history.end(), m_scratch.begin());
+        std::copy(input, input + n, m_scratch.begin() + history.size());
+        return m_scratch.data();
+    }
+
+    /**
+     * @brief Сохранение хвоста рабочего буфера в историю канала
+     * @param history История канала, размер не меняется
+     * @param n Количество новых отсчётов в рабочем буфере
+     */
+    void storeHistory(std::vector<float> &history, std::size_t n) {
+        const float *tail = m_scratch.data() + n;
+        std::copy(tail, tail + history.size(), history.begin());
+    }
+
+    std::vector<float> m_scratch; //!< Рабочий буфер, переиспользуется между блоками
+};
+
+/**
+ * @brief Скользящее среднее по окну фиксированной длины
+ * @details Рекурсивная схема с накопленной суммой: O(1) на отсчёт
+ * независимо от длины окна. Зависимость по сумме не даёт выигрыша
+ * от векторизации, поэтому ядро скалярное.
+ */
+class MovingAverage : public FilterStage {
+public:
+    /**
+     * @param window Длина окна в отсчётах, не меньше 1
+     */
+    explicit MovingAverage(std::size_t window)
+        : m_window(std::max<std::size_t>(window, 1)) {}
+
+    void process(SampleBlock &block) override {
+        ensureState(block.channels());
+
+        const std::size_t n = block.size();
+        const double norm = 1.0 / static_cast<double>(m_window);
+
+        for (std::size_t ch = 0; ch < block.channels(); ++ch) {
+            float *data = block.channel(ch);
+            const float *x = prepareScratch(m_history[ch], data, n);
+
+            double sum = m_sums[ch];
+            for (std::size_t i = 0; i < n; ++i) {
+                sum += x[i + m_window - 1];
+                data[i] = static_cast<float>(sum * norm);
+                sum -= x[i];
+            }
+            m_sums[ch] = sum;
+
+            storeHistory(m_history[ch], n);
+        }
+    }
+
+    void reset() override {
+        m_history.clear();
+        m_sums.clear();
+    }
+
+    const char *name() const override { return "MovingAverage"; }
+
+private:
+    void ensureState(std::size_t channels) {
+        if (m_history.size() != channels) {
+            m_history.assign(channels, std::vector<float>(m_window - 1, 0.0f));
+            m_sums.assign(channels, 0.0);
+        }
+    }
+
+    std::size_t                     m_window;  //!< Длина окна
+    std::vector<std::vector<float>> m_history; //!< Последние window - 1 отсчётов канала
+    std::vector<double>             m_sums;    //!< Сумма истории канала
+};
+
+/**
+ * @brief Медианный фильтр с нечётной длиной окна
+ * @details Для окна 3 используется векторная сеть сравнений,
+ * для остальных длин - частичная сортировка окна.
+ */
+class MedianFilter : public FilterStage {
+public:
+    /**
+     * @param window Длина окна, округляется вверх до нечётной
+     */
+    explicit MedianFilter(std::size_t window)
+        : m_window(std::max<std::size_t>(window | 1, 1)) {}
+
+    void process(SampleBlock &block) override {
+        ensureState(block.channels());
+
+        const std::size_t n = block.size();
+
+        for (std::size_t ch = 0; ch < block.channels(); ++ch) {
+            float *data = block.channel(ch);
+            const float *x = prepareScratch(m_history[ch], data, n);
+
+            if (m_window == 3) {
+                Kernels::median3(x, data, n);
+            } else if (m_window > 1) {
+                const std::size_t mid = m_window / 2;
+                for (std::size_t i = 0; i < n; ++i) {
+                    std::copy(x + i, x + i + m_window, m_sorted.begin());
+                    std::nth_element(m_sorted.begin(), m_sorted.begin() + mid, m_sorted.end());
+                    data[i] = m_sorted[mid];
+                }
+            }
+
+            storeHistory(m_history[ch], n);
+        }
+    }
+
+    void reset() override { m_history.clear(); }
+
+    const char *name() const override { return "Median"; }
+
+private:
+    void ensureState(std::size_t channels) {
+        if (m_history.size() != channels) {
+            m_history.assign(channels, std::vector<float>(m_window - 1, 0.0f));
+            m_sorted.resize(m_window);
+        }
+    }
+
+    std::size_t                     m_window;  //!< Длина окна
+    std::vector<std::vector<float>> m_history; //!< Последние window - 1 отсчётов канала
+    std::vector<float>              m_sorted;  //!< Копия окна для частичной сортировки
+};
+
+/**
+ * @brief Фильтр с конечной импульсной характеристикой
+ */
+class FirFilter : public FilterStage {
+public:
+    /**
+     * @param coefficients Коэффициенты h[0..N-1], применяемые как y[n] = sum h[k] * x[n-k]
+     */
+    explicit FirFilter(const std::vector<float> &coefficients)
+        : m_hRev(coefficients.rbegin(), coefficients.rend()) {
+        if (m_hRev.empty()) {
+            m_hRev.push_back(1.0f);
+        }
+    }
+
+    /**
+     * @brief Расчёт ФНЧ методом оконного синуса (окно Хэмминга)
+     * @param taps Количество коэффициентов
+     * @param cutoff Частота среза, доля от частоты дискретизации (0..0.5)
+     * @return Нормированные коэффициенты с единичным усилением на нуле
+     */
+    static std::vector<float> lowPass(std::size_t taps, double cutoff) {
+        std::vector<float> h(std::max<std::size_t>(taps, 1));
+        const double center = (h.size() - 1) / 2.0;
+        double sum = 0.0;
+
+        for (std::size_t i = 0; i < h.size(); ++i) {
+            const double t = i - center;
+            const double sinc = (t == 0.0) ? 2.0 * cutoff
+                                           : std::sin(2.0 * std::numbers::pi * cutoff * t) / (std::numbers::pi * t);
+            const double window = (h.size() == 1) ? 1.0
+                                  : 0.54 - 0.46 * std::cos(2.0 * std::numbers::pi * i / (h.size() - 1));
+            h[i] = static_cast<float>(sinc * window);
+            sum += h[i];
+        }
+
+        for (auto &value : h) {
+            value = static_cast<float>(value / sum);
+        }
+        return h;
+    }
+
+    void process(SampleBlock &block) override {
+        ensureState(block.channels());
+
+        const std::size_t n = block.size();
+
+        for (std::size_t ch = 0; ch < block.channels(); ++ch) {
+            float *data = block.channel(ch);
+            const float *x = prepareScratch(m_history[ch], data, n);
+
+            Kernels::fir(x, m_hRev.data(), m_hRev.size(), data, n);
+
+            storeHistory(m_history[ch], n);
+        }
+    }
+
+    void reset() override { m_history.clear(); }
+
+    const char *name() const override { return "FIR"; }
+
+private:
+    void ensureState(std::size_t channels) {
+        if (m_history.size() != channels) {
+            m_history.assign(channels, std::vector<float>(m_hRev.size() - 1, 0.0f));
+        }
+    }
+
+    std::vector<float>              m_hRev;    //!< Коэффициенты в обратном порядке
+    std::vector<std::vector<float>> m_history; //!< Последние taps - 1 отсчётов канала
+};
+
+/**
+ * @brief Звено второго порядка (биквад) для БИХ-фильтра
+ * @details Коэффициенты нормированы на a0
+ */
+struct Biquad {
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f;
+    float a1 = 0.0f, a2 = 0.0f;
+
+    /**
+     * @brief ФНЧ второго порядка по формулам RBJ Audio EQ Cookbook
+     * @param sampleRate Частота дискретизации, Гц
+     * @param cutoff Частота среза, Гц
+     * @param q Добротность, 0.7071 для Баттерворта
+     */
+    static Biquad lowPass(double sampleRate, double cutoff, double q = std::numbers::sqrt2 / 2.0) {
+        const double w0    = 2.0 * std::numbers::pi * cutoff / sampleRate;
+        const double alpha = std::sin(w0) / (2.0 * q);
+        const double cosw  = std::cos(w0);
+        const double a0    = 1.0 + alpha;
+
+        Biquad bq;
+        bq.b0 = static_cast<float>((1.0 - cosw) / 2.0 / a0);
+        bq.b1 = static_cast<float>((1.0 - cosw) / a0);
+        bq.b2 = bq.b0;
+        bq.a1 = static_cast<float>(-2.0 * cosw / a0);
+        bq.a2 = static_cast<float>((1.0 - alpha) / a0);
+        return bq;
+    }
+};
+
+/**
+ * @brief Фильтр с бесконечной импульсной характеристикой
+ * @details Каскад биквадов в транспонированной прямой форме II.
+ * Рекурсия по времени не векторизуется, ядро скалярное.
+ */
+class IirFilter : public FilterStage {
+public:
+    /**
+     * @param sections Звенья каскада в порядке применения
+     */
+    explicit IirFilter(std::vector<Biquad> sections)
+        : m_sections(std::move(sections)) {}
+
+    void process(SampleBlock &block) override {
+        if (m_state.size() != block.channels() * m_sections.size()) {
+            m_state.assign(block.channels() * m_sections.size(), State{});
+        }
+
+        const std::size_t n = block.size();
+
+        for (std::size_t ch = 0; ch < block.channels(); ++ch) {
+            float *data = block.channel(ch);
+
+            for (std::size_t s = 0; s < m_sections.size(); ++s) {
+                const Biquad &bq = m_sections[s];
+                State &st = m_state[ch * m_sections.size() + s];
+
+                float z1 = st.z1, z2 = st.z2;
+                for (std::size_t i = 0; i < n; ++i) {
+                    const float x = data[i];
+                    const float y = bq.b0 * x + z1;
+                    z1 = bq.b1 * x - bq.a1 * y + z2;
+                    z2 = bq.b2 * x - bq.a2 * y;
+                    data[i] = y;
+                }
+                st.z1 = z1;
+                st.z2 = z2;
+            }
+        }
+    }
+
+    void reset() override { m_state.clear(); }
+
+    const char *name() const override { return "IIR"; }
+
+private:
+    struct State {
+        float z1 = 0.0f;
+        float z2 = 0.0f;
+    };
+
+    std::vector<Biquad> m_sections; //!< Звенья каскада
+    std::vector<State>  m_state;    //!< Состояние [канал][звено]
+};
+
+/**
+ * @brief Прореживание потока в factor раз
+ * @details Фазу между блоками сохраняет, поэтому результат не зависит
+ * от разбиения потока на блоки. Перед прореживанием
+ * в конвейер следует ставить ФНЧ.
+ */
+class Decimator : public FilterStage {
+public:
+    /**
+     * @param factor Коэффициент прореживания, не меньше 1
+     */
+    explicit Decimator(std::size_t factor)
+        : m_factor(std::max<std::size_t>(factor, 1)) {}
+
+    void process(SampleBlock &block) override {
+        const std::size_t n = block.size();
+        std::size_t out = 0;
+
+        for (std::size_t ch = 0; ch < block.channels(); ++ch) {
+            float *data = block.channel(ch);
+            out = Kernels::decimate(data, n, m_factor, m_phase, data);
+        }
+
+        if (block.channels() > 0) {
+            m_phase = (m_phase + out * m_factor) - n;
+            block.setSize(out);
+        }
+    }
+
+    void reset() override { m_phase = 0; }
+
+    const char *name() const override { return "Decimator"; }
+
+private:
+    std::size_t m_factor;    //!< Коэффициент прореживания
+    std::size_t m_phase = 0; //!< Индекс первого сохраняемого отсчёта в следующем блоке
+};
+
+/**
+ * @brief Усиление сигнала на постоянный коэффициент
+ */
+class Gain : public FilterStage {
+public:
+    explicit Gain(float gain) : m_gain(gain) {}
+
+    void process(SampleBlock &block) override {
+        for (std::size_t ch = 0; ch < block.channels(); ++ch) {
+            Kernels::scale(block.channel(ch), block.size(), m_gain);
+        }
+    }
+
+    void reset() override {}
+
+    const char *name() const override { return "Gain"; }
+
+private:
+    float m_gain; //!< Коэффициент усиления
+};
+
+/**
+ * @brief Конвейер фильтрации из последовательных звеньев
+ * @details Пример: скользящее среднее, затем ФНЧ и прореживание в 4 раза
+ * @code
+ * Dsp::FilterPipeline pipeline;
+ * pipeline.emplace<Dsp::MovingAverage>(8);
+ * pipeline.emplace<Dsp::FirFilter>(Dsp::FirFilter::lowPass(31, 0.1));
+ * pipeline.emplace<Dsp::Decimator>(4);
+ * pipeline.process(block);
+ * @endcode
+ */
+class FilterPipeline {
+public:
+    /**
+     * @brief Добавление звена в конец конвейера
+     * @return Ссылка на созданное звено
+     */
+    template <typename Stage, typename... Args>
+    Stage &emplace(Args &&...args) {
+        auto stage = std::make_unique<Stage>(std::forward<Args>(args)...);
+        Stage &ref = *stage;
+        m_stages.push_back(std::move(stage));
+        return ref;
+    }
+
+    /**
+     * @brief Добавление готового звена в конец конвейера
+     */
+    void add(std::unique_ptr<FilterStage> stage) {
+        if (stage) {
+            m_stages.push_back(std::move(stage));
+        }
+    }
+
+    /**
+     * @brief Пропуск блока через все звенья
+     * @param block Блок, обрабатывается на месте
+     */
+    void process(SampleBlock &block) {
+        for (auto &stage : m_stages) {
+            if (block.isEmpty()) {
+                return;
+            }
+            stage->process(block);
+        }
+    }
+
+    /**
+     * @brief Сброс состояния всех звеньев
+     */
+    void reset() {
+        for (auto &stage : m_stages) {
+            stage->reset();
+        }
+    }
+
+    std::size_t  size()  const { return m_stages.size(); }
+    bool         isEmpty() const { return m_stages.empty(); }
+    FilterStage *stage(std::size_t index) const { return m_stages[index].get(); }
+
+private:
+    std::vector<std::unique_ptr<FilterStage>> m_stages; //!< Звенья в порядке применения
+};
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace Dsp {
+
+/**
+ * @brief Блок отсчётов в формате "структура массивов" (SoA)
+ * @details Отсчёты каждого канала лежат в памяти подряд, каналы
+ * следуют друг за другом с шагом stride(). Такой формат позволяет
+ * векторным ядрам обрабатывать канал непрерывными загрузками
+ * без перестановок. Память выделяется только при увеличении ёмкости,
+ * поэтому при постоянном размере блока обработка не аллоцирует.
+ */
+class SampleBlock {
+public:
+    SampleBlock() = default;
+
+    /**
+     * @brief Конструктор блока
+     * @param channels Количество каналов
+     * @param capacity Максимальное количество отсчётов на канал
+     */
+    SampleBlock(std::size_t channels, std::size_t capacity) {
+        reserve(channels, capacity);
+    }
+
+    /**
+     * @brief Резервирование памяти под блок
+     * @param channels Количество каналов
+     * @param capacity Максимальное количество отсчётов на канал
+     * @details Текущее содержимое блока не сохраняется
+     */
+    void reserve(std::size_t channels, std::size_t capacity) {
+        // Шаг выравнивается до 16 отсчётов, чтобы каналы
+        // начинались на границе 64 байт относительно начала буфера
+        const std::size_t stride = (capacity + ALIGN_SAMPLES - 1) / ALIGN_SAMPLES * ALIGN_SAMPLES;
+
+        if (channels * stride > m_data.size()) {
+            m_data.resize(channels * stride);
+        }
+
+        m_channels = channels;
+        m_stride   = stride;
+        m_size     = 0;
+    }
+
+    /**
+     * @brief Установка количества отсчётов на канал
+     * @param size Новое количество отсчётов, не больше capacity()
+     */
+    void setSize(std::size_t size) {
+        m_size = (size > m_stride) ? m_stride : size;
+    }
+
+    /**
+     * @brief Указатель на отсчёты канала
+     * @param index Номер канала
+     */
+    float *channel(std::size_t index) { return m_data.data() + index * m_stride; }
+
+    /**
+     * @brief Константный указатель на отсчёты канала
+     * @param index Номер канала
+     */
+    const float *channel(std::size_t index) const { return m_data.data() + index * m_stride; }
+
+    std::size_t channels() const { return m_channels; } //!< Количество каналов
+    std::size_t size()     const { return m_size;     } //!< Отсчётов на канал
+    std::size_t capacity() const { return m_stride;   } //!< Ёмкость канала
+    bool        isEmpty()  const { return m_size == 0 || m_channels == 0; }
+
+private:
+    static constexpr std::size_t ALIGN_SAMPLES = 16;
+
+    std::vector<float> m_data;         //!< Отсчёты всех каналов
+    std::size_t        m_channels = 0; //!< Количество каналов
+    std::size_t        m_stride   = 0; //!< Шаг между каналами
+    std::size_t        m_size     = 0; //!< Текущее количество отсчётов на канал
+};
+
+}
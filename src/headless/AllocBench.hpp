@@ -0,0 +1,115 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "common/AllocTracker.hpp"
+
+#if defined(QTAPP_ALLOC_TRACKING) && defined(__GLIBC__)
+// malloc заменён учётом: точка отсчёта - выделение glibc без него
+extern "C" {
+    void *__libc_malloc(std::size_t size);
+    void  __libc_free(void *block);
+}
+#endif
+
+/**
+ * @brief Замер цены учёта выделений
+ * @details В каждом потоке пачки по BATCH блоков размером от 16 до
+ * 1024 байт выделяются и освобождаются под меткой подсистемы: выделением
+ * glibc без учёта (__libc_malloc), через malloc/free и через operator
+ * new/delete. Разница с первым - накладные расходы учёта (при сборке
+ * с QTAPP_ALLOC_TRACKING) или ноль.
+ * Запускается до старта AppEngine: headless --alloc-bench.
+ */
+namespace AllocBench {
+
+    static constexpr int BATCH  = 64;
+    static constexpr int ROUNDS = 20000; //!< Пачек на поток
+
+    /**
+     * @brief Среднее время пары выделение + освобождение, нс
+     */
+    template <typename Allocate, typename Release>
+    double measure(int threads, Allocate allocate, Release release) {
+        std::vector<std::thread> workers;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&allocate, &release]() {
+                ALLOC_SCOPE(Acquisition);
+                void *blocks[BATCH];
+                std::uintptr_t sink = 0;
+
+                for (int round = 0; round < ROUNDS; ++round) {
+                    for (int i = 0; i < BATCH; ++i) {
+                        blocks[i] = allocate(std::size_t(16) << (i % 7));
+                        sink ^= reinterpret_cast<std::uintptr_t>(blocks[i]);
+                    }
+                    for (int i = 0; i < BATCH; ++i) {
+                        release(blocks[i]);
+                    }
+                }
+                static_cast<void>(*static_cast<volatile std::uintptr_t *>(&sink));
+            });
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+
+        const double ns = std::chrono::duration<double, std::nano>(
+                              std::chrono::steady_clock::now() - start).count();
+        return ns / (double(threads) * ROUNDS * BATCH);
+    }
+
+    /**
+     * @brief Замер в одном потоке и во всех ядрах
+     * @return Строки отчёта
+     */
+    inline QStringList run() {
+        const int cores = std::max(1, int(std::thread::hardware_concurrency()));
+
+#if defined(QTAPP_ALLOC_TRACKING)
+        QStringList lines { "allocation tracking: enabled" };
+#else
+        QStringList lines { "allocation tracking: disabled at build time (QTAPP_ALLOC_TRACKING)" };
+#endif
+
+        for (int threads : { 1, cores }) {
+#if defined(QTAPP_ALLOC_TRACKING) && defined(__GLIBC__)
+            const double plain = measure(threads,
+                                         [](std::size_t size) { return __libc_malloc(size); },
+                                         [](void *block) { __libc_free(block); });
+#else
+            const double plain = measure(threads,
+                                         [](std::size_t size) { return std::malloc(size); },
+                                         [](void *block) { std::free(block); });
+#endif
+            const double tracked = measure(threads,
+                                           [](std::size_t size) { return std::malloc(size); },
+                                           [](void *block) { std::free(block); });
+            const double hooked = measure(threads,
+                                          [](std::size_t size) { return ::operator new(size); },
+                                          [](void *block) { ::operator delete(block); });
+            lines << QString("%1 thread(s): untracked %2 ns, malloc/free %3 ns (+%4), new/delete %5 ns (+%6)")
+                         .arg(threads)
+                         .arg(plain, 0, 'f', 1)
+                         .arg(tracked, 0, 'f', 1)
+                         .arg(tracked - plain, 0, 'f', 1)
+                         .arg(hooked, 0, 'f', 1)
+                         .arg(hooked - plain, 0, 'f', 1);
+            if (cores == 1) {
+                break;
+            }
+        }
+        return lines;
+    }
+}
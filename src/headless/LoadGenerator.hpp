@@ -0,0 +1,203 @@
+#pragma once
+
+#include <QDir>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <optional>
+#include <random>
+
+#include "AppEngine.hpp"
+
+/**
+ * @brief Профиль нагрузки на бэкенд
+ * @details Нулевая частота отключает соответствующий источник
+ */
+struct LoadProfile {
+    QString name;
+    int     sampleRateHz       = 0; //!< Частота отсчётов имитируемого датчика, Гц
+    int     blockSize          = 0; //!< Отсчётов в одном блоке датчика
+    int     logPerSec          = 0; //!< Записей в лог в секунду, все уровни по кругу
+    int     messagesPerSec     = 0; //!< Сообщений об ошибках для GUI в секунду
+    int     configCyclesPerMin = 0; //!< Циклов сохранения и чтения настроек в минуту
+
+    /**
+     * @brief Встроенный профиль по имени
+     */
+    static std::optional<LoadProfile> byName(const QString &name) {
+        for (const LoadProfile &profile : builtin()) {
+            if (profile.name == name) {
+                return profile;
+            }
+        }
+        return std::nullopt;
+    }
+
+    static QStringList names() {
+        QStringList result;
+        for (const LoadProfile &profile : builtin()) {
+            result.append(profile.name);
+        }
+        return result;
+    }
+
+    static QList<LoadProfile> builtin() {
+        return {
+            { "idle",    0,     0,   0,    0,  0 },
+            { "nominal", 1000,  100, 50,   0,  1 },
+            { "stress",  50000, 500, 5000, 20, 30 },
+        };
+    }
+};
+
+/**
+ * @brief Генератор нагрузки на AppEngine
+ * @details Источники нагрузки - периодические задачи планировщика
+ * AppEngine: имитация датчика (синус с шумом через ingestSamples),
+ * поток записей в лог, сообщения об ошибках через MessagesHandler и
+ * циклы сохранения/чтения настроек во временный файл (config.json
+ * рабочего каталога не перезаписывается). Планировщик должен быть
+ * запущен (AppEngine::start()).
+ *
+ * Циклы настроек идут через собственный ConfigReader, заполненный
+ * копией рабочих настроек при start(): чтение файла не подменяет
+ * настройки, с которыми работает AppEngine. stop() дожидается
+ * завершения уже начатых запусков, после него генератор можно
+ * разрушать до AppEngine.
+ */
+class LoadGenerator
+{
+public:
+    static constexpr int LOG_PERIOD_MS     = 10;  //!< Период пачки записей в лог
+    static constexpr int MESSAGE_PERIOD_MS = 100; //!< Период пачки сообщений
+    static constexpr int MESSAGE_TEXTS     = 8;   //!< Различных текстов сообщений
+    static constexpr int DISMISS_PERIOD_MS = 1000; //!< Период закрытия сообщений вместо пользователя
+
+    LoadGenerator(AppEngine &engine, const LoadProfile &profile)
+        : m_engine(engine), m_profile(profile) {
+        // Запуски идут в рабочих потоках планировщика: прямое подключение
+        QObject::connect(&m_config, &ConfigReader::errorOccurred,
+                         [](const QString &message) { AsyncLogger::instance().logError(message); });
+    }
+
+    ~LoadGenerator() { stop(); }
+
+    LoadGenerator(const LoadGenerator &) = delete;
+    LoadGenerator &operator=(const LoadGenerator &) = delete;
+
+    void start() {
+        using namespace std::chrono;
+        TaskScheduler &scheduler = m_engine.scheduler();
+
+        if (m_profile.sampleRateHz > 0 && m_profile.blockSize > 0) {
+            m_block.reserve(1, m_profile.blockSize);
+            const auto period = microseconds(qint64(m_profile.blockSize) * 1000000 / m_profile.sampleRateHz);
+            m_tasks.append(scheduler.schedulePeriodic("load: sensor", period,
+                                                      [this]() { sensorBlock(); },
+                                                      TaskScheduler::High));
+        }
+
+        if (m_profile.logPerSec > 0) {
+            m_tasks.append(scheduler.schedulePeriodic("load: log", milliseconds(LOG_PERIOD_MS),
+                                                      [this]() { logBurst(); }));
+        }
+
+        if (m_profile.messagesPerSec > 0) {
+            m_tasks.append(scheduler.schedulePeriodic("load: messages", milliseconds(MESSAGE_PERIOD_MS),
+                                                      [this]() { messageBurst(); }));
+
+            // Диалога нет: сообщения закрываются таймером в главном потоке
+            m_dismissTimer.callOnTimeout(&m_engine.messages(), &MessagesHandler::dismissAll);
+            m_dismissTimer.start(DISMISS_PERIOD_MS);
+        }
+
+        if (m_profile.configCyclesPerMin > 0) {
+            // Копия рабочих настроек через тот же файл, в который пишут циклы
+            const QString path = configPath();
+            if (m_engine.config().saveSettings(path, true, false)) {
+                m_config.readSettings(path);
+            }
+            m_tasks.append(scheduler.schedulePeriodic("load: config",
+                                                      milliseconds(60000 / m_profile.configCyclesPerMin),
+                                                      [this]() { configCycle(); },
+                                                      TaskScheduler::Low));
+        }
+    }
+
+    void stop() {
+        for (TaskScheduler::TaskId id : m_tasks) {
+            m_engine.scheduler().cancelAndWait(id);
+        }
+        m_tasks.clear();
+        m_dismissTimer.stop();
+    }
+
+    const LoadProfile &profile() const { return m_profile; }
+
+private:
+    void sensorBlock() {
+        const double dt = 1.0 / m_profile.sampleRateHz;
+        const std::size_t n = static_cast<std::size_t>(m_profile.blockSize);
+
+        m_block.setSize(n);
+        float *samples = m_block.channel(0);
+        std::normal_distribution<float> noise(0.0f, 0.05f);
+        for (std::size_t i = 0; i < n; ++i) {
+            const double t = (m_sampleIndex + i) * dt;
+            samples[i] = static_cast<float>(std::sin(2.0 * std::numbers::pi * 50.0 * t)) + noise(m_random);
+        }
+
+        m_engine.ingestSamples(m_block, m_sampleIndex * dt, dt);
+        m_sampleIndex += n;
+    }
+
+    void logBurst() {
+        AsyncLogger &log = AsyncLogger::instance();
+        const int count = std::max(1, m_profile.logPerSec * LOG_PERIOD_MS / 1000);
+        for (int i = 0; i < count; ++i) {
+            const QString message = QString("load %1").arg(m_logIndex);
+            switch (m_logIndex++ % 6) {
+            case 0: log.logTrace(message);   break;
+            case 1: log.logDebug(message);   break;
+            case 2: log.logInfo(message);    break;
+            case 3: log.logWarning(message); break;
+            case 4: log.logError(message);   break;
+            default: log.logFatal(message);  break;
+            }
+        }
+    }
+
+    void messageBurst() {
+        const int count = std::max(1, m_profile.messagesPerSec * MESSAGE_PERIOD_MS / 1000);
+        for (int i = 0; i < count; ++i) {
+            m_engine.messages().sendError(QString("load error %1").arg(m_messageIndex++ % MESSAGE_TEXTS));
+        }
+    }
+
+    static QString configPath() {
+        return QDir::temp().filePath("qtapp-load-config.json");
+    }
+
+    void configCycle() {
+        const QString path = configPath();
+        m_config.saveSettings(path, true, false);
+        m_config.readSettings(path);
+    }
+
+    AppEngine                   &m_engine;
+    const LoadProfile            m_profile;
+    QList<TaskScheduler::TaskId> m_tasks;   //!< Задачи нагрузки в планировщике
+    QTimer                       m_dismissTimer; //!< Закрытие сообщений
+    ConfigReader                 m_config;  //!< Настройки циклов сохранения/чтения
+
+    Dsp::SampleBlock m_block;             //!< Блок имитируемого датчика
+    std::mt19937     m_random{ 12345 };   //!< Шум датчика, воспроизводимый
+    quint64          m_sampleIndex  = 0;
+    quint64          m_logIndex     = 0;
+    quint64          m_messageIndex = 0;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QCoreApplication>
+#include <QSocketNotifier>
+
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <memory>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @brief Завершение цикла событий по SIGINT и SIGTERM
+ * @details Обработчик сигнала только пишет байт в socketpair (self-pipe),
+ * QSocketNotifier в потоке GUI читает его и вызывает
+ * QCoreApplication::quit(). После выхода из app.exec() штатно
+ * отрабатывают остановка нагрузки, отчёт soak и статистика. Повторный
+ * такой же сигнал действует по умолчанию: если завершение зависло,
+ * второй Ctrl+C прерывает процесс.
+ */
+class QuitOnSignal
+{
+public:
+    QuitOnSignal() {
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, s_fds) != 0) {
+            qWarning("QuitOnSignal: socketpair failed, errno %d", errno);
+            return;
+        }
+        ::fcntl(s_fds[0], F_SETFL, O_NONBLOCK);
+        ::fcntl(s_fds[1], F_SETFL, O_NONBLOCK);
+
+        m_notifier = std::make_unique<QSocketNotifier>(s_fds[1], QSocketNotifier::Read);
+        QObject::connect(m_notifier.get(), &QSocketNotifier::activated, m_notifier.get(), []() {
+            char signal = 0;
+            while (::read(s_fds[1], &signal, 1) > 0) {
+            }
+            QCoreApplication::quit();
+        });
+
+        struct sigaction action = {};
+        action.sa_handler = &QuitOnSignal::onSignal;
+        action.sa_flags   = SA_RESTART | SA_RESETHAND;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+    }
+
+    ~QuitOnSignal() {
+        if (!m_notifier) {
+            return;
+        }
+        struct sigaction action = {};
+        action.sa_handler = SIG_DFL;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+
+        m_notifier.reset();
+        ::close(s_fds[0]);
+        ::close(s_fds[1]);
+        s_fds[0] = s_fds[1] = -1;
+    }
+
+    QuitOnSignal(const QuitOnSignal &) = delete;
+    QuitOnSignal &operator=(const QuitOnSignal &) = delete;
+
+private:
+    /**
+     * @brief Обработчик сигнала: только async-signal-safe write()
+     */
+    static void onSignal(int signal) {
+        const int savedErrno = errno;
+        const char byte = static_cast<char>(signal);
+        [[maybe_unused]] const ssize_t written = ::write(s_fds[0], &byte, 1);
+        errno = savedErrno;
+    }
+
+    static inline int s_fds[2] = { -1, -1 }; //!< [0] - запись из обработчика, [1] - чтение в потоке GUI
+
+    std::unique_ptr<QSocketNotifier> m_notifier;
+};
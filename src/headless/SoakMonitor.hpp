@@ -0,0 +1,299 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "common/Metrics.hpp"
+#include "common/ProcessStats.hpp"
+
+/**
+ * @brief Наблюдение за длительным прогоном и проверка дрейфа
+ * @details Раз в интервал снимает показатели: p99/p999 задержек за
+ * прошедший интервал по отслеживаемым гистограммам, глубины очередей,
+ * RSS, число открытых дескрипторов и потоков. Каждая выборка сразу
+ * дописывается строкой в CSV, поэтому данные многочасового прогона не
+ * теряются при аварийном завершении.
+ *
+ * По окончании (finish()) выборки после прогрева проверяются на рост:
+ *  - для ресурсов (RSS, дескрипторы, потоки, очереди) - наклон прямой
+ *    наименьших квадратов в единицах в час против допустимого;
+ *  - для задержек (p99 и p999) - отношение медианы последней четверти
+ *    прогона к медиане первой четверти против допустимого. Интервал без
+ *    записей в гистограмму не даёт значения (пустая ячейка в CSV), и
+ *    четверти берутся только по интервалам с записями: иначе нулевые
+ *    медианы простаивающей метрики проходили бы проверку всегда.
+ * Итог и все проверки пишутся в JSON-отчёт.
+ */
+class SoakMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Пороги проверки дрейфа
+     */
+    struct Limits {
+        double rssKbPerHour   = 2048; //!< Рост RSS, КБ/ч
+        double fdsPerHour     = 1;    //!< Рост открытых дескрипторов, шт/ч
+        double threadsPerHour = 1;    //!< Рост числа потоков, шт/ч
+        double queuePerHour   = 100;  //!< Рост глубины очередей, шт/ч
+        double latencyGrowth  = 2.0;  //!< Рост медианы p99 и p999, раз
+        double warmupFraction = 0.1;  //!< Доля прогона, не участвующая в проверках
+    };
+
+    SoakMonitor(const QString &reportPrefix, int intervalSec, const Limits &limits,
+                QObject *parent = nullptr)
+        : QObject(parent),
+          m_prefix(reportPrefix),
+          m_limits(limits),
+          m_histograms({ "logger_write_ns",
+                         "messages_dispatch_ns",
+                         "config_save_ns",
+                         "gui_heartbeat_latency_ns" }),
+          m_gauges({ "logger_queue_depth",
+                     "messages_queue_depth" }) {
+        m_timer.setInterval(std::max(intervalSec, 1) * 1000);
+        connect(&m_timer, &QTimer::timeout, this, &SoakMonitor::sample);
+    }
+
+    /**
+     * @brief Начало наблюдения
+     * @return false, если не удалось создать CSV-файл
+     */
+    bool start() {
+        m_csv.setFileName(m_prefix + ".csv");
+        if (!m_csv.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            return false;
+        }
+
+        QStringList header { "t_s", "rss_kb", "fds", "threads" };
+        for (const QString &gauge : m_gauges) {
+            header << gauge;
+        }
+        for (const QString &histogram : m_histograms) {
+            header << histogram + "_p99" << histogram + "_p999";
+        }
+        writeRow(header);
+
+        m_last.assign(m_histograms.size(), Metrics::Histogram::Snapshot{});
+        for (qsizetype i = 0; i < m_histograms.size(); ++i) {
+            if (const Metrics::Histogram *h = Metrics::Registry::instance().findHistogram(m_histograms[i])) {
+                m_last[i] = h->snapshot();
+            }
+        }
+
+        m_startNs = Metrics::nowNs();
+        m_timer.start();
+        return true;
+    }
+
+    /**
+     * @brief Завершение наблюдения, проверки и запись JSON-отчёта
+     * @return true, если дрейф не обнаружен
+     */
+    bool finish() {
+        m_timer.stop();
+        sample();
+        m_csv.close();
+
+        QJsonArray checks;
+        bool passed = true;
+
+        const std::size_t first = static_cast<std::size_t>(m_samples.size() * m_limits.warmupFraction);
+        const std::size_t count = m_samples.size() - first;
+
+        auto slopeCheck = [&](const QString &name, std::size_t column, double limit) {
+            const double slope = slopePerHour(first, column);
+            const bool ok = count < MIN_SAMPLES || slope <= limit;
+            passed = passed && ok;
+            checks.append(QJsonObject{
+                { "metric", name },
+                { "kind",   "slopePerHour" },
+                { "value",  slope },
+                { "limit",  limit },
+                { "passed", ok }
+            });
+        };
+
+        slopeCheck("rss_kb",  COL_RSS,     m_limits.rssKbPerHour);
+        slopeCheck("fds",     COL_FDS,     m_limits.fdsPerHour);
+        slopeCheck("threads", COL_THREADS, m_limits.threadsPerHour);
+        for (qsizetype i = 0; i < m_gauges.size(); ++i) {
+            slopeCheck(m_gauges[i], COL_GAUGES + i, m_limits.queuePerHour);
+        }
+
+        auto growthCheck = [&](const QString &name, std::size_t column) {
+            // Только интервалы с записями: пустой интервал - не нулевая задержка
+            std::vector<double> values;
+            for (std::size_t i = first; i < m_samples.size(); ++i) {
+                if (!std::isnan(m_samples[i][column])) {
+                    values.push_back(m_samples[i][column]);
+                }
+            }
+
+            const std::size_t quarter = values.size() / 4;
+            const bool judged = values.size() >= MIN_SAMPLES && quarter > 0;
+            const double before = judged ? median(values.begin(), values.begin() + quarter) : 0.0;
+            const double after  = judged ? median(values.end() - quarter, values.end()) : 0.0;
+            const bool ok = !judged || before <= 0 || after / before <= m_limits.latencyGrowth;
+            passed = passed && ok;
+            checks.append(QJsonObject{
+                { "metric",  name },
+                { "kind",    "medianGrowth" },
+                { "windows", static_cast<qint64>(values.size()) },
+                { "before",  before },
+                { "after",   after },
+                { "value",   (judged && before > 0) ? QJsonValue(after / before) : QJsonValue() },
+                { "limit",   m_limits.latencyGrowth },
+                { "passed",  ok }
+            });
+        };
+
+        for (qsizetype i = 0; i < m_histograms.size(); ++i) {
+            const std::size_t column = COL_GAUGES + m_gauges.size() + 2 * i;
+            growthCheck(m_histograms[i] + "_p99",  column);
+            growthCheck(m_histograms[i] + "_p999", column + 1);
+        }
+
+        const QJsonObject report {
+            { "durationSec",   (Metrics::nowNs() - m_startNs) / 1e9 },
+            { "samples",       static_cast<qint64>(m_samples.size()) },
+            { "warmupSamples", static_cast<qint64>(first) },
+            { "enoughSamples", count >= MIN_SAMPLES },
+            { "passed",        passed },
+            { "checks",        checks },
+            { "final",         m_samples.empty() ? QJsonObject{} : rowJson(m_samples.back()) }
+        };
+
+        QSaveFile file(m_prefix + ".json");
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(QJsonDocument(report).toJson());
+            file.commit();
+        }
+        return passed;
+    }
+
+private slots:
+    void sample() {
+        std::vector<double> row;
+        row.reserve(COL_GAUGES + m_gauges.size() + 2 * m_histograms.size());
+
+        row.push_back((Metrics::nowNs() - m_startNs) / 1e9);
+        row.push_back(ProcessStats::rssKb());
+        row.push_back(ProcessStats::openFdCount());
+        row.push_back(ProcessStats::threadCount());
+
+        Metrics::Registry &registry = Metrics::Registry::instance();
+        for (const QString &name : m_gauges) {
+            const Metrics::Gauge *gauge = registry.findGauge(name);
+            row.push_back(gauge ? gauge->value() : 0);
+        }
+
+        for (qsizetype i = 0; i < m_histograms.size(); ++i) {
+            Metrics::Histogram::Snapshot window;
+            if (const Metrics::Histogram *h = registry.findHistogram(m_histograms[i])) {
+                const Metrics::Histogram::Snapshot snap = h->snapshot();
+                window = snap.since(m_last[i]);
+                m_last[i] = snap;
+            }
+            // Интервал без записей: значения нет, а не нулевая задержка
+            const double none = std::numeric_limits<double>::quiet_NaN();
+            row.push_back(window.count ? window.quantile(0.99)  : none);
+            row.push_back(window.count ? window.quantile(0.999) : none);
+        }
+
+        QStringList cells;
+        for (double value : row) {
+            cells << (std::isnan(value) ? QString() : QString::number(value, 'g', 12));
+        }
+        writeRow(cells);
+
+        m_samples.push_back(std::move(row));
+    }
+
+private:
+    static constexpr std::size_t MIN_SAMPLES = 8; //!< Меньше выборок - проверки не выполняются
+
+    enum Column : std::size_t {
+        COL_TIME,
+        COL_RSS,
+        COL_FDS,
+        COL_THREADS,
+        COL_GAUGES
+    };
+
+    void writeRow(const QStringList &cells) {
+        m_csv.write(cells.join(',').toUtf8() + '\n');
+        m_csv.flush();
+    }
+
+    QJsonObject rowJson(const std::vector<double> &row) const {
+        QJsonObject result {
+            { "rss_kb",  row[COL_RSS] },
+            { "fds",     row[COL_FDS] },
+            { "threads", row[COL_THREADS] }
+        };
+        for (qsizetype i = 0; i < m_gauges.size(); ++i) {
+            result[m_gauges[i]] = row[COL_GAUGES + i];
+        }
+        return result;
+    }
+
+    /**
+     * @brief Наклон прямой наименьших квадратов для столбца, единиц в час
+     */
+    double slopePerHour(std::size_t first, std::size_t column) const {
+        const std::size_t n = m_samples.size() - first;
+        if (n < 2) {
+            return 0.0;
+        }
+
+        double meanT = 0, meanV = 0;
+        for (std::size_t i = first; i < m_samples.size(); ++i) {
+            meanT += m_samples[i][COL_TIME];
+            meanV += m_samples[i][column];
+        }
+        meanT /= n;
+        meanV /= n;
+
+        double cov = 0, var = 0;
+        for (std::size_t i = first; i < m_samples.size(); ++i) {
+            const double dt = m_samples[i][COL_TIME] - meanT;
+            cov += dt * (m_samples[i][column] - meanV);
+            var += dt * dt;
+        }
+        return (var > 0) ? cov / var * 3600.0 : 0.0;
+    }
+
+    static double median(std::vector<double>::const_iterator begin,
+                         std::vector<double>::const_iterator end) {
+        std::vector<double> values(begin, end);
+        if (values.empty()) {
+            return 0.0;
+        }
+        std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+        return values[values.size() / 2];
+    }
+
+    QString      m_prefix;     //!< Путь отчёта без расширения
+    Limits       m_limits;     //!< Пороги дрейфа
+    QStringList  m_histograms; //!< Отслеживаемые гистограммы задержек
+    QStringList  m_gauges;     //!< Отслеживаемые очереди
+    QTimer       m_timer;      //!< Период выборки
+    QFile        m_csv;        //!< Построчная запись выборок
+    qint64       m_startNs = 0;
+
+    std::vector<Metrics::Histogram::Snapshot> m_last;    //!< Снимки гистограмм на начало интервала
+    std::vector<std::vector<double>>          m_samples; //!< Все выборки
+};
@@ -0,0 +1,224 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTimer>
+
+#include <cstdio>
+#include <memory>
+
+#include "AppEngine.hpp"
+#include "headless/LoadGenerator.hpp"
+#include "headless/SoakMonitor.hpp"
+#include "headless/AllocBench.hpp"
+#include "headless/QuitOnSignal.hpp"
+#include "common/AsyncLogger.hpp"
+#include "common/QMsgHandler.hpp"
+#include "common/Metrics.hpp"
+#include "common/ProcessStats.hpp"
+#include "common/ThreadTopology.hpp"
+#include "common/AllocTracker.hpp"
+
+
+/**
+ * @brief Итоговая статистика прогона
+ */
+static QJsonObject collectStats(AppEngine &engine, const LoadProfile &profile, qint64 elapsedMs) {
+    QJsonArray tasks;
+    for (const TaskScheduler::TaskStats &task : engine.scheduler().stats()) {
+        tasks.append(QJsonObject{
+            { "name",      task.name },
+            { "runs",      static_cast<qint64>(task.runs) },
+            { "overruns",  static_cast<qint64>(task.overruns) },
+            { "meanRunUs", task.meanRunUs },
+            { "maxRunUs",  task.maxRunUs },
+            { "maxLateUs", task.maxLateUs }
+        });
+    }
+
+    QJsonObject stats{
+        { "profile",   profile.name },
+        { "elapsedMs", elapsedMs },
+        { "process",   QJsonObject{
+              { "rssKb",     ProcessStats::rssKb() },
+              { "peakRssKb", ProcessStats::peakRssKb() },
+              { "threads",   ProcessStats::threadCount() },
+              { "openFds",   ProcessStats::openFdCount() }
+          } },
+        { "tasks",     tasks },
+        { "metrics",   Metrics::Registry::instance().json() }
+    };
+
+#if defined(QTAPP_ALLOC_TRACKING)
+    QJsonObject allocations;
+    for (int tag = 0; tag < AllocTracker::TagCount; ++tag) {
+        const AllocTracker::TagStats tagStats = AllocTracker::stats(AllocTracker::Tag(tag));
+        allocations[AllocTracker::tagName(AllocTracker::Tag(tag))] = QJsonObject{
+            { "allocations", static_cast<qint64>(tagStats.allocations) },
+            { "frees",       static_cast<qint64>(tagStats.frees) },
+            { "bytes",       static_cast<qint64>(tagStats.bytes) },
+            { "liveBytes",   static_cast<qint64>(tagStats.liveBytes) }
+        };
+    }
+    const AllocTracker::HeapStats heap = AllocTracker::heap();
+    allocations["heap"] = QJsonObject{
+        { "inUse",  static_cast<qint64>(heap.inUse) },
+        { "mapped", static_cast<qint64>(heap.mapped) },
+        { "free",   static_cast<qint64>(heap.free) }
+    };
+    stats["allocations"] = allocations;
+#endif
+    return stats;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication::setOrganizationName("byhat");
+    QCoreApplication::setOrganizationDomain("byhat.example");
+    QCoreApplication::setApplicationName("QML App Template (headless)");
+    QCoreApplication::setApplicationVersion("v1.0");
+
+    auto &log = AsyncLogger::instance();
+    qInstallMessageHandler(customMessageHandler);
+
+    QCoreApplication app(argc, argv);
+    ThreadTopology::Scope topology(ThreadTopology::Render, "main", false);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs the application backend without GUI under a synthetic load");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption durationOption({ "d", "duration" },
+                                      "Run time in seconds, 0 - until interrupted.",
+                                      "seconds", "10");
+    QCommandLineOption profileOption({ "p", "profile" },
+                                     QString("Load profile: %1.").arg(LoadProfile::names().join(", ")),
+                                     "name", "nominal");
+    QCommandLineOption statsOption({ "s", "stats" },
+                                   "Write final statistics as JSON to file, '-' - to stdout.",
+                                   "file");
+    QCommandLineOption reportOption({ "r", "report" },
+                                    "Soak mode: sample over time into <prefix>.csv, check for drift "
+                                    "and write <prefix>.json. Exit code 3 on drift.",
+                                    "prefix");
+    QCommandLineOption intervalOption("sample-interval",
+                                      "Soak sampling interval in seconds.",
+                                      "seconds", "10");
+    QCommandLineOption rssGrowthOption("max-rss-growth",
+                                       "Allowed RSS growth after warm-up, kB per hour.",
+                                       "kb", "2048");
+    QCommandLineOption latencyGrowthOption("max-latency-growth",
+                                           "Allowed growth of median p99 and p999 latency, times.",
+                                           "ratio", "2.0");
+    QCommandLineOption allocBenchOption("alloc-bench",
+                                        "Measure allocation tracking overhead of malloc and operator new and exit.");
+    parser.addOption(durationOption);
+    parser.addOption(profileOption);
+    parser.addOption(statsOption);
+    parser.addOption(reportOption);
+    parser.addOption(intervalOption);
+    parser.addOption(rssGrowthOption);
+    parser.addOption(latencyGrowthOption);
+    parser.addOption(allocBenchOption);
+    parser.process(app);
+
+    if (parser.isSet(allocBenchOption)) {
+        for (const QString &line : AllocBench::run()) {
+            std::fprintf(stdout, "%s\n", qPrintable(line));
+        }
+        return 0;
+    }
+
+    bool durationOk = false;
+    const int durationSec = parser.value(durationOption).toInt(&durationOk);
+    if (!durationOk || durationSec < 0) {
+        std::fprintf(stderr, "Invalid duration: %s\n", qPrintable(parser.value(durationOption)));
+        return 2;
+    }
+
+    const std::optional<LoadProfile> profile = LoadProfile::byName(parser.value(profileOption));
+    if (!profile) {
+        std::fprintf(stderr, "Unknown profile '%s', expected one of: %s\n",
+                     qPrintable(parser.value(profileOption)),
+                     qPrintable(LoadProfile::names().join(", ")));
+        return 2;
+    }
+
+    // Ctrl+C и SIGTERM завершают цикл событий, а не процесс: нагрузка
+    // останавливается, отчёт и статистика записываются как по таймеру
+    QuitOnSignal quitOnSignal;
+
+    log.logInfo(QString("Starting headless backend, profile %1, duration %2 s")
+                    .arg(profile->name).arg(durationSec));
+
+    AppEngine appEngine;
+    appEngine.start();
+
+    std::unique_ptr<SoakMonitor> soak;
+    if (parser.isSet(reportOption)) {
+        SoakMonitor::Limits limits;
+        limits.rssKbPerHour  = parser.value(rssGrowthOption).toDouble();
+        limits.latencyGrowth = parser.value(latencyGrowthOption).toDouble();
+
+        soak = std::make_unique<SoakMonitor>(parser.value(reportOption),
+                                             parser.value(intervalOption).toInt(),
+                                             limits);
+        if (!soak->start()) {
+            std::fprintf(stderr, "Failed to create report %s.csv\n",
+                         qPrintable(parser.value(reportOption)));
+            return 1;
+        }
+    }
+
+    LoadGenerator load(appEngine, *profile);
+    load.start();
+    ThreadTopology::instance().applyMainThread();
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    if (durationSec > 0) {
+        QTimer::singleShot(durationSec * 1000, &app, &QCoreApplication::quit);
+    }
+
+    int code = app.exec();
+    load.stop();
+
+    if (soak && !soak->finish()) {
+        std::fprintf(stderr, "Drift detected, see %s.json\n", qPrintable(parser.value(reportOption)));
+        code = 3;
+    }
+
+    const QJsonObject stats = collectStats(appEngine, *profile, elapsed.elapsed());
+    const QByteArray json = QJsonDocument(stats).toJson();
+
+    const QString statsPath = parser.value(statsOption);
+    if (statsPath == "-") {
+        std::fwrite(json.constData(), 1, json.size(), stdout);
+    } else if (!statsPath.isEmpty()) {
+        QSaveFile file(statsPath);
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+            std::fprintf(stderr, "Failed to write statistics to %s\n", qPrintable(statsPath));
+            return 1;
+        }
+    }
+
+    // Короткая сводка всегда печатается в stderr
+    const QJsonObject histograms = stats["metrics"].toObject()["histograms"].toObject();
+    for (auto it = histograms.begin(); it != histograms.end(); ++it) {
+        const QJsonObject h = it.value().toObject();
+        std::fprintf(stderr, "%-28s count %10lld  p50 %10lld  p99 %10lld  p999 %10lld  max %10lld\n",
+                     qPrintable(it.key()),
+                     h["count"].toInteger(), h["p50"].toInteger(), h["p99"].toInteger(),
+                     h["p999"].toInteger(), h["max"].toInteger());
+    }
+    std::fprintf(stderr, "RSS %lld kB, peak %lld kB, %lld threads, %lld fds\n",
+                 ProcessStats::rssKb(), ProcessStats::peakRssKb(),
+                 ProcessStats::threadCount(), ProcessStats::openFdCount());
+
+    return code;
+}
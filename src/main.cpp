@@ -1,33 +1,58 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QQuickWindow>
+#include <QElapsedTimer>
 
 #include "AppEngine.hpp"
+#include "charts/LineSeriesItem.hpp"
 #include "common/AsyncLogger.hpp"
 #include "common/QMsgHandler.hpp"
+#include "common/ProcessStats.hpp"
+#include "common/Tracer.hpp"
+#include "common/Metrics.hpp"
 #include "common/structures.hpp"
-
-// Инициализация статических членов
-AsyncLogger* AsyncLogger::m_instance = nullptr;
-std::once_flag AsyncLogger::m_onceFlag;
+#include "common/ThreadTopology.hpp"
+#include "common/AllocTracker.hpp"
 
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
+    TRACE_INSTANT("main");
+
     QGuiApplication::setOrganizationName("byhat");
     QGuiApplication::setOrganizationDomain("byhat.example");
     QGuiApplication::setApplicationName("QML App Template");
     QGuiApplication::setApplicationVersion("v1.0");
 
+    TRACE_BEGIN(logger);
     auto &log = AsyncLogger::instance();
+    TRACE_END(logger, "AsyncLogger::instance");
 
     qInstallMessageHandler(customMessageHandler);
     log.logInfo("Starting app");
 
+    TRACE_BEGIN(app);
     QGuiApplication app(argc, argv);
+    TRACE_END(app, "QGuiApplication");
+
+    // Имя главного потока - имя процесса, его не меняем
+    ThreadTopology::Scope topology(ThreadTopology::Render, "gui", false);
+
+    TRACE_BEGIN(engine);
     QQmlApplicationEngine engine;
+    TRACE_END(engine, "QQmlApplicationEngine");
 
+    TRACE_BEGIN(appEngine);
     AppEngine appEngine;
+    TRACE_END(appEngine, "AppEngine");
+
+    // Дальнейшие выделения потока GUI, кроме помеченных подсистем,
+    // приходятся на движок QML
+    ALLOC_THREAD_TAG(QmlEngine);
 
     const QUrl url(QStringLiteral("qrc:/AppQml/qml/Main.qml"));
 
@@ -51,7 +76,101 @@ int main(int argc, char *argv[])
                                      "Logic",
                                      "Access to enums & structures");
 
-    engine.load(url);
+    qmlRegisterType<TimeSeries>("byhat.charts", 1, 0, "TimeSeries");
+    qmlRegisterType<LineSeriesItem>("byhat.charts", 1, 0, "LineSeries");
+
+    qmlRegisterUncreatableType<PerfMonitor>("byhat.diagnostics", 1, 0,
+                                            "PerfMonitor",
+                                            "Provided by app.perf");
+
+    qmlRegisterUncreatableType<MessagesHandler>("byhat.diagnostics", 1, 0,
+                                                "MessagesHandler",
+                                                "Provided by app.messages");
+
+    {
+        TRACE_SCOPE("QQmlApplicationEngine::load");
+        engine.load(url);
+    }
+
+    // Настройки роли главному потоку - только после загрузки: потоки,
+    // созданные движком QML, не должны унаследовать его ядра и приоритет
+    ThreadTopology::instance().applyMainThread();
+
+    // Время до первого кадра и память на этот момент - основные
+    // показатели скорости загрузки на целевом устройстве
+    if (auto *window = qobject_cast<QQuickWindow *>(engine.rootObjects().value(0))) {
+        QObject::connect(
+            window,
+            &QQuickWindow::frameSwapped,
+            &app,
+            [&startupTimer, &log]() {
+                TRACE_INSTANT("first frame");
+                log.logInfo(QString("First frame after %1 ms, RSS %2 kB")
+                                .arg(startupTimer.elapsed())
+                                .arg(ProcessStats::rssKb()));
+            },
+            static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::SingleShotConnection));
+
+        // Поток отрисовки Qt Quick (при однопоточном цикле - главный поток)
+        QObject::connect(
+            window,
+            &QQuickWindow::sceneGraphInitialized,
+            window,
+            [&app]() {
+                const bool own = QThread::currentThread() != app.thread();
+                ThreadTopology::instance().enter(ThreadTopology::Render, own ? "render" : "gui", own);
+                ALLOC_THREAD_TAG(QmlEngine);
+            },
+            Qt::DirectConnection);
+        QObject::connect(
+            window,
+            &QQuickWindow::sceneGraphInvalidated,
+            window,
+            [&app]() {
+                if (QThread::currentThread() != app.thread()) {
+                    ThreadTopology::instance().leave();
+                }
+            },
+            Qt::DirectConnection);
+
+        // Интервал между кадрами (частота кадров) и стоимость кадра -
+        // от синхронизации сцены до показа, - пишутся прямо из потока
+        // отрисовки. Интервал на простаивающем экране велик, поэтому
+        // время кадра считается только по стоимости отрисовки
+        auto &frameInterval = Metrics::Registry::instance()
+                                  .histogram("frame_interval_ns", "Time between swapped frames, ns");
+        auto &frameRender   = Metrics::Registry::instance()
+                                  .histogram("frame_render_ns", "Scene graph sync to swap, ns");
+        static qint64 frameStartNs = 0; // Только поток отрисовки
+        QObject::connect(
+            window,
+            &QQuickWindow::beforeSynchronizing,
+            window,
+            []() { frameStartNs = Metrics::nowNs(); },
+            Qt::DirectConnection);
+        QObject::connect(
+            window,
+            &QQuickWindow::frameSwapped,
+            window,
+            [&frameInterval, &frameRender, lastSwapNs = qint64(0)]() mutable {
+                const qint64 now = Metrics::nowNs();
+                if (lastSwapNs != 0) {
+                    frameInterval.record(static_cast<quint64>(now - lastSwapNs));
+                }
+                lastSwapNs = now;
+                if (frameStartNs != 0) {
+                    frameRender.record(static_cast<quint64>(now - frameStartNs));
+                    frameStartNs = 0;
+                }
+            },
+            Qt::DirectConnection);
+    }
+
+    const int code = app.exec();
+
+#if defined(QTAPP_ENABLE_TRACING)
+    Trace::Tracer::instance().dumpToDefaultFile();
+#endif
 
-    return app.exec();
+    return code;
 }
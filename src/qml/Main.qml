@@ -33,14 +33,30 @@ ApplicationWindow
             property alias height: main.height
         }
 
+    // Шрифт загружается после первого кадра: первый кадр рисуется
+    // системным шрифтом и не ждёт разбора файла шрифта, затем текст
+    // один раз перекладывается уже с Montserrat
     FontLoader {
         id: montserratBold;
-        source: "qrc:/AppQml/qml/fonts/Montserrat/static/Montserrat-SemiBold.ttf"
+
+        property bool requested: false
+
+        source: requested ? "qrc:/AppQml/qml/fonts/Montserrat/static/Montserrat-SemiBold.ttf" : ""
+    }
+
+    Connections {
+        target: main
+        enabled: !montserratBold.requested
+
+        function onFrameSwapped() {
+            montserratBold.requested = true
+        }
     }
 
     MessageDialog {
         id: msgDialog
         anchors.centerIn: parent
+        messages: app.messages
     }
 
     Rectangle {
@@ -102,7 +118,7 @@ ApplicationWindow
         }
     }
 
-    Loader {
+    PageCache {
         id: loader
 
         width: parent.width - choosePageView.width
@@ -110,31 +126,38 @@ ApplicationWindow
 
         anchors.left: choosePageBg.right
 
-        source: "./pages/FirstPage.qml"
+        pages: [
+            Qt.resolvedUrl("./pages/FirstPage.qml"),
+            Qt.resolvedUrl("./pages/ConfigPage.qml"),
+            Qt.resolvedUrl("./pages/InfoPage.qml")
+        ]
 
         function loadFragment(index) {
-            switch(index) {
-            case 0:
-                loader.source = "./pages/FirstPage.qml"
-                break;
-            case 1:
-                loader.source = "./pages/ConfigPage.qml"
-                break;
-            case 2:
-                loader.source = "./pages/InfoPage.qml"
-                break;
-            default:
-                loader.source = "./pages/FirstPage.qml"
-                break;
+            if (index >= 0 && index < pages.length) {
+                loader.currentIndex = index
+            } else {
+                loader.currentIndex = 0
             }
         }
     }
 
+    // Панель производительности, включается enableDebugMode в config.json
+    PerfHud {
+        anchors.top: parent.top
+        anchors.right: parent.right
+        anchors.margins: 10
+
+        z: 100
+
+        monitor: app.perf
+        visible: app.debugMode
+    }
+
     Connections {
-        target: app
-        function onQmlMessageUpdate(message) {
-            msgDialog.message = message.text
-            msgDialog.open()
+        target: app.messages
+        function onCountChanged() {
+            if (app.messages.count > 0)
+                msgDialog.open()
         }
     }
 
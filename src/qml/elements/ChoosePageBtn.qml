@@ -37,12 +37,23 @@ Item {
 
             anchors.horizontalCenter: parent.horizontalCenter
 
+            // SVG растеризуется сразу в размере кнопки и в фоне,
+            // не задерживая первый кадр
+            sourceSize.width:  width
+            sourceSize.height: height
+            asynchronous: true
+
             source: (blurVisible)? blurPath : ""
 
             Image {
                 id: btnImage
 
                 anchors.fill: parent
+
+                sourceSize.width:  width
+                sourceSize.height: height
+                asynchronous: true
+
                 source: imagePath
             }
         }
@@ -7,12 +7,15 @@ import "../elements"
 Dialog {
     id: errorDialog
 
-    property string message: "Непредвиденная ошибка"
+    // Модель сообщений (app.messages), показываются все неподтверждённые
+    property var messages: null
 
-    width:  msgTxt.width + 20
-    height: dlgBtn.height + msgTxt.height + 20
+    // Список ограничен по высоте окна и прокручивается,
+    // кнопка ОК остаётся видимой при любом числе сообщений
+    readonly property int maxListHeight: (parent ? parent.height : 850) - dlgBtn.height - msgColumn.spacing - 100
 
-    // height: 200
+    width:  msgColumn.width + 20
+    height: msgColumn.height + 20
 
     modal: true
 
@@ -23,20 +26,40 @@ Dialog {
     }
 
         Column {
+            id: msgColumn
             spacing: 15
             anchors.centerIn: parent
 
-            Text {
-                id: msgTxt
-                text: errorDialog.message
+            ListView {
+                id: msgList
 
-                font.pointSize: 34
-                font.family: montserratBold.name
+                width: Math.min((errorDialog.parent ? errorDialog.parent.width : 1280) - 100, 1000)
+                height: Math.min(contentHeight, errorDialog.maxListHeight)
 
-                color: "#778cdd"
+                clip: true
+                spacing: 15
+                boundsBehavior: Flickable.StopAtBounds
+                model: errorDialog.messages
 
-                horizontalAlignment: Text.AlignHCenter
-                verticalAlignment: Text.AlignVCenter
+                ScrollBar.vertical: ScrollBar {
+                    policy: msgList.contentHeight > msgList.height ? ScrollBar.AlwaysOn : ScrollBar.AsNeeded
+                }
+
+                delegate: Text {
+                    width: ListView.view.width
+
+                    text: model.repeat > 1 ? model.text + " (×" + model.repeat + ")"
+                                           : model.text
+
+                    font.pointSize: 34
+                    font.family: montserratBold.name
+
+                    color: "#778cdd"
+
+                    wrapMode: Text.Wrap
+                    horizontalAlignment: Text.AlignHCenter
+                    verticalAlignment: Text.AlignVCenter
+                }
             }
 
             ActionButton {
@@ -49,4 +72,6 @@ Dialog {
                 onClicked: errorDialog.close();
             }
         }
+
+    onClosed: if (messages) messages.dismissAll()
 }
@@ -0,0 +1,131 @@
+import QtQuick
+
+
+// Кэш страниц: страницы не пересоздаются при каждом переключении,
+// а остаются жить (не более maxAlive штук, вытесняется давно не
+// показанная). Текущая страница создаётся синхронно, остальные
+// догружаются асинхронно после первого кадра.
+Item {
+    id: cache
+
+    property var  pages: []                 // адреса страниц (через Qt.resolvedUrl)
+    property int  currentIndex: 0           // индекс показываемой страницы
+    property int  maxAlive: pages.length    // сколько страниц держать созданными
+    property bool preload: true             // догружать остальные страницы после первого кадра
+
+    // Время создания страниц, мс: { "адрес страницы": время }
+    property var  loadTimes: ({})
+
+    signal pageLoaded(int index, int msec)
+
+    property var  _lru: []        // индексы созданных страниц, последний - самый свежий
+    property int  _preloadNext: 0
+    property bool _firstFrameShown: false
+
+    function _touch(index) {
+        var lru = _lru.filter(function(i) { return i !== index })
+        lru.push(index)
+
+        while (lru.length > Math.max(maxAlive, 1)) {
+            var evicted = lru.shift()
+            var loader = repeater.itemAt(evicted)
+            if (loader) {
+                loader.active = false
+            }
+        }
+        _lru = lru
+    }
+
+    function _activate(index) {
+        var loader = repeater.itemAt(index)
+        if (!loader) {
+            return
+        }
+
+        if (!loader.active) {
+            loader.startedAt = Date.now()
+            loader.active = true
+        }
+        _touch(index)
+    }
+
+    function _preloadStep() {
+        // Страницы догружаются по одной, чтобы не конкурировать
+        // с отрисовкой текущей страницы
+        while (_preloadNext < pages.length && _lru.length < maxAlive) {
+            var loader = repeater.itemAt(_preloadNext++)
+            if (loader && !loader.active) {
+                loader.startedAt = Date.now()
+                loader.active = true
+                cache._lru = [loader.index].concat(cache._lru)
+                return
+            }
+        }
+    }
+
+    onCurrentIndexChanged: _activate(currentIndex)
+
+    Repeater {
+        id: repeater
+
+        model: cache.pages.length
+
+        delegate: Loader {
+            required property int index
+
+            property double startedAt: 0
+
+            anchors.fill: parent
+
+            active: false
+            source: cache.pages[index]
+
+            // Незавершённая асинхронная загрузка страницы, ставшей
+            // текущей, доделывается синхронно
+            asynchronous: index !== cache.currentIndex
+            visible: index === cache.currentIndex && status === Loader.Ready
+
+            onStatusChanged: {
+                if (status === Loader.Ready) {
+                    var msec = Date.now() - startedAt
+
+                    var times = Object.assign({}, cache.loadTimes)
+                    times[source.toString()] = msec
+                    cache.loadTimes = times
+
+                    console.info("Page " + source + " created in " + msec + " ms")
+                    cache.pageLoaded(index, msec)
+
+                    if (cache.preload && cache._firstFrameShown) {
+                        preloadTimer.restart()
+                    }
+                } else if (status === Loader.Error) {
+                    console.warn("Failed to load page " + source)
+                }
+            }
+        }
+
+        Component.onCompleted: cache._activate(cache.currentIndex)
+    }
+
+    // Догрузка начинается только после первого показанного кадра
+    Connections {
+        id: firstFrame
+
+        target: cache.Window.window
+
+        function onFrameSwapped() {
+            firstFrame.enabled = false
+            cache._firstFrameShown = true
+            if (cache.preload) {
+                preloadTimer.restart()
+            }
+        }
+    }
+
+    Timer {
+        id: preloadTimer
+        interval: 0
+        onTriggered: cache._preloadStep()
+    }
+}
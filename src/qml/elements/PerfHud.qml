@@ -0,0 +1,82 @@
+import QtQuick
+
+
+// Панель производительности поверх интерфейса. Данные приходят
+// из PerfMonitor (app.perf) два раза в секунду; пока панель скрыта,
+// монитор выключен и ничего не собирает.
+Rectangle {
+    id: hud
+
+    property var monitor: null
+
+    width: content.width + 20
+    height: content.height + 20
+
+    radius: 4
+    color: "#b0000000"
+
+    function _ms(value) {
+        return value.toFixed(1) + " ms"
+    }
+
+    Column {
+        id: content
+
+        x: 10
+        y: 10
+
+        spacing: 2
+
+        Text {
+            color: "white"
+            font.family: "monospace"
+            font.pixelSize: 13
+            text: hud.monitor
+                  ? "render p50 " + hud._ms(hud.monitor.frameP50Ms)
+                    + "  p99 " + hud._ms(hud.monitor.frameP99Ms)
+                    + "  " + hud.monitor.fps.toFixed(0) + " fps"
+                  : ""
+        }
+
+        Text {
+            // Задержка цикла событий больше кадра - заметные подвисания
+            color: hud.monitor && hud.monitor.loopLatencyMaxMs > 16 ? "#ff8080" : "white"
+            font.family: "monospace"
+            font.pixelSize: 13
+            text: hud.monitor
+                  ? "loop   p99 " + hud._ms(hud.monitor.loopLatencyP99Ms)
+                    + "  max " + hud._ms(hud.monitor.loopLatencyMaxMs)
+                  : ""
+        }
+
+        Text {
+            color: "white"
+            font.family: "monospace"
+            font.pixelSize: 13
+            text: hud.monitor
+                  ? "queue  log " + hud.monitor.loggerQueue
+                    + "  msg " + hud.monitor.messagesQueue
+                  : ""
+        }
+
+        Text {
+            color: "white"
+            font.family: "monospace"
+            font.pixelSize: 13
+            text: hud.monitor ? "rss    " + hud.monitor.rssMb.toFixed(1) + " MB" : ""
+        }
+
+        Repeater {
+            model: hud.monitor ? hud.monitor.threads : []
+
+            delegate: Text {
+                required property var modelData
+
+                color: "#c0c0c0"
+                font.family: "monospace"
+                font.pixelSize: 12
+                text: ("       " + modelData.cpu.toFixed(0)).slice(-7) + "%  " + modelData.name
+            }
+        }
+    }
+}
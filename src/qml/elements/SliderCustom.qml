@@ -11,7 +11,21 @@ Slider
 
     value: 100
 
-    onMoved: console.log(value)
+    // Имя параметра для сохранения через журнал (app.setParameter),
+    // пусто - значение не сохраняется
+    property string parameterKey: ""
+
+    Component.onCompleted: {
+        if (parameterKey !== "") {
+            value = app.parameter(parameterKey, value)
+        }
+    }
+
+    onMoved: {
+        if (parameterKey !== "") {
+            app.setParameter(parameterKey, value)
+        }
+    }
 
     background: Rectangle
     {
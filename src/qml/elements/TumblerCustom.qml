@@ -5,6 +5,24 @@ import QtQuick.Controls
 Tumbler {
     id: control
 
+    // Имя параметра для сохранения через журнал (app.setParameter),
+    // пусто - положение не сохраняется
+    property string parameterKey: ""
+    property bool   _restored: false
+
+    Component.onCompleted: {
+        if (parameterKey !== "") {
+            currentIndex = app.parameter(parameterKey, currentIndex)
+        }
+        _restored = true
+    }
+
+    onCurrentIndexChanged: {
+        if (_restored && parameterKey !== "") {
+            app.setParameter(parameterKey, currentIndex)
+        }
+    }
+
     font.pointSize: 34
     font.family: montserratBold.name
 
@@ -20,6 +20,7 @@ Item {
 
         onValueUpdate: {
             clckText.value = numpad.value
+            app.setParameter("textValue", clckText.value)
         }
     }
 
@@ -53,7 +54,7 @@ Item {
 
         ClickableText {
             id: clckText
-            value: 100
+            value: app.parameter("textValue", 100)
             onClicked: numpad.open();
         }
 
@@ -82,6 +82,7 @@ Item {
 
         TumblerCustom {
             model: 24
+            parameterKey: "hour"
         }
 
         ActionButton {
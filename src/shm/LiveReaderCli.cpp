@@ -0,0 +1,125 @@
+// Пример читателя живого потока отсчётов из разделяемой памяти.
+// Не зависит от Qt: собирается с одной библиотекой ShmRing.hpp.
+//
+//   QTemplateAppLiveReader [--name /qtapp-live] [--oldest] [--status] [--count N]
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "ShmRing.hpp"
+
+static void usage(const char *argv0) {
+    std::fprintf(stderr,
+                 "Usage: %s [--name NAME] [--oldest] [--status] [--count N]\n"
+                 "  --name NAME  shared memory segment, default /qtapp-live\n"
+                 "  --oldest     start from the oldest block still in the ring\n"
+                 "  --status     print application status once and exit\n"
+                 "  --count N    exit after N blocks, default - run forever\n",
+                 argv0);
+}
+
+static void printStatus(const ShmRing::Reader &reader) {
+    ShmRing::Status status;
+    while (!reader.status(status)) {
+        std::this_thread::yield();
+    }
+
+    const double ageMs = (ShmRing::nowNs() - status.updatedNs) / 1e6;
+    std::printf("writer pid %" PRIu64 ", status age %.1f ms, samples %" PRIu64 ", debug %s\n",
+                reader.header()->writerPid, ageMs, status.samplesTotal,
+                (status.flags & ShmRing::STATUS_DEBUG_MODE) ? "on" : "off");
+    if (status.messageType >= 0) {
+        std::printf("last message (type %d): %.*s\n", status.messageType,
+                    static_cast<int>(ShmRing::MESSAGE_SIZE), status.message);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string   name = "/qtapp-live";
+    bool          fromOldest = false;
+    bool          statusOnly = false;
+    std::uint64_t limit = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        if (!std::strcmp(arg, "--name") && i + 1 < argc) {
+            name = argv[++i];
+        } else if (!std::strcmp(arg, "--oldest")) {
+            fromOldest = true;
+        } else if (!std::strcmp(arg, "--status")) {
+            statusOnly = true;
+        } else if (!std::strcmp(arg, "--count") && i + 1 < argc) {
+            limit = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    ShmRing::Reader reader;
+    if (!reader.open(name, fromOldest)) {
+        std::fprintf(stderr, "Cannot open live channel %s: %s\n", name.c_str(), std::strerror(errno));
+        return 1;
+    }
+
+    if (statusOnly) {
+        printStatus(reader);
+        return 0;
+    }
+
+    std::printf("%12s %14s %6s %12s %12s %12s\n", "seq", "t0, s", "count", "min", "max", "mean");
+
+    std::uint64_t blocks = 0;
+    while (limit == 0 || blocks < limit) {
+        // Статистика блока считается прямо в разделяемой памяти
+        float  lo = 0, hi = 0;
+        double sum = 0;
+        std::uint64_t seq = 0;
+        double t0 = 0;
+        std::uint32_t count = 0;
+
+        const ShmRing::Reader::Result result = reader.visit([&](const ShmRing::Slot &slot) {
+            seq   = slot.sequence;
+            t0    = slot.t0;
+            count = std::min<std::uint32_t>(slot.count, ShmRing::MAX_SAMPLES);
+            lo = hi = count ? slot.samples[0] : 0.0f;
+            sum = 0;
+            for (std::uint32_t i = 0; i < count; ++i) {
+                lo = std::min(lo, slot.samples[i]);
+                hi = std::max(hi, slot.samples[i]);
+                sum += slot.samples[i];
+            }
+        });
+
+        switch (result) {
+        case ShmRing::Reader::Ok:
+            std::printf("%12" PRIu64 " %14.6f %6u %12.5f %12.5f %12.5f\n",
+                        seq, t0, count, lo, hi, count ? sum / count : 0.0);
+            ++blocks;
+            break;
+        case ShmRing::Reader::Overrun:
+            std::printf("overrun: lost %" PRIu64 " blocks (%" PRIu64 " total)\n",
+                        reader.lost(), reader.lostTotal());
+            break;
+        case ShmRing::Reader::Empty:
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            break;
+        case ShmRing::Reader::Restarted:
+            // Новый сегмент мог быть ещё не инициализирован: повтор до успеха
+            std::printf("writer restarted, reconnecting\n");
+            while (!reader.open(name, true)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            std::printf("reconnected to writer pid %" PRIu64 "\n", reader.header()->writerPid);
+            break;
+        }
+    }
+
+    return 0;
+}
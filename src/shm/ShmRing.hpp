@@ -0,0 +1,456 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Кольцо отсчётов в разделяемой памяти POSIX: один писатель, много читателей
+ * @details Библиотека без зависимостей от Qt: её подключают и приложение
+ * (писатель), и сторонние процессы на устройстве (читатели).
+ *
+ * Сегмент shm_open(name) состоит из заголовка, блока состояния и
+ * slotCount слотов (степень двойки). Писатель кладёт блок отсчётов в слот
+ * sequence % slotCount и увеличивает head. Каждый слот защищён версией
+ * (seqlock): на время записи версия нечётная (2 * sequence + 1), после
+ * записи - 2 * sequence + 2. Читатель сверяет версию до и после чтения,
+ * поэтому видит либо целый блок, либо узнаёт, что слот уже перезаписан.
+ * Читатели ничего не пишут в сегмент и не могут задержать писателя;
+ * медленный читатель обнаруживает переполнение по номерам и получает
+ * количество пропущенных блоков.
+ *
+ * Блок состояния (сердцебиение, счётчики, последнее сообщение GUI)
+ * защищён такой же версией.
+ *
+ * Перезапущенный писатель удаляет сегмент и создаёт новый с тем же
+ * именем; отображение старого сегмента у читателя остаётся, но больше
+ * не обновляется. Читатель, не получающий новых блоков, время от времени
+ * сверяет, тот же ли объект стоит за именем, и сообщает о перезапуске
+ * результатом Restarted - после него нужно заново вызвать open().
+ */
+namespace ShmRing {
+
+    static constexpr std::uint32_t MAGIC       = 0x52535451; //!< "QTSR"
+    static constexpr std::uint32_t VERSION     = 1;
+    static constexpr std::size_t   MAX_SAMPLES = 512;        //!< Отсчётов в одном слоте
+    static constexpr std::size_t   MESSAGE_SIZE = 128;       //!< Байт на текст сообщения
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                  "64-bit atomics must be lock-free to live in shared memory");
+
+    /**
+     * @brief Монотонное время, нс (CLOCK_MONOTONIC, общее для процессов)
+     */
+    inline std::uint64_t nowNs() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /**
+     * @brief Слот с блоком отсчётов одного канала
+     */
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> version;  //!< Версия seqlock, см. описание пространства имён
+        std::uint64_t              sequence; //!< Номер блока
+        double                     t0;       //!< Время первого отсчёта, с
+        double                     dt;       //!< Период дискретизации, с
+        std::uint32_t              channel;  //!< Номер канала
+        std::uint32_t              count;    //!< Отсчётов в блоке, не более MAX_SAMPLES
+        float                      samples[MAX_SAMPLES];
+    };
+
+    /**
+     * @brief Состояние приложения
+     */
+    struct Status {
+        std::uint64_t updatedNs    = 0; //!< Время обновления, nowNs()
+        std::uint64_t samplesTotal = 0; //!< Отсчётов опубликовано с запуска
+        std::uint32_t flags        = 0; //!< Флаги состояния приложения (STATUS_*)
+        std::int32_t  messageType  = -1; //!< Тип последнего сообщения GUI, -1 - нет
+        char          message[MESSAGE_SIZE] = {}; //!< Текст последнего сообщения GUI, UTF-8
+    };
+
+    static constexpr std::uint32_t STATUS_DEBUG_MODE = 1u << 0; //!< Включён режим отладки
+
+    /**
+     * @brief Заголовок сегмента
+     */
+    struct alignas(64) Header {
+        std::atomic<std::uint32_t> magic;      //!< MAGIC после полной инициализации
+        std::uint32_t              version;    //!< VERSION
+        std::uint32_t              slotCount;  //!< Количество слотов, степень двойки
+        std::uint32_t              slotSize;   //!< sizeof(Slot) писателя
+        std::uint64_t              writerPid;  //!< Процесс-писатель
+        std::uint64_t              createdNs;  //!< Время создания сегмента
+
+        alignas(64) std::atomic<std::uint64_t> head;          //!< Номер следующего блока
+        alignas(64) std::atomic<std::uint64_t> statusVersion; //!< Версия seqlock состояния
+        Status                                 status;        //!< Состояние приложения
+    };
+
+    inline std::size_t segmentSize(std::uint32_t slotCount) {
+        return sizeof(Header) + std::size_t(slotCount) * sizeof(Slot);
+    }
+
+    inline Slot *slotArray(Header *header) {
+        return reinterpret_cast<Slot *>(reinterpret_cast<char *>(header) + sizeof(Header));
+    }
+
+    inline const Slot *slotArray(const Header *header) {
+        return reinterpret_cast<const Slot *>(reinterpret_cast<const char *>(header) + sizeof(Header));
+    }
+
+    /**
+     * @brief Писатель: создаёт сегмент и публикует блоки
+     * @details publish() вызывается из одного потока; setStatus() -
+     * тоже из одного (или под внешней блокировкой)
+     */
+    class Writer {
+    public:
+        Writer() = default;
+        ~Writer() { close(); }
+
+        Writer(const Writer &) = delete;
+        Writer &operator=(const Writer &) = delete;
+
+        /**
+         * @brief Создание сегмента
+         * @param name Имя сегмента POSIX, например "/qtapp-live"
+         * @param slotCount Количество слотов, округляется вверх до степени двойки
+         * @return false при ошибке, текст в errno
+         * @details Сегмент с тем же именем, оставшийся после аварийного
+         * завершения, удаляется: подключённые к нему читатели перестанут
+         * получать данные и должны переподключиться
+         */
+        bool create(const std::string &name, std::uint32_t slotCount) {
+            close();
+
+            std::uint32_t count = 1;
+            while (count < std::max<std::uint32_t>(slotCount, 2)) {
+                count <<= 1;
+            }
+
+            ::shm_unlink(name.c_str());
+            const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+            if (fd < 0) {
+                return false;
+            }
+
+            const std::size_t size = segmentSize(count);
+            if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                ::close(fd);
+                ::shm_unlink(name.c_str());
+                return false;
+            }
+
+            void *memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (memory == MAP_FAILED) {
+                ::shm_unlink(name.c_str());
+                return false;
+            }
+
+            // Память после ftruncate заполнена нулями: версии слотов 0,
+            // то есть ни один слот ещё не записан
+            m_header    = static_cast<Header *>(memory);
+            m_size      = size;
+            m_name      = name;
+            m_mask      = count - 1;
+            m_sequence  = 0;
+
+            m_header->version   = VERSION;
+            m_header->slotCount = count;
+            m_header->slotSize  = sizeof(Slot);
+            m_header->writerPid = static_cast<std::uint64_t>(::getpid());
+            m_header->createdNs = nowNs();
+            m_header->magic.store(MAGIC, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Удаление сегмента
+         */
+        void close() {
+            if (!m_header) {
+                return;
+            }
+            ::munmap(m_header, m_size);
+            ::shm_unlink(m_name.c_str());
+            m_header = nullptr;
+        }
+
+        bool isOpen() const { return m_header != nullptr; }
+
+        /**
+         * @brief Публикация отсчётов канала
+         * @details Блоки длиннее MAX_SAMPLES делятся на несколько слотов
+         */
+        void publish(std::uint32_t channel, double t0, double dt, const float *samples, std::size_t count) {
+            if (!m_header) {
+                return;
+            }
+
+            for (std::size_t offset = 0; offset < count; offset += MAX_SAMPLES) {
+                const std::size_t n = std::min(MAX_SAMPLES, count - offset);
+                const std::uint64_t seq = m_sequence++;
+                Slot &slot = slotArray(m_header)[seq & m_mask];
+
+                slot.version.store(2 * seq + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+
+                slot.sequence = seq;
+                slot.t0       = t0 + offset * dt;
+                slot.dt       = dt;
+                slot.channel  = channel;
+                slot.count    = static_cast<std::uint32_t>(n);
+                std::memcpy(slot.samples, samples + offset, n * sizeof(float));
+
+                slot.version.store(2 * seq + 2, std::memory_order_release);
+                m_header->head.store(seq + 1, std::memory_order_release);
+
+                m_samplesTotal += n;
+            }
+        }
+
+        /**
+         * @brief Обновление блока состояния
+         * @details Поля updatedNs и samplesTotal заполняются писателем
+         */
+        void setStatus(Status status) {
+            if (!m_header) {
+                return;
+            }
+            status.updatedNs    = nowNs();
+            status.samplesTotal = m_samplesTotal;
+
+            const std::uint64_t v = m_header->statusVersion.load(std::memory_order_relaxed);
+            m_header->statusVersion.store(v + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(&m_header->status, &status, sizeof(Status));
+            m_header->statusVersion.store(v + 2, std::memory_order_release);
+        }
+
+    private:
+        Header       *m_header   = nullptr;
+        std::size_t   m_size     = 0;
+        std::string   m_name;
+        std::uint64_t m_mask     = 0;
+        std::uint64_t m_sequence = 0;      //!< Номер следующего блока, только писатель
+        std::uint64_t m_samplesTotal = 0;  //!< Опубликовано отсчётов
+    };
+
+    /**
+     * @brief Читатель: подключается к сегменту только на чтение
+     */
+    class Reader {
+    public:
+        /**
+         * @brief Результат чтения
+         */
+        enum Result {
+            Ok,      //!< Блок прочитан
+            Empty,   //!< Новых блоков нет
+            Overrun, //!< Читатель отстал, блоки пропущены (см. lost())
+            Restarted //!< Писатель пересоздал сегмент, нужно переподключиться через open()
+        };
+
+        static constexpr std::uint64_t RESTART_CHECK_NS = 100'000'000; //!< Период проверки перезапуска, нс
+
+        Reader() = default;
+        ~Reader() { close(); }
+
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+        /**
+         * @brief Подключение к сегменту
+         * @param fromOldest true - начать с самого старого блока в кольце,
+         * false - только новые блоки
+         * @return false, если сегмента нет или он несовместим
+         */
+        bool open(const std::string &name, bool fromOldest = false) {
+            close();
+
+            const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+            if (fd < 0) {
+                return false;
+            }
+
+            struct stat st {};
+            if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+                ::close(fd);
+                return false;
+            }
+
+            void *memory = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (memory == MAP_FAILED) {
+                return false;
+            }
+
+            m_header = static_cast<const Header *>(memory);
+            m_size   = static_cast<std::size_t>(st.st_size);
+            m_name   = name;
+            m_device = st.st_dev;
+            m_inode  = st.st_ino;
+            m_checkedNs = nowNs();
+
+            if (m_header->magic.load(std::memory_order_acquire) != MAGIC ||
+                m_header->version != VERSION ||
+                m_header->slotSize != sizeof(Slot) ||
+                segmentSize(m_header->slotCount) > m_size) {
+                close();
+                return false;
+            }
+
+            const std::uint64_t head = m_header->head.load(std::memory_order_acquire);
+            m_next = (fromOldest && head > m_header->slotCount) ? head - m_header->slotCount
+                   : (fromOldest ? 0 : head);
+            return true;
+        }
+
+        void close() {
+            if (m_header) {
+                ::munmap(const_cast<Header *>(m_header), m_size);
+                m_header = nullptr;
+            }
+        }
+
+        bool isOpen() const { return m_header != nullptr; }
+
+        const Header *header() const { return m_header; }
+
+        /**
+         * @brief Обработка следующего блока прямо в разделяемой памяти
+         * @param fn Вызывается с const Slot&; результат работы fn
+         * действителен, только если возвращено Ok
+         * @details Копирования нет: fn читает слот на месте, после чего
+         * версия слота проверяется повторно. При Overrun номер чтения
+         * переносится на самый старый ещё не перезаписанный блок
+         */
+        template <typename Fn>
+        Result visit(Fn &&fn) {
+            const std::uint64_t head = m_header->head.load(std::memory_order_acquire);
+            if (m_next >= head) {
+                return replaced() ? Restarted : Empty;
+            }
+
+            const std::uint64_t slotCount = m_header->slotCount;
+            if (head - m_next > slotCount) {
+                return resync(head);
+            }
+
+            const Slot &slot = slotArray(m_header)[m_next & (slotCount - 1)];
+            const std::uint64_t expected = 2 * m_next + 2;
+            if (slot.version.load(std::memory_order_acquire) != expected) {
+                return resync(m_header->head.load(std::memory_order_acquire));
+            }
+
+            fn(slot);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) != expected) {
+                return resync(m_header->head.load(std::memory_order_acquire));
+            }
+
+            ++m_next;
+            return Ok;
+        }
+
+        /**
+         * @brief Копирование следующего блока
+         */
+        Result read(Slot &out) {
+            return visit([&out](const Slot &slot) {
+                out.sequence = slot.sequence;
+                out.t0       = slot.t0;
+                out.dt       = slot.dt;
+                out.channel  = slot.channel;
+                out.count    = std::min<std::uint32_t>(slot.count, MAX_SAMPLES);
+                std::memcpy(out.samples, slot.samples, out.count * sizeof(float));
+            });
+        }
+
+        /**
+         * @brief Чтение блока состояния
+         * @return false, если писатель обновлял состояние во время чтения
+         * (можно повторить)
+         */
+        bool status(Status &out) const {
+            const std::uint64_t v1 = m_header->statusVersion.load(std::memory_order_acquire);
+            if (v1 & 1) {
+                return false;
+            }
+            std::memcpy(&out, &m_header->status, sizeof(Status));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return m_header->statusVersion.load(std::memory_order_relaxed) == v1;
+        }
+
+        /**
+         * @brief Блоков пропущено при последнем Overrun и всего
+         */
+        std::uint64_t lost()      const { return m_lost; }
+        std::uint64_t lostTotal() const { return m_lostTotal; }
+
+        /**
+         * @brief Номер следующего читаемого блока
+         */
+        std::uint64_t position() const { return m_next; }
+
+        /**
+         * @brief Стоит ли за именем уже другой сегмент
+         * @details Сравниваются устройство и inode объекта shm с теми, что
+         * были при open(). Проверка - системные вызовы, поэтому visit()
+         * делает её только без новых блоков и не чаще RESTART_CHECK_NS.
+         * Удалённый, но ещё не пересозданный сегмент перезапуском не
+         * считается: писатель мог ещё не успеть его создать
+         */
+        bool replaced(bool force = false) {
+            const std::uint64_t now = nowNs();
+            if (!force && now - m_checkedNs < RESTART_CHECK_NS) {
+                return false;
+            }
+            m_checkedNs = now;
+
+            const int fd = ::shm_open(m_name.c_str(), O_RDONLY, 0);
+            if (fd < 0) {
+                return false;
+            }
+            struct stat st {};
+            const bool ok = ::fstat(fd, &st) == 0;
+            ::close(fd);
+            return ok && (st.st_dev != m_device || st.st_ino != m_inode);
+        }
+
+    private:
+        Result resync(std::uint64_t head) {
+            // Самый старый блок может перезаписываться прямо сейчас,
+            // поэтому читатель отступает на один слот дальше от писателя
+            const std::uint64_t slotCount = m_header->slotCount;
+            const std::uint64_t oldest = (head + 1 > slotCount) ? head + 1 - slotCount : 0;
+            m_lost = (oldest > m_next) ? oldest - m_next : 1;
+            m_lostTotal += m_lost;
+            m_next = std::max(oldest, m_next + 1);
+            return Overrun;
+        }
+
+        const Header *m_header    = nullptr;
+        std::size_t   m_size      = 0;
+        std::uint64_t m_next      = 0; //!< Номер следующего блока
+        std::uint64_t m_lost      = 0;
+        std::uint64_t m_lostTotal = 0;
+        std::string   m_name;          //!< Имя сегмента для проверки перезапуска
+        dev_t         m_device    = 0; //!< Устройство и inode сегмента при open()
+        ino_t         m_inode     = 0;
+        std::uint64_t m_checkedNs = 0; //!< Время последней проверки перезапуска
+    };
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+/**
+ * @brief Минимальные проверки для тестов без зависимостей
+ * @details CHECK не прерывает тест: печатает место и условие и
+ * увеличивает счётчик ошибок. main() теста возвращает Check::result(),
+ * ненулевой код означает провал для ctest.
+ */
+namespace Check {
+
+    inline int &failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline int result() {
+        if (failures() > 0) {
+            std::fprintf(stderr, "%d check(s) failed\n", failures());
+            return 1;
+        }
+        std::fprintf(stderr, "all checks passed\n");
+        return 0;
+    }
+
+    /**
+     * @brief Сравнение с относительной погрешностью
+     */
+    inline bool near(double a, double b, double tolerance) {
+        return std::fabs(a - b) <= tolerance * std::fmax(1.0, std::fmax(std::fabs(a), std::fabs(b)));
+    }
+}
+
+#define CHECK(condition)                                                              \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++Check::failures();                                                      \
+        }                                                                             \
+    } while (0)
+
+#define CHECK_MSG(condition, ...)                                                     \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #condition); \
+            std::fprintf(stderr, __VA_ARGS__);                                        \
+            std::fprintf(stderr, "\n");                                               \
+            ++Check::failures();                                                      \
+        }                                                                             \
+    } while (0)
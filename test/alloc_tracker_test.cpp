@@ -0,0 +1,167 @@
+// Учёт выделений по подсистемам: malloc, calloc, realloc, выделения с
+// выравниванием и operator new приписываются метке, а освобождение из
+// другого потока под другой меткой возвращает удерживаемую память
+// подсистемы к исходной. Собирает AllocTracker.cpp с QTAPP_ALLOC_TRACKING
+// сам, без Qt; без glibc malloc не заменяется, и тест пропускается.
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "common/AllocTracker.hpp"
+#include "Check.hpp"
+
+#if defined(QTAPP_ALLOC_TRACKING) && defined(__GLIBC__)
+
+namespace {
+
+bool aligned(const void *pointer, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0;
+}
+
+bool filled(const void *pointer, std::size_t size, unsigned char value) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(pointer);
+    for (std::size_t i = 0; i < size; ++i) {
+        if (bytes[i] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Блоки всех видов под меткой Config, освобождение в другом потоке
+ */
+void testLiveBytesReturnToZero() {
+    const AllocTracker::TagStats config = AllocTracker::stats(AllocTracker::Config);
+    const AllocTracker::TagStats logger = AllocTracker::stats(AllocTracker::Logger);
+
+    // Вектор растёт вне области метки
+    std::vector<void *> blocks;
+    blocks.reserve(16);
+    std::int64_t expected = 0;
+    {
+        ALLOC_SCOPE(Config);
+
+        void *plain = std::malloc(100);
+        CHECK(plain && aligned(plain, alignof(std::max_align_t)));
+        CHECK(malloc_usable_size(plain) >= 100);
+        blocks.push_back(plain);
+        expected += 100;
+
+        void *zeroed = std::calloc(10, 30);
+        CHECK(zeroed && filled(zeroed, 300, 0));
+        blocks.push_back(zeroed);
+        expected += 300;
+
+        // Рост и сжатие: блок остаётся за Config, содержимое сохраняется
+        void *grown = std::malloc(50);
+        std::memset(grown, 0x5a, 50);
+        grown = std::realloc(grown, 5000);
+        CHECK(grown && filled(grown, 50, 0x5a));
+        grown = std::realloc(grown, 20);
+        CHECK(grown && filled(grown, 20, 0x5a));
+        blocks.push_back(grown);
+        expected += 20;
+
+        void *page = nullptr;
+        CHECK(posix_memalign(&page, 64, 200) == 0);
+        CHECK(page && aligned(page, 64));
+        blocks.push_back(page);
+        expected += 200;
+
+        // Выровненный блок после realloc - обычный, но той же подсистемы
+        void *wide = std::aligned_alloc(128, 256);
+        CHECK(wide && aligned(wide, 128));
+        std::memset(wide, 0x33, 256);
+        wide = std::realloc(wide, 1000);
+        CHECK(wide && filled(wide, 256, 0x33));
+        blocks.push_back(wide);
+        expected += 1000;
+
+        // Память, выделенная внутри библиотеки C
+        char *copy = strdup("allocation tracking");
+        CHECK(copy && std::strcmp(copy, "allocation tracking") == 0);
+        blocks.push_back(copy);
+        expected += std::strlen(copy) + 1;
+
+        void *empty = std::realloc(nullptr, 40);
+        CHECK(std::realloc(empty, 0) == nullptr);
+
+        char *array = new char[77];
+        blocks.push_back(array);
+        expected += 77;
+    }
+
+    const AllocTracker::TagStats held = AllocTracker::stats(AllocTracker::Config);
+    CHECK_MSG(held.liveBytes - config.liveBytes == expected, "live %lld, expected %lld",
+              static_cast<long long>(held.liveBytes - config.liveBytes),
+              static_cast<long long>(expected));
+
+    std::thread releaser([&blocks]() {
+        ALLOC_SCOPE(Logger);
+        for (std::size_t i = 0; i + 1 < blocks.size(); ++i) {
+            std::free(blocks[i]);
+        }
+        delete[] static_cast<char *>(blocks.back());
+    });
+    releaser.join();
+
+    const AllocTracker::TagStats after = AllocTracker::stats(AllocTracker::Config);
+    CHECK_MSG(after.liveBytes == config.liveBytes, "config live bytes %lld, was %lld",
+              static_cast<long long>(after.liveBytes), static_cast<long long>(config.liveBytes));
+    CHECK(after.allocations - config.allocations == after.frees - config.frees);
+    CHECK(after.allocations > config.allocations);
+    CHECK(AllocTracker::stats(AllocTracker::Logger).liveBytes == logger.liveBytes);
+}
+
+/**
+ * @brief Ошибки выделения как у glibc, без изменения счётчиков
+ */
+void testFailures() {
+    const AllocTracker::TagStats before = AllocTracker::stats(AllocTracker::Untagged);
+    // Размеры не известны компилятору: иначе предупреждение о заведомо большом выделении
+    volatile std::size_t huge = SIZE_MAX - 8;
+
+    errno = 0;
+    CHECK(std::calloc(huge / 2, 4) == nullptr && errno == ENOMEM);
+    errno = 0;
+    CHECK(std::malloc(huge) == nullptr && errno == ENOMEM);
+
+    void *block = std::malloc(8);
+    errno = 0;
+    CHECK(std::realloc(block, huge) == nullptr && errno == ENOMEM);
+    std::free(block);
+
+    void *pointer = nullptr;
+    CHECK(posix_memalign(&pointer, 24, 64) == EINVAL);
+    CHECK(std::aligned_alloc(48, 64) == nullptr && errno == EINVAL);
+
+    const AllocTracker::TagStats after = AllocTracker::stats(AllocTracker::Untagged);
+    CHECK(after.liveBytes == before.liveBytes);
+}
+
+}
+
+int main() {
+    testLiveBytesReturnToZero();
+    testFailures();
+    return Check::result();
+}
+
+#else
+
+int main() {
+    std::fprintf(stderr, "malloc is not tracked in this build, test skipped\n");
+    return 77;
+}
+
+#endif
@@ -0,0 +1,126 @@
+// Пропускная способность ядер и звеньев фильтрации, отсчётов в секунду.
+// Не тест: собирается рядом с тестами и запускается вручную,
+//   dsp_kernels_bench [размер блока]
+// Колонка "scalar" - скалярные эталоны ядер; звенья в скалярной сборке - -DQTAPP_DSP_SIMD=OFF.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "dsp/FilterKernels.hpp"
+#include "dsp/FilterPipeline.hpp"
+
+using namespace Dsp;
+
+namespace {
+
+constexpr double MEASURE_SECONDS = 0.2; //!< Длительность одного замера
+
+volatile float g_sink = 0.0f; //!< Не даёт компилятору выбросить результат
+
+/**
+ * @brief Отсчётов в секунду при многократном вызове body на блоке из n отсчётов
+ */
+double measure(std::size_t n, const std::function<void()> &body) {
+    using Clock = std::chrono::steady_clock;
+
+    // Прогрев кешей и предсказателя
+    for (int i = 0; i < 10; ++i) {
+        body();
+    }
+
+    std::size_t calls = 0;
+    const auto start = Clock::now();
+    double elapsed = 0.0;
+    do {
+        for (int i = 0; i < 16; ++i) {
+            body();
+        }
+        calls += 16;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < MEASURE_SECONDS);
+
+    return double(calls) * double(n) / elapsed;
+}
+
+void report(const char *name, double simd, double scalar) {
+    std::printf("%-22s %10.1f Msamples/s  %10.1f Msamples/s  x%.2f\n",
+                name, simd / 1e6, scalar / 1e6, simd / scalar);
+}
+
+void report(const char *name, double rate) {
+    std::printf("%-22s %10.1f Msamples/s\n", name, rate / 1e6);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    const std::size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 4096;
+    if (n == 0) {
+        std::fprintf(stderr, "usage: %s [block size]\n", argv[0]);
+        return 1;
+    }
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::vector<float> x(n + 64);
+    for (float &sample : x) {
+        sample = value(random);
+    }
+    std::vector<float> y(n);
+
+    const std::vector<float> h = FirFilter::lowPass(31, 0.1);
+    const std::vector<float> hRev(h.rbegin(), h.rend());
+
+    std::printf("kernels: %s, block %zu\n", Kernels::simdName(), n);
+    std::printf("%-22s %21s  %21s\n", "", "vector", "scalar");
+
+    report("fir 31 taps",
+           measure(n, [&] { Kernels::fir(x.data(), hRev.data(), hRev.size(), y.data(), n); g_sink = y[0]; }),
+           measure(n, [&] { Kernels::firScalar(x.data(), hRev.data(), hRev.size(), y.data(), n); g_sink = y[0]; }));
+    report("median3",
+           measure(n, [&] { Kernels::median3(x.data(), y.data(), n); g_sink = y[0]; }),
+           measure(n, [&] { Kernels::median3Scalar(x.data(), y.data(), n); g_sink = y[0]; }));
+    report("scale",
+           measure(n, [&] { Kernels::scale(y.data(), n, -1.0f); g_sink = y[0]; }),
+           measure(n, [&] { Kernels::scaleScalar(y.data(), n, -1.0f); g_sink = y[0]; }));
+    {
+        float minValue = 0, maxValue = 0;
+        report("minMax",
+               measure(n, [&] { Kernels::minMax(x.data(), n, minValue, maxValue); g_sink = maxValue; }),
+               measure(n, [&] { Kernels::minMaxScalar(x.data(), n, minValue, maxValue); g_sink = maxValue; }));
+    }
+
+    // Звенья конвейера, по одному каналу: ядро плюс копирование истории
+    std::printf("\nstages, 1 channel\n");
+    SampleBlock block(1, n);
+    auto stage = [&](FilterStage &filter) {
+        return measure(n, [&] {
+            block.setSize(n);
+            std::copy(x.begin(), x.begin() + n, block.channel(0));
+            filter.process(block);
+            g_sink = block.channel(0)[0];
+        });
+    };
+
+    MovingAverage average(8);
+    MedianFilter  median3(3);
+    MedianFilter  median7(7);
+    FirFilter     fir(h);
+    IirFilter     iir({ Biquad::lowPass(1000.0, 50.0), Biquad::lowPass(1000.0, 80.0) });
+    Decimator     decimator(4);
+    Gain          gain(0.5f);
+
+    report("MovingAverage 8", stage(average));
+    report("Median 3", stage(median3));
+    report("Median 7", stage(median7));
+    report("FIR 31", stage(fir));
+    report("IIR 2 sections", stage(iir));
+    report("Decimator 4", stage(decimator));
+    report("Gain", stage(gain));
+    return 0;
+}
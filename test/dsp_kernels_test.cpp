@@ -0,0 +1,201 @@
+// Векторные ядра фильтров против скалярных эталонов и независимость
+// звеньев с состоянием от разбиения потока на блоки.
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "dsp/FilterKernels.hpp"
+#include "dsp/FilterPipeline.hpp"
+#include "Check.hpp"
+
+using namespace Dsp;
+
+namespace {
+
+// Векторный КИХ складывает в том же порядке, что и скалярный, но
+// компилятор вправе слить умножение и сложение скалярной версии в FMA
+// (например, на AArch64), поэтому для КИХ допуск, для остальных -
+// побитовое совпадение
+constexpr double FIR_TOLERANCE = 1e-5;
+
+std::vector<float> randomSignal(std::size_t n, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::vector<float> signal(n);
+    for (float &sample : signal) {
+        sample = value(random);
+    }
+    return signal;
+}
+
+/**
+ * @brief Ядра на всех длинах хвоста и невыровненных адресах
+ */
+void testKernels() {
+    const std::vector<float> signal = randomSignal(512, 1);
+    const std::vector<float> h = FirFilter::lowPass(31, 0.1);
+    const std::vector<float> hRev(h.rbegin(), h.rend());
+
+    for (std::size_t offset = 0; offset < 4; ++offset) {
+        for (std::size_t n = 0; n <= 67; ++n) {
+            const float *x = signal.data() + offset;
+
+            // КИХ, включая вырожденный фильтр из одного коэффициента
+            for (std::size_t taps : { std::size_t(1), std::size_t(3), hRev.size() }) {
+                std::vector<float> simd(n), scalar(n);
+                Kernels::fir(x, hRev.data(), taps, simd.data(), n);
+                Kernels::firScalar(x, hRev.data(), taps, scalar.data(), n);
+                for (std::size_t i = 0; i < n; ++i) {
+                    CHECK_MSG(Check::near(simd[i], scalar[i], FIR_TOLERANCE),
+                              "fir taps %zu n %zu offset %zu i %zu: %g vs %g",
+                              taps, n, offset, i, simd[i], scalar[i]);
+                }
+            }
+
+            {
+                std::vector<float> simd(n), scalar(n);
+                Kernels::median3(x, simd.data(), n);
+                Kernels::median3Scalar(x, scalar.data(), n);
+                CHECK_MSG(simd == scalar, "median3 n %zu offset %zu", n, offset);
+            }
+
+            {
+                std::vector<float> simd(x, x + n), scalar(x, x + n);
+                Kernels::scale(simd.data(), n, 0.37f);
+                Kernels::scaleScalar(scalar.data(), n, 0.37f);
+                CHECK_MSG(simd == scalar, "scale n %zu offset %zu", n, offset);
+            }
+
+            if (n > 0) {
+                float simdMin = 0, simdMax = 0, scalarMin = 0, scalarMax = 0;
+                Kernels::minMax(x, n, simdMin, simdMax);
+                Kernels::minMaxScalar(x, n, scalarMin, scalarMax);
+                CHECK_MSG(simdMin == scalarMin && simdMax == scalarMax, "minMax n %zu offset %zu", n, offset);
+            }
+        }
+    }
+
+    // Прореживание на месте: каждый factor-й отсчёт начиная с phase
+    for (std::size_t factor = 1; factor <= 5; ++factor) {
+        for (std::size_t phase = 0; phase < factor; ++phase) {
+            std::vector<float> data(signal.begin(), signal.begin() + 101);
+            const std::size_t out = Kernels::decimate(data.data(), data.size(), factor, phase, data.data());
+            CHECK(out == (101 - phase + factor - 1) / factor);
+            for (std::size_t i = 0; i < out; ++i) {
+                CHECK(data[i] == signal[phase + i * factor]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Обработка сигнала одним блоком или блоками заданных размеров
+ */
+std::vector<float> runStage(FilterStage &stage, const std::vector<float> &signal,
+                            const std::vector<std::size_t> &chunks, std::size_t channels) {
+    stage.reset();
+    std::vector<float> output;
+    SampleBlock block;
+    std::size_t position = 0;
+    std::size_t chunk = 0;
+
+    while (position < signal.size()) {
+        const std::size_t n = std::min(chunks[chunk++ % chunks.size()], signal.size() - position);
+        block.reserve(channels, std::max<std::size_t>(n, 1));
+        block.setSize(n);
+        // Каналы - копии сигнала с разным масштабом: состояние каналов раздельное
+        for (std::size_t ch = 0; ch < channels; ++ch) {
+            for (std::size_t i = 0; i < n; ++i) {
+                block.channel(ch)[i] = signal[position + i] * float(ch + 1);
+            }
+        }
+        stage.process(block);
+        for (std::size_t i = 0; i < block.size(); ++i) {
+            for (std::size_t ch = 0; ch < channels; ++ch) {
+                output.push_back(block.channel(ch)[i]);
+            }
+        }
+        position += n;
+    }
+    return output;
+}
+
+/**
+ * @brief Звенья с историей: результат не зависит от разбиения на блоки
+ */
+void testChunking() {
+    const std::vector<float> signal = randomSignal(1000, 2);
+
+    struct Case {
+        const char                                  *name;
+        std::function<std::unique_ptr<FilterStage>()> make;
+        double                                       tolerance;
+    };
+    const std::vector<Case> cases = {
+        { "MovingAverage", [] { return std::make_unique<MovingAverage>(8); }, 0.0 },
+        { "Median3",       [] { return std::make_unique<MedianFilter>(3); }, 0.0 },
+        { "Median7",       [] { return std::make_unique<MedianFilter>(7); }, 0.0 },
+        { "FIR",           [] { return std::make_unique<FirFilter>(FirFilter::lowPass(31, 0.1)); }, FIR_TOLERANCE },
+        { "IIR",           [] { return std::make_unique<IirFilter>(std::vector<Biquad>{
+                                    Biquad::lowPass(1000.0, 50.0), Biquad::lowPass(1000.0, 80.0) }); }, 0.0 },
+        { "Decimator",     [] { return std::make_unique<Decimator>(3); }, 0.0 },
+        { "Gain",          [] { return std::make_unique<Gain>(2.5f); }, 0.0 },
+    };
+
+    const std::vector<std::vector<std::size_t>> splits = {
+        { 1 }, { 3 }, { 4 }, { 7, 1, 13, 2 }, { 64 }, { 129, 5, 31 },
+    };
+
+    for (const Case &test : cases) {
+        for (std::size_t channels : { std::size_t(1), std::size_t(3) }) {
+            auto stage = test.make();
+            const std::vector<float> whole = runStage(*stage, signal, { signal.size() }, channels);
+
+            for (const auto &split : splits) {
+                const std::vector<float> chunked = runStage(*stage, signal, split, channels);
+                CHECK_MSG(chunked.size() == whole.size(), "%s: %zu vs %zu samples",
+                          test.name, chunked.size(), whole.size());
+                for (std::size_t i = 0; i < std::min(chunked.size(), whole.size()); ++i) {
+                    if (!Check::near(chunked[i], whole[i], test.tolerance)) {
+                        CHECK_MSG(false, "%s channels %zu first chunk %zu: sample %zu %g vs %g",
+                                  test.name, channels, split[0], i, chunked[i], whole[i]);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Звено КИХ против прямой свёртки y[n] = sum h[k] * x[n-k]
+ */
+void testFirReference() {
+    const std::vector<float> signal = randomSignal(300, 3);
+    const std::vector<float> h = FirFilter::lowPass(15, 0.2);
+
+    FirFilter fir(h);
+    const std::vector<float> output = runStage(fir, signal, { 37 }, 1);
+
+    for (std::size_t n = 0; n < signal.size(); ++n) {
+        double expected = 0.0;
+        for (std::size_t k = 0; k < h.size() && k <= n; ++k) {
+            expected += double(h[k]) * signal[n - k];
+        }
+        CHECK_MSG(Check::near(output[n], expected, 1e-5), "sample %zu: %g vs %g", n, output[n], expected);
+    }
+}
+
+}
+
+int main() {
+    std::fprintf(stderr, "kernels: %s\n", Kernels::simdName());
+    testKernels();
+    testChunking();
+    testFirReference();
+    return Check::result();
+}
@@ -0,0 +1,87 @@
+// Сообщения GUI: пачки повторяющихся сообщений не выделяют память.
+// Собирается вместе с приложением при QTAPP_ALLOC_TRACKING=ON; в Release
+// учёт выделений выключен, и тест пропускается.
+
+#include <QCoreApplication>
+#include <QString>
+
+#include <cstdio>
+
+#include "common/AllocTracker.hpp"
+#include "common/MessagesHandler.hpp"
+#include "Check.hpp"
+
+#if defined(QTAPP_ALLOC_TRACKING)
+
+namespace {
+
+constexpr int BURST = 10000;
+
+/**
+ * @brief Выделения за время body, все метки
+ * @details С glibc учёт видит и malloc, которым выделяют память
+ * контейнеры Qt
+ */
+template <typename Body>
+void expectNoAllocations(const char *name, Body body) {
+    std::uint64_t before = 0;
+    for (int tag = 0; tag < AllocTracker::TagCount; ++tag) {
+        before += AllocTracker::stats(AllocTracker::Tag(tag)).allocations;
+    }
+
+    body();
+
+    std::uint64_t after = 0;
+    for (int tag = 0; tag < AllocTracker::TagCount; ++tag) {
+        after += AllocTracker::stats(AllocTracker::Tag(tag)).allocations;
+    }
+
+    CHECK_MSG(after == before, "%s: %llu allocation(s)",
+              name, static_cast<unsigned long long>(after - before));
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    MessagesHandler messages;
+
+    const QString timeout  = QStringLiteral("Sensor timeout");
+    const QString overheat = QStringLiteral("Overheat");
+    const QString copy     = QString(timeout.constData(), timeout.size()); // Тот же текст, другой буфер
+
+    // Первое сообщение с новым текстом занимает строку таблицы - это выделение
+    messages.sendError(timeout);
+    messages.sendWarning(overheat);
+    messages.sendError(timeout);
+
+    expectNoAllocations("repeated message", [&]() {
+        for (int i = 0; i < BURST; ++i) {
+            messages.sendError(timeout);
+        }
+    });
+
+    expectNoAllocations("repeated text from another buffer", [&]() {
+        for (int i = 0; i < BURST; ++i) {
+            messages.sendError(copy);
+        }
+    });
+
+    // Чередование известных текстов занимает слоты, затем сообщения отбрасываются
+    expectNoAllocations("interned texts until slots run out", [&]() {
+        for (int i = 0; i < BURST; ++i) {
+            messages.sendError((i % 2) ? timeout : overheat);
+        }
+    });
+
+    return Check::result();
+}
+
+#else
+
+int main() {
+    std::fprintf(stderr, "allocation tracking is disabled in this build, test skipped\n");
+    return 77;
+}
+
+#endif
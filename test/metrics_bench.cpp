@@ -0,0 +1,98 @@
+// Стоимость записи метрик, нс на операцию: один поток и несколько потоков,
+// пишущих в одну метрику. Не тест: собирается рядом с тестами в составе
+// приложения (Metrics.hpp использует Qt Core) и запускается вручную,
+//   metrics_bench [потоков]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "common/Metrics.hpp"
+
+namespace {
+
+constexpr int OPS_PER_THREAD = 4'000'000; //!< Операций в одном замере на поток
+
+/**
+ * @brief Нс на операцию: threads потоков одновременно вызывают body(i)
+ * @details Потоки стартуют по общему флагу, время - от старта
+ * до завершения последнего потока, делённое на операции одного потока
+ */
+double measure(unsigned threads, const std::function<void(int)> &body) {
+    using Clock = std::chrono::steady_clock;
+
+    // Прогрев: шард потока назначается при первой записи
+    for (int i = 0; i < 1000; ++i) {
+        body(i);
+    }
+
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            while (!go.load(std::memory_order_acquire)) {
+            }
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                body(i);
+            }
+        });
+    }
+
+    const auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return elapsed / OPS_PER_THREAD;
+}
+
+void report(const char *name, double single, double contended) {
+    std::printf("%-26s %8.2f ns/op  %8.2f ns/op\n", name, single, contended);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    const unsigned threads = (argc > 1) ? unsigned(std::strtoul(argv[1], nullptr, 10))
+                                        : std::max(2u, std::thread::hardware_concurrency());
+    if (threads == 0) {
+        std::fprintf(stderr, "usage: %s [threads]\n", argv[0]);
+        return 1;
+    }
+
+    // Отдельные экземпляры на замер, чтобы замеры не делили шарды
+    auto run = [threads](const char *name, auto factory, auto body) {
+        auto single    = factory();
+        auto contended = factory();
+        report(name,
+               measure(1,       [&](int i) { body(*single, i); }),
+               measure(threads, [&](int i) { body(*contended, i); }));
+    };
+
+    std::printf("threads: %u, shards: %zu\n", threads, Metrics::SHARDS);
+    std::printf("%-26s %16s  %16s\n", "", "1 thread", "contended");
+
+    run("Counter::add",
+        [] { return std::make_unique<Metrics::Counter>(); },
+        [](Metrics::Counter &counter, int) { counter.add(); });
+    run("Gauge::set",
+        [] { return std::make_unique<Metrics::Gauge>(); },
+        [](Metrics::Gauge &gauge, int i) { gauge.set(i); });
+    // Значения разброса задержек: разные корзины, max почти не растёт
+    run("Histogram::record",
+        [] { return std::make_unique<Metrics::Histogram>(); },
+        [](Metrics::Histogram &histogram, int i) { histogram.record(quint64(200 + (i & 1023))); });
+    run("Histogram::record, rising",
+        [] { return std::make_unique<Metrics::Histogram>(); },
+        [](Metrics::Histogram &histogram, int i) { histogram.record(quint64(i)); });
+    run("ScopedTimer",
+        [] { return std::make_unique<Metrics::Histogram>(); },
+        [](Metrics::Histogram &histogram, int) { Metrics::ScopedTimer timer(histogram); });
+    return 0;
+}
@@ -0,0 +1,192 @@
+// Журнал параметров: воспроизведение, отбрасывание оборванного хвоста,
+// очистка через переполнение номера записи и дозапись во время очистки.
+// Собирается только в составе приложения (нужен Qt Core).
+
+#include <QByteArray>
+#include <QFile>
+#include <QMap>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include "common/ParameterJournal.hpp"
+#include "Check.hpp"
+
+namespace {
+
+/**
+ * @brief Запись журнала, собранная по описанию формата
+ */
+QByteArray record(quint32 sequence, const char *key, double value) {
+    std::array<char, ParameterJournal::RECORD_SIZE> data{};
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian(sequence, data.data());
+    std::memcpy(data.data() + 4, key, std::strlen(key));
+    qToLittleEndian(bits, data.data() + 20);
+    qToLittleEndian(ParameterJournal::crc32(data.data(), 28), data.data() + 28);
+    return QByteArray(data.data(), data.size());
+}
+
+void writeFile(const QString &path, const QByteArray &data) {
+    QFile file(path);
+    CHECK(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    CHECK(file.write(data) == data.size());
+}
+
+qint64 fileSize(const QString &path) {
+    return QFile(path).size();
+}
+
+/**
+ * @brief Значения сохраняются между открытиями, последнее значение побеждает
+ */
+void testReplay(const QString &path) {
+    {
+        ParameterJournal journal;
+        CHECK(journal.open(path).isEmpty());
+        CHECK(journal.append("gain", 1.5));
+        CHECK(journal.append("offset", -2.0));
+        CHECK(journal.append(QMap<QString, double>{ { "gain", 3.0 }, { "limit", 10.0 } }));
+        CHECK(!journal.append(QString(ParameterJournal::KEY_SIZE + 1, 'k'), 1.0));
+        CHECK(journal.records() == 4);
+        CHECK(journal.nextSequence() == 4);
+    }
+
+    ParameterJournal journal;
+    const QMap<QString, double> values = journal.open(path);
+    CHECK(values.size() == 3);
+    CHECK(values.value("gain") == 3.0);
+    CHECK(values.value("offset") == -2.0);
+    CHECK(values.value("limit") == 10.0);
+    CHECK(journal.records() == 4);
+    CHECK(journal.nextSequence() == 4);
+}
+
+/**
+ * @brief Повреждённая запись и всё после неё отбрасываются, файл усекается
+ */
+void testTornTail(const QString &path) {
+    QByteArray corrupt = record(2, "c", 3.0);
+    corrupt[10] = char(corrupt[10] ^ 0x40);
+
+    writeFile(path, record(0, "a", 1.0) + record(1, "b", 2.0) + corrupt
+                    + record(3, "d", 4.0) + QByteArray(7, 'x'));
+
+    ParameterJournal journal;
+    int errors = 0;
+    QObject::connect(&journal, &ParameterJournal::errorOccurred, [&errors]() { ++errors; });
+
+    const QMap<QString, double> values = journal.open(path);
+    CHECK(values.size() == 2);
+    CHECK(values.value("a") == 1.0 && values.value("b") == 2.0);
+    CHECK(!values.contains("d"));
+    CHECK(errors == 1);
+    CHECK(fileSize(path) == 2 * ParameterJournal::RECORD_SIZE);
+
+    // Новая запись встаёт сразу за последней действительной
+    CHECK(journal.append("e", 5.0));
+    ParameterJournal reopened;
+    const QMap<QString, double> after = reopened.open(path);
+    CHECK(after.size() == 3 && after.value("e") == 5.0);
+
+    // Оборванная последняя запись (сбой посреди write)
+    writeFile(path, record(0, "a", 1.0) + record(1, "b", 2.0).left(20));
+    ParameterJournal torn;
+    CHECK(torn.open(path).size() == 1);
+    CHECK(fileSize(path) == ParameterJournal::RECORD_SIZE);
+}
+
+/**
+ * @brief Очистка по номеру через переполнение и атомарная перезапись хвоста
+ */
+void testDiscardWraparound(const QString &path) {
+    writeFile(path, record(0xFFFFFFFEu, "a", 1.0) + record(0xFFFFFFFFu, "b", 2.0)
+                    + record(0, "c", 3.0) + record(1, "a", 4.0));
+
+    ParameterJournal journal;
+    CHECK(journal.open(path).value("a") == 4.0);
+    CHECK(journal.nextSequence() == 2);
+
+    // Номер 0 - после 0xFFFFFFFF: удаляются только две записи до переполнения
+    journal.discardBefore(0);
+    CHECK(journal.records() == 2);
+    CHECK(fileSize(path) == 2 * ParameterJournal::RECORD_SIZE);
+
+    // Номер до начала журнала ничего не удаляет
+    journal.discardBefore(0xFFFFFFF0u);
+    CHECK(journal.records() == 2);
+
+    // После перезаписи через QSaveFile журнал переоткрыт: дозапись - в конец нового файла
+    CHECK(journal.append("d", 5.0));
+    CHECK(journal.records() == 3);
+    {
+        ParameterJournal reopened;
+        const QMap<QString, double> values = reopened.open(path);
+        CHECK(values.size() == 3);
+        CHECK(!values.contains("b"));
+        CHECK(values.value("a") == 4.0 && values.value("c") == 3.0 && values.value("d") == 5.0);
+        CHECK(reopened.nextSequence() == 3);
+    }
+
+    // Всё перенесено: файл усекается до нуля
+    journal.discardBefore(journal.nextSequence());
+    CHECK(journal.records() == 0);
+    CHECK(fileSize(path) == 0);
+    CHECK(journal.append("e", 6.0));
+    CHECK(fileSize(path) == ParameterJournal::RECORD_SIZE);
+}
+
+/**
+ * @brief Записи, сделанные во время очистки, не теряются
+ */
+void testAppendDuringDiscard(const QString &path) {
+    constexpr int WRITES = 2000;
+
+    QFile::remove(path);
+    ParameterJournal journal;
+    journal.open(path);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (int i = 1; i <= WRITES; ++i) {
+            journal.append(QString("p%1").arg(i % 7), i);
+        }
+        done.store(true);
+    });
+
+    int discards = 0;
+    while (!done.load()) {
+        journal.discardBefore(journal.nextSequence() - 3);
+        ++discards;
+    }
+    writer.join();
+
+    CHECK(discards > 0);
+    CHECK(fileSize(path) == qint64(journal.records()) * ParameterJournal::RECORD_SIZE);
+
+    // Последние записи каждого параметра пережили все очистки
+    ParameterJournal reopened;
+    const QMap<QString, double> values = reopened.open(path);
+    CHECK(reopened.nextSequence() == WRITES);
+    CHECK(values.value(QString("p%1").arg(WRITES % 7)) == WRITES);
+    CHECK(values.value(QString("p%1").arg((WRITES - 1) % 7)) == WRITES - 1);
+    CHECK(values.value(QString("p%1").arg((WRITES - 2) % 7)) == WRITES - 2);
+}
+
+}
+
+int main() {
+    QTemporaryDir dir;
+    CHECK(dir.isValid());
+
+    testReplay(dir.filePath("replay.journal"));
+    testTornTail(dir.filePath("torn.journal"));
+    testDiscardWraparound(dir.filePath("wrap.journal"));
+    testAppendDuringDiscard(dir.filePath("concurrent.journal"));
+    return Check::result();
+}
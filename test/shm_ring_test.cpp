@@ -0,0 +1,182 @@
+// Кольцо отсчётов в разделяемой памяти: писатель и читатель в разных
+// потоках, учёт пропущенных блоков, чтение с самого старого блока и
+// обнаружение перезапуска писателя.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include "shm/ShmRing.hpp"
+#include "Check.hpp"
+
+namespace {
+
+std::string segmentName(const char *suffix) {
+    return "/qtapp-test-" + std::to_string(::getpid()) + "-" + suffix;
+}
+
+/**
+ * @brief Блок, все отсчёты которого равны номеру блока
+ */
+void publish(ShmRing::Writer &writer, std::uint64_t seq, std::size_t count) {
+    static float samples[ShmRing::MAX_SAMPLES];
+    for (std::size_t i = 0; i < count; ++i) {
+        samples[i] = static_cast<float>(seq);
+    }
+    writer.publish(0, double(seq), 1.0, samples, count);
+}
+
+/**
+ * @brief Читатель в своём потоке видит только целые блоки, а прочитанные
+ * и пропущенные блоки в сумме дают все опубликованные
+ */
+void testConcurrent() {
+    constexpr std::uint64_t BLOCKS = 200000;
+    const std::string name = segmentName("concurrent");
+
+    ShmRing::Writer writer;
+    CHECK(writer.create(name, 4));
+    ShmRing::Reader reader;
+    CHECK(reader.open(name, true));
+
+    std::atomic<bool> done{false};
+    std::thread producer([&]() {
+        for (std::uint64_t seq = 0; seq < BLOCKS; ++seq) {
+            publish(writer, seq, 1 + seq % ShmRing::MAX_SAMPLES);
+        }
+        done.store(true);
+    });
+
+    std::uint64_t ok = 0, overruns = 0, torn = 0, outOfOrder = 0;
+    std::uint64_t last = 0;
+    bool first = true;
+    for (;;) {
+        bool whole = true;
+        std::uint64_t seq = 0;
+        const ShmRing::Reader::Result result = reader.visit([&](const ShmRing::Slot &slot) {
+            seq = slot.sequence;
+            whole = slot.count == 1 + seq % ShmRing::MAX_SAMPLES && slot.t0 == double(seq);
+            for (std::uint32_t i = 0; whole && i < std::min<std::uint32_t>(slot.count, ShmRing::MAX_SAMPLES); ++i) {
+                whole = slot.samples[i] == static_cast<float>(seq);
+            }
+        });
+
+        if (result == ShmRing::Reader::Ok) {
+            ++ok;
+            torn += whole ? 0 : 1;
+            outOfOrder += (!first && seq <= last) ? 1 : 0;
+            last  = seq;
+            first = false;
+        } else if (result == ShmRing::Reader::Overrun) {
+            ++overruns;
+        } else if (result == ShmRing::Reader::Empty && done.load()) {
+            if (reader.position() >= BLOCKS) {
+                break;
+            }
+        } else if (result == ShmRing::Reader::Restarted) {
+            CHECK_MSG(false, "unexpected Restarted");
+            break;
+        }
+    }
+    producer.join();
+
+    CHECK_MSG(torn == 0, "%llu torn block(s) returned as Ok", (unsigned long long)torn);
+    CHECK(outOfOrder == 0);
+    CHECK_MSG(ok + reader.lostTotal() == BLOCKS, "ok %llu + lost %llu != %llu",
+              (unsigned long long)ok, (unsigned long long)reader.lostTotal(),
+              (unsigned long long)BLOCKS);
+    std::fprintf(stderr, "concurrent: %llu read, %llu lost in %llu overruns\n",
+                 (unsigned long long)ok, (unsigned long long)reader.lostTotal(),
+                 (unsigned long long)overruns);
+}
+
+/**
+ * @brief Начальная позиция и учёт пропусков без гонок
+ */
+void testPositionAndLost() {
+    const std::string name = segmentName("lost");
+
+    ShmRing::Writer writer;
+    CHECK(writer.create(name, 4));
+
+    for (std::uint64_t seq = 0; seq < 3; ++seq) {
+        publish(writer, seq, 8);
+    }
+    {
+        ShmRing::Reader reader;
+        CHECK(reader.open(name, true));
+        CHECK(reader.position() == 0);
+    }
+
+    ShmRing::Reader late;
+    CHECK(late.open(name, false));
+    for (std::uint64_t seq = 3; seq < 10; ++seq) {
+        publish(writer, seq, 8);
+    }
+
+    ShmRing::Reader oldest;
+    CHECK(oldest.open(name, true));
+    CHECK(oldest.position() == 6);
+    ShmRing::Reader fresh;
+    CHECK(fresh.open(name, false));
+    CHECK(fresh.position() == 10);
+
+    // Отставший читатель: блоки 3..6 потеряны, самый старый слот
+    // пропускается, потому что писатель мог бы его перезаписывать
+    ShmRing::Slot slot;
+    CHECK(late.position() == 3);
+    CHECK(late.read(slot) == ShmRing::Reader::Overrun);
+    CHECK(late.lost() == 4);
+    for (std::uint64_t seq = 7; seq < 10; ++seq) {
+        CHECK(late.read(slot) == ShmRing::Reader::Ok);
+        CHECK(slot.sequence == seq && slot.count == 8 && slot.samples[7] == float(seq));
+    }
+    CHECK(late.read(slot) == ShmRing::Reader::Empty);
+    CHECK(late.lostTotal() == 4);
+}
+
+/**
+ * @brief Пересозданный сегмент обнаруживается, удалённый - ещё нет
+ */
+void testRestart() {
+    const std::string name = segmentName("restart");
+
+    auto first = std::make_unique<ShmRing::Writer>();
+    CHECK(first->create(name, 4));
+
+    ShmRing::Reader reader;
+    CHECK(reader.open(name, false));
+    CHECK(!reader.replaced(true));
+
+    first.reset();
+    CHECK(!reader.replaced(true));
+
+    ShmRing::Writer second;
+    CHECK(second.create(name, 4));
+    CHECK(reader.replaced(true));
+
+    // visit() проверяет не чаще RESTART_CHECK_NS
+    std::this_thread::sleep_for(std::chrono::nanoseconds(ShmRing::Reader::RESTART_CHECK_NS + 10'000'000));
+    ShmRing::Slot slot;
+    CHECK(reader.read(slot) == ShmRing::Reader::Restarted);
+
+    CHECK(reader.open(name, true));
+    publish(second, 0, 4);
+    CHECK(reader.read(slot) == ShmRing::Reader::Ok);
+    CHECK(!reader.replaced(true));
+}
+
+}
+
+int main() {
+    testPositionAndLost();
+    testConcurrent();
+    testRestart();
+    return Check::result();
+}
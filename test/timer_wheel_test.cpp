@@ -0,0 +1,147 @@
+// Колесо таймеров планировщика: периодические таймеры срабатывают точно
+// в расчётный тик и не накапливают дрейф на перекладках уровней.
+
+#include <cstdint>
+#include <vector>
+
+#include "common/TimerWheel.hpp"
+#include "Check.hpp"
+
+namespace {
+
+/**
+ * @brief Периодический таймер модели: ведёт счёт срабатываний
+ */
+struct Timer {
+    std::int64_t first  = 0; //!< Тик первого срабатывания
+    std::int64_t period = 0; //!< Период, тиков
+    std::int64_t fires  = 0; //!< Срабатываний
+    int          errors = 0; //!< Срабатываний не в расчётный тик
+};
+
+using Wheel = TimerWheel<Timer *>;
+
+/**
+ * @brief Прогон колеса так же, как это делает поток таймера планировщика
+ * @details Колесо продвигается до следующего пробуждения, а каждое
+ * step-е пробуждение - ещё на step тиков дальше (поток проспал).
+ * Сработавший таймер переставляется на expiry + period.
+ */
+void run(Wheel &wheel, std::int64_t until, std::int64_t step) {
+    std::vector<Wheel::Entry> expired;
+    std::int64_t sleeps = 0;
+
+    while (wheel.now() < until) {
+        std::int64_t target = wheel.nextWakeTick();
+        if (step > 0 && (++sleeps % step) == 0) {
+            target += step;
+        }
+        while (wheel.now() < target) {
+            wheel.tick(expired);
+        }
+
+        for (Wheel::Entry &entry : expired) {
+            Timer &timer = *entry.payload;
+            const std::int64_t expected = timer.first + timer.fires * timer.period;
+            if (entry.expiry != expected || (step == 0 && wheel.now() != expected)) {
+                if (timer.errors++ == 0) {
+                    CHECK_MSG(false, "period %lld: fire %lld expiry %lld at tick %lld, expected %lld",
+                              (long long)timer.period, (long long)timer.fires, (long long)entry.expiry,
+                              (long long)wheel.now(), (long long)expected);
+                }
+            }
+            ++timer.fires;
+            wheel.insert({ entry.payload, entry.expiry + timer.period });
+        }
+        expired.clear();
+    }
+}
+
+/**
+ * @brief Часы работы с периодами, не кратными размеру уровня 0
+ */
+void testNoDrift(std::int64_t step) {
+    // 333, 257, 1001 и 1000 не кратны 256 и попадают на границы уровней
+    // в разных фазах; 16384 - ровно слот уровня 1, 70000 - уровень 2
+    std::vector<Timer> timers = {
+        { 7, 333 }, { 2, 257 }, { 1, 1001 }, { 256, 1000 }, { 255, 256 },
+        { 3, 16384 }, { 100, 70000 }, { 1, 1 },
+    };
+
+    Wheel wheel;
+    wheel.reset(0);
+    for (Timer &timer : timers) {
+        wheel.insert({ &timer, timer.first });
+    }
+
+    const std::int64_t hours = 4;
+    const std::int64_t until = hours * 3600 * 1000; // тик 1 мс
+    run(wheel, until, step);
+
+    for (const Timer &timer : timers) {
+        const std::int64_t expected = (until - timer.first) / timer.period + 1;
+        CHECK_MSG(timer.errors == 0, "period %lld: %d fires off schedule",
+                  (long long)timer.period, timer.errors);
+        if (step > 0) {
+            // Проспавший поток догоняет по одному сроку за тик: важно
+            // только, что сроки не сдвинулись
+            continue;
+        }
+        CHECK_MSG(timer.fires == expected,
+                  "period %lld: %lld fires, expected %lld",
+                  (long long)timer.period, (long long)timer.fires, (long long)expected);
+    }
+    CHECK(wheel.size() == timers.size());
+}
+
+/**
+ * @brief Просроченная запись срабатывает на следующем тике с прежним сроком
+ */
+void testOverdue() {
+    Timer timer { 0, 10 };
+    Wheel wheel;
+    wheel.reset(1000);
+    wheel.insert({ &timer, 990 });
+
+    std::vector<Wheel::Entry> expired;
+    CHECK(wheel.nextWakeTick() == 1001);
+    wheel.tick(expired);
+    CHECK(expired.size() == 1);
+    CHECK(!expired.empty() && expired[0].expiry == 990);
+    CHECK(wheel.isEmpty());
+}
+
+/**
+ * @brief Срок на границе уровня 0 после перекладки со старших уровней
+ */
+void testBoundary() {
+    Timer timer { 0, 0 };
+    Wheel wheel;
+    wheel.reset(0);
+    for (std::int64_t expiry : { 256, 512, 16384, 32768, 1 << 20, (1 << 20) + 256 }) {
+        wheel.insert({ &timer, expiry });
+    }
+
+    std::vector<Wheel::Entry> expired;
+    std::vector<std::int64_t> fired;
+    while (!wheel.isEmpty()) {
+        wheel.tick(expired);
+        for (const Wheel::Entry &entry : expired) {
+            CHECK_MSG(entry.expiry == wheel.now(), "expiry %lld at tick %lld",
+                      (long long)entry.expiry, (long long)wheel.now());
+            fired.push_back(entry.expiry);
+        }
+        expired.clear();
+    }
+    CHECK(fired.size() == 6);
+}
+
+}
+
+int main() {
+    testNoDrift(0);
+    testNoDrift(3);
+    testOverdue();
+    testBoundary();
+    return Check::result();
+}